@@ -13,6 +13,7 @@
 #include "blockd.h"
 #include "vpx_mem/vpx_mem.h"
 #include "onyxc_int.h"
+#include "alloccommon.h"
 #include "findnearmv.h"
 #include "entropymode.h"
 #include "systemdependent.h"
@@ -41,18 +42,15 @@ void vp8_de_alloc_frame_buffers(VP8_COMMON *oci)
     for (i = 0; i < NUM_YV12_BUFFERS; i++)
         vp8_yv12_de_alloc_frame_buffer(&oci->yv12_fb[i]);
 
-    vp8_yv12_de_alloc_frame_buffer(&oci->temp_scale_frame);
     vp8_yv12_de_alloc_frame_buffer(&oci->post_proc_buffer);
     if (oci->post_proc_buffer_int_used)
         vp8_yv12_de_alloc_frame_buffer(&oci->post_proc_buffer_int);
 
-    vpx_free(oci->above_context);
-    vpx_free(oci->mip);
-    vpx_free(oci->prev_mip);
-
+    /* These live in oci->arena and go with it. */
     oci->above_context = 0;
     oci->mip = 0;
     oci->prev_mip = 0;
+    oci->pp_limits_buffer = 0;
 
 }
 
@@ -62,6 +60,12 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
 
     vp8_de_alloc_frame_buffers(oci);
 
+    /* Everything allocated from the arena for the previous size goes, the
+     * encoder's and decoder's own buffers included: they allocate theirs
+     * again after this.
+     */
+    vpx_arena_reset(&oci->arena);
+
     /* our internal buffers are always multiples of 16 */
     if ((width & 0xf) != 0)
         width += 16 - (width & 0xf);
@@ -74,7 +78,18 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
     {
         oci->fb_idx_ref_cnt[i] = 0;
         oci->yv12_fb[i].flags = 0;
-        if (vp8_yv12_alloc_frame_buffer(&oci->yv12_fb[i], width, height, VP8BORDERINPIXELS) < 0)
+
+        /* Only the layout is known here, the decoder attaches the memory. */
+        if (oci->fb_external)
+        {
+            if (vp8_yv12_external_frame_buffer(&oci->yv12_fb[i], width, height,
+                                               VP8BORDERINPIXELS, NULL) < 0)
+            {
+                vp8_de_alloc_frame_buffers(oci);
+                return 1;
+            }
+        }
+        else if (vp8_yv12_alloc_frame_buffer_placed(&oci->yv12_fb[i], width, height, VP8BORDERINPIXELS, oci->fb_mem_id) < 0)
         {
             vp8_de_alloc_frame_buffers(oci);
             return 1;
@@ -91,12 +106,6 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
     oci->fb_idx_ref_cnt[2] = 1;
     oci->fb_idx_ref_cnt[3] = 1;
 
-    if (vp8_yv12_alloc_frame_buffer(&oci->temp_scale_frame,   width, 16, VP8BORDERINPIXELS) < 0)
-    {
-        vp8_de_alloc_frame_buffers(oci);
-        return 1;
-    }
-
     if (vp8_yv12_alloc_frame_buffer(&oci->post_proc_buffer, width, height, VP8BORDERINPIXELS) < 0)
     {
         vp8_de_alloc_frame_buffers(oci);
@@ -109,7 +118,7 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
     oci->mb_cols = width >> 4;
     oci->MBs = oci->mb_rows * oci->mb_cols;
     oci->mode_info_stride = oci->mb_cols + 1;
-    oci->mip = vpx_calloc((oci->mb_cols + 1) * (oci->mb_rows + 1), sizeof(MODE_INFO));
+    oci->mip = vpx_arena_calloc(&oci->arena, (oci->mb_cols + 1) * (oci->mb_rows + 1), sizeof(MODE_INFO));
 
     if (!oci->mip)
     {
@@ -118,10 +127,11 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
     }
 
     oci->mi = oci->mip + oci->mode_info_stride + 1;
+    oci->show_frame_mi = oci->mi;
 
     /* allocate memory for last frame MODE_INFO array */
 #if CONFIG_ERROR_CONCEALMENT
-    oci->prev_mip = vpx_calloc((oci->mb_cols + 1) * (oci->mb_rows + 1), sizeof(MODE_INFO));
+    oci->prev_mip = vpx_arena_calloc(&oci->arena, (oci->mb_cols + 1) * (oci->mb_rows + 1), sizeof(MODE_INFO));
 
     if (!oci->prev_mip)
     {
@@ -135,7 +145,7 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
     oci->prev_mi = NULL;
 #endif
 
-    oci->above_context = vpx_calloc(sizeof(ENTROPY_CONTEXT_PLANES) * oci->mb_cols, 1);
+    oci->above_context = vpx_arena_calloc(&oci->arena, sizeof(ENTROPY_CONTEXT_PLANES) * oci->mb_cols, 1);
 
     if (!oci->above_context)
     {
@@ -143,6 +153,14 @@ int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height)
         return 1;
     }
 
+    oci->pp_limits_buffer = vpx_arena_malloc(&oci->arena, oci->mb_rows * oci->mb_cols);
+
+    if (!oci->pp_limits_buffer)
+    {
+        vp8_de_alloc_frame_buffers(oci);
+        return 1;
+    }
+
     update_mode_info_border(oci->mi, oci->mb_rows, oci->mb_cols);
 #if CONFIG_ERROR_CONCEALMENT
     update_mode_info_border(oci->prev_mi, oci->mb_rows, oci->mb_cols);
@@ -214,6 +232,64 @@ void vp8_create_common(VP8_COMMON *oci)
 void vp8_remove_common(VP8_COMMON *oci)
 {
     vp8_de_alloc_frame_buffers(oci);
+    vpx_arena_free(&oci->arena);
+}
+
+void vp8_mem_frame(size_t bytes[MEM_KINDS], MEM_KIND kind,
+                   const YV12_BUFFER_CONFIG *f)
+{
+    if (!f->buffer_alloc || f->buffer_external)
+        return;
+
+    bytes[kind] += vpx_mem_footprint(f->buffer_alloc, f->frame_size);
+#if CONFIG_OPENCL
+
+    if (f->buffer_mem)
+        bytes[MEM_OPENCL] += f->frame_size * sizeof(cl_uint);
+
+#endif
+}
+
+void vp8_mem_usage(const VP8_COMMON *oci, size_t bytes[MEM_KINDS])
+{
+    int i;
+
+    for (i = 0; i < NUM_YV12_BUFFERS; i++)
+        vp8_mem_frame(bytes, MEM_FRAMES, &oci->yv12_fb[i]);
+
+    vp8_mem_frame(bytes, MEM_FRAMES, &oci->post_proc_buffer);
+
+    if (oci->post_proc_buffer_int_used)
+        vp8_mem_frame(bytes, MEM_FRAMES, &oci->post_proc_buffer_int);
+
+    bytes[MEM_STATE] += vpx_arena_size(&oci->arena);
+}
+
+size_t vp8_mem_update_peak(VP8_COMMON *oci, const size_t bytes[MEM_KINDS])
+{
+    size_t total = 0;
+    int i;
+
+    for (i = 0; i < MEM_KINDS; i++)
+        total += bytes[i];
+
+    if (total > oci->mem_peak)
+        oci->mem_peak = total;
+
+    return total;
+}
+
+void vp8_fill_mem_stats(VP8_COMMON *oci, const size_t bytes[MEM_KINDS],
+                        vp8_mem_stats_t *stats)
+{
+    stats->frame_buffers = bytes[MEM_FRAMES];
+    stats->thread_buffers = bytes[MEM_THREADS];
+    stats->token_buffers = bytes[MEM_TOKENS];
+    stats->lookahead = bytes[MEM_LOOKAHEAD];
+    stats->opencl = bytes[MEM_OPENCL];
+    stats->other = bytes[MEM_STATE];
+    stats->total = vp8_mem_update_peak(oci, bytes);
+    stats->peak = oci->mem_peak;
 }
 
 void vp8_initialize_common()
@@ -13,6 +13,7 @@
 #define __INC_ALLOCCOMMON_H
 
 #include "onyxc_int.h"
+#include "vpx/vp8.h"
 
 void vp8_create_common(VP8_COMMON *oci);
 void vp8_remove_common(VP8_COMMON *oci);
@@ -20,4 +21,23 @@ void vp8_de_alloc_frame_buffers(VP8_COMMON *oci);
 int vp8_alloc_frame_buffers(VP8_COMMON *oci, int width, int height);
 void vp8_setup_version(VP8_COMMON *oci);
 
+/* Adds the memory of frame f to bytes[kind], and that of its OpenCL
+ * mirror to bytes[MEM_OPENCL]. Application frame buffers don't count.
+ */
+void vp8_mem_frame(size_t bytes[MEM_KINDS], MEM_KIND kind,
+                   const YV12_BUFFER_CONFIG *f);
+
+/* Adds the memory held through oci to bytes: its frames and, as
+ * MEM_STATE, its arena. The codecs add their own on top, see
+ * vp8dx_mem_usage() and vp8cx_mem_usage().
+ */
+void vp8_mem_usage(const VP8_COMMON *oci, size_t bytes[MEM_KINDS]);
+
+/* Returns the total of bytes, raising oci->mem_peak to it. */
+size_t vp8_mem_update_peak(VP8_COMMON *oci, const size_t bytes[MEM_KINDS]);
+
+/* Reports bytes, and the peak including them, in stats. */
+void vp8_fill_mem_stats(VP8_COMMON *oci, const size_t bytes[MEM_KINDS],
+                        vp8_mem_stats_t *stats);
+
 #endif
@@ -35,6 +35,9 @@ void vpx_log(const char *format, ...);
 #define MAX_REF_LF_DELTAS       4
 #define MAX_MODE_LF_DELTAS      4
 
+/* Row pitch of MACROBLOCKD.edge_buf: a 16x16 block plus its filter taps */
+#define EDGE_BUF_STRIDE         32
+
 /* Segment Feature Masks */
 #define SEGMENT_DELTADATA   0
 #define SEGMENT_ABSDATA     1
@@ -180,7 +183,31 @@ typedef struct
     int_mv mv;
     //union b_mode_info bmi[16];
     int dissim;    // dissimilarity level of the macroblock
+    int skip;      // coded without residual
 } LOWER_RES_INFO;
+
+/* Shared by all the levels of a multi-resolution encoder. Level n stores
+ * its modes in mb_info[n] for level n + 1 and stamps each MB row with the
+ * sequence number of the encode call as soon as the row is final, so the
+ * levels can code the same frame concurrently. done_seq is stamped when a
+ * level is through with the call, whether it stored a frame or not. seq is
+ * advanced once per vpx_codec_encode() call, by level 0 which is always
+ * called first, and every level reads it, so a level that was skipped
+ * after an error never falls behind the others. The stamps are written
+ * with vp8_atomic_store_release() and polled with
+ * vp8_atomic_load_acquire().
+ */
+#define MAX_MR_LEVELS 16
+
+typedef struct
+{
+    LOWER_RES_INFO *mb_info[MAX_MR_LEVELS];
+    int *row_seq[MAX_MR_LEVELS];
+    volatile int done_seq[MAX_MR_LEVELS];
+    int res[MAX_MR_LEVELS];     /* status of the level's last encode call */
+    int seq;
+    int users;
+} LOWER_RES_FRAME_INFO;
 #endif
 
 typedef struct blockd
@@ -319,6 +346,13 @@ typedef struct macroblockd
 
     int corrupted;
 
+    /* Set when the reference frames have no extended borders: blocks whose
+     * taps reach outside the picture are predicted from edge_buf instead,
+     * see reconinter.c.
+     */
+    int emulate_edges;
+    DECLARE_ALIGNED(16, unsigned char, edge_buf[EDGE_BUF_STRIDE * (16 + 5)]);
+
 #if ARCH_X86 || ARCH_X86_64
     /* This is an intermediate buffer currently used in sub-pixel motion search
      * to keep a copy of the reference area. This buffer can be used for other
@@ -41,7 +41,8 @@ static void copy_and_extend_plane
     for (i = 0; i < h; i++)
     {
         vpx_memset(dest_ptr1, src_ptr1[0], el);
-        vpx_memcpy(dest_ptr1 + el, src_ptr1, w);
+        if (s != d)
+            vpx_memcpy(dest_ptr1 + el, src_ptr1, w);
         vpx_memset(dest_ptr2, src_ptr2[0], er);
         src_ptr1  += sp;
         src_ptr2  += sp;
@@ -102,6 +103,37 @@ void vp8_copy_and_extend_frame(YV12_BUFFER_CONFIG *src,
 }
 
 
+/* Extend a frame whose width x height picture was written in place out
+ * to the frame's aligned size and borders.
+ */
+void vp8_extend_frame_in_place(YV12_BUFFER_CONFIG *ybf, int width, int height)
+{
+    const int uv_width = (width + 1) >> 1;
+    const int uv_height = (height + 1) >> 1;
+    int et = ybf->border;
+    int el = ybf->border;
+    int eb = ybf->border + ybf->y_height - height;
+    int er = ybf->border + ybf->y_width - width;
+
+    copy_and_extend_plane(ybf->y_buffer, ybf->y_stride,
+                          ybf->y_buffer, ybf->y_stride,
+                          height, width, et, el, eb, er);
+
+    et = ybf->border >> 1;
+    el = ybf->border >> 1;
+    eb = (ybf->border >> 1) + ybf->uv_height - uv_height;
+    er = (ybf->border >> 1) + ybf->uv_width - uv_width;
+
+    copy_and_extend_plane(ybf->u_buffer, ybf->uv_stride,
+                          ybf->u_buffer, ybf->uv_stride,
+                          uv_height, uv_width, et, el, eb, er);
+
+    copy_and_extend_plane(ybf->v_buffer, ybf->uv_stride,
+                          ybf->v_buffer, ybf->uv_stride,
+                          uv_height, uv_width, et, el, eb, er);
+}
+
+
 void vp8_copy_and_extend_frame_with_rect(YV12_BUFFER_CONFIG *src,
                                          YV12_BUFFER_CONFIG *dst,
                                          int srcy, int srcx,
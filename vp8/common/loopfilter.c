@@ -114,23 +114,14 @@ void vp8_loop_filter_init(VP8_COMMON *cm)
     }
 }
 
-void vp8_loop_filter_frame_init(VP8_COMMON *cm,
-                                MACROBLOCKD *mbd,
-                                int default_filt_lvl)
+/* Filter level of each segment, reference frame and mode class. */
+static void lf_init_lvl(const MACROBLOCKD *mbd, int default_filt_lvl,
+                        unsigned char lvl[4][4][4])
 {
     int seg,  /* segment number */
         ref,  /* index in ref_lf_deltas */
         mode; /* index in mode_lf_deltas */
 
-    loop_filter_info_n *lfi = &cm->lf_info;
-
-    /* update limits if sharpness has changed */
-    if(cm->last_sharpness_level != cm->sharpness_level)
-    {
-        vp8_loop_filter_update_sharpness(lfi, cm->sharpness_level);
-        cm->last_sharpness_level = cm->sharpness_level;
-    }
-
     for(seg = 0; seg < MAX_MB_SEGMENTS; seg++)
     {
         int lvl_seg = default_filt_lvl;
@@ -156,7 +147,7 @@ void vp8_loop_filter_frame_init(VP8_COMMON *cm,
             /* we could get rid of this if we assume that deltas are set to
              * zero when not in use; encoder always uses deltas
              */
-            vpx_memset(lfi->lvl[seg][0], lvl_seg, 4 * 4 );
+            vpx_memset(lvl[seg][0], lvl_seg, 4 * 4 );
             continue;
         }
 
@@ -174,11 +165,11 @@ void vp8_loop_filter_frame_init(VP8_COMMON *cm,
         lvl_mode = lvl_ref +  mbd->mode_lf_deltas[mode];
         lvl_mode = (lvl_mode > 0) ? (lvl_mode > 63 ? 63 : lvl_mode) : 0; /* clamp */
 
-        lfi->lvl[seg][ref][mode] = lvl_mode;
+        lvl[seg][ref][mode] = lvl_mode;
 
         mode = 1; /* all the rest of Intra modes */
         lvl_mode = (lvl_ref > 0) ? (lvl_ref > 63 ? 63 : lvl_ref)  : 0; /* clamp */
-        lfi->lvl[seg][ref][mode] = lvl_mode;
+        lvl[seg][ref][mode] = lvl_mode;
 
         /* LAST, GOLDEN, ALT */
         for(ref = 1; ref < MAX_REF_FRAMES; ref++)
@@ -194,24 +185,39 @@ void vp8_loop_filter_frame_init(VP8_COMMON *cm,
                 lvl_mode = lvl_ref + mbd->mode_lf_deltas[mode];
                 lvl_mode = (lvl_mode > 0) ? (lvl_mode > 63 ? 63 : lvl_mode) : 0; /* clamp */
 
-                lfi->lvl[seg][ref][mode] = lvl_mode;
+                lvl[seg][ref][mode] = lvl_mode;
             }
         }
     }
 }
 
+void vp8_loop_filter_frame_init(VP8_COMMON *cm,
+                                MACROBLOCKD *mbd,
+                                int default_filt_lvl)
+{
+    loop_filter_info_n *lfi = &cm->lf_info;
+
+    /* update limits if sharpness has changed */
+    if(cm->last_sharpness_level != cm->sharpness_level)
+    {
+        vp8_loop_filter_update_sharpness(lfi, cm->sharpness_level);
+        cm->last_sharpness_level = cm->sharpness_level;
+    }
+
+    lf_init_lvl(mbd, default_filt_lvl, lfi->lvl);
+}
+
 void vp8_loop_filter_frame
 (
     VP8_COMMON *cm,
-    MACROBLOCKD *mbd
+    MACROBLOCKD *mbd,
+    int frame_type
 )
 {
     YV12_BUFFER_CONFIG *post = cm->frame_to_show;
     loop_filter_info_n *lfi_n = &cm->lf_info;
     loop_filter_info lfi;
 
-    FRAME_TYPE frame_type = cm->frame_type;
-
     int mb_row;
     int mb_col;
 
@@ -224,7 +230,7 @@ void vp8_loop_filter_frame
     
 #if CONFIG_OPENCL && ENABLE_CL_LOOPFILTER
     if ( cl_initialized == CL_SUCCESS ){
-        vp8_loop_filter_frame_cl(cm,mbd);
+        vp8_loop_filter_frame_cl(cm, mbd, frame_type);
         return;
     }
 #endif
@@ -315,15 +321,9 @@ void vp8_loop_filter_frame
     }
 }
 
-void vp8_loop_filter_frame_yonly
-(
-    VP8_COMMON *cm,
-    MACROBLOCKD *mbd,
-    int default_filt_lvl
-)
+static void loop_filter_yonly(VP8_COMMON *cm, unsigned char lvl[4][4][4],
+                              YV12_BUFFER_CONFIG *post)
 {
-    YV12_BUFFER_CONFIG *post = cm->frame_to_show;
-
     unsigned char *y_ptr;
     int mb_row;
     int mb_col;
@@ -337,14 +337,6 @@ void vp8_loop_filter_frame_yonly
     /* Point at base of Mb MODE_INFO list */
     const MODE_INFO *mode_info_context = cm->mi;
 
-#if 0
-    if(default_filt_lvl == 0) /* no filter applied */
-        return;
-#endif
-
-    /* Initialize the loop filter for this frame. */
-    vp8_loop_filter_frame_init( cm, mbd, default_filt_lvl);
-
     /* Set up the buffer pointers */
     y_ptr = post->y_buffer;
 
@@ -361,7 +353,7 @@ void vp8_loop_filter_frame_yonly
             const int seg = mode_info_context->mbmi.segment_id;
             const int ref_frame = mode_info_context->mbmi.ref_frame;
 
-            filter_level = lfi_n->lvl[seg][ref_frame][mode_index];
+            filter_level = lvl[seg][ref_frame][mode_index];
 
             if (filter_level)
             {
@@ -422,6 +414,42 @@ void vp8_loop_filter_frame_yonly
 
 }
 
+void vp8_loop_filter_frame_yonly
+(
+    VP8_COMMON *cm,
+    MACROBLOCKD *mbd,
+    int default_filt_lvl
+)
+{
+#if 0
+    if(default_filt_lvl == 0) /* no filter applied */
+        return;
+#endif
+
+    /* Initialize the loop filter for this frame. */
+    vp8_loop_filter_frame_init( cm, mbd, default_filt_lvl);
+
+    loop_filter_yonly(cm, cm->lf_info.lvl, cm->frame_to_show);
+}
+
+/* Like vp8_loop_filter_frame_yonly(), but filters the given buffer and
+ * leaves cm untouched, so several levels can be tried at once on
+ * different threads. The sharpness tables must be up to date.
+ */
+void vp8_loop_filter_yonly_buffer
+(
+    VP8_COMMON *cm,
+    const MACROBLOCKD *mbd,
+    int default_filt_lvl,
+    YV12_BUFFER_CONFIG *post
+)
+{
+    unsigned char lvl[4][4][4];
+
+    lf_init_lvl(mbd, default_filt_lvl, lvl);
+    loop_filter_yonly(cm, lvl, post);
+}
+
 void vp8_loop_filter_partial_frame
 (
     VP8_COMMON *cm,
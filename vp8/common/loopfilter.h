@@ -76,7 +76,11 @@ void vp8_loop_filter_frame_init(struct VP8Common *cm,
                                 struct macroblockd *mbd,
                                 int default_filt_lvl);
 
-void vp8_loop_filter_frame(struct VP8Common *cm, struct macroblockd *mbd);
+/* frame_type is passed in rather than read from cm so that an encoder
+ * can filter a frame while it sets up the next one.
+ */
+void vp8_loop_filter_frame(struct VP8Common *cm, struct macroblockd *mbd,
+                           int frame_type);
 
 void vp8_loop_filter_partial_frame(struct VP8Common *cm,
                                    struct macroblockd *mbd,
@@ -86,6 +90,11 @@ void vp8_loop_filter_frame_yonly(struct VP8Common *cm,
                                  struct macroblockd *mbd,
                                  int default_filt_lvl);
 
+void vp8_loop_filter_yonly_buffer(struct VP8Common *cm,
+                                  const struct macroblockd *mbd,
+                                  int default_filt_lvl,
+                                  struct yv12_buffer_config *post);
+
 void vp8_loop_filter_update_sharpness(loop_filter_info_n *lfi,
                                       int sharpness_lvl);
 
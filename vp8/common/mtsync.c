@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include "vpx_config.h"
+#include "mtsync.h"
+#include "threading.h"
+#include "vpx_ports/vpx_timer.h"
+
+void vp8_mt_sync_get_stats(const MT_SYNC_STATE *s, vp8_mt_sync_stats_t *stats)
+{
+    stats->sync_range = s->sync_range;
+    stats->threads = s->last_threads;
+    stats->sync_points = s->last.sync_points;
+    stats->stalls = s->last.stalls;
+    stats->stall_usec = s->last.stall_usec;
+    stats->frame_usec = s->last_frame_usec;
+}
+
+#if CONFIG_MULTITHREAD
+
+/* Share of the per-thread wall time spent waiting (in percent) above which
+ * the step is refined, and below which it may be coarsened.
+ */
+#define MT_SYNC_SHRINK_PCT 10
+#define MT_SYNC_GROW_PCT   2
+
+void vp8_mt_sync_init(MT_SYNC_STATE *s, int mb_cols, int default_range)
+{
+    int max_range = 1;
+
+    /* Keep at least four progress checks per row. */
+    while ((max_range << 1) <= (mb_cols >> 2) && max_range < MT_SYNC_MAX_RANGE)
+        max_range <<= 1;
+
+    if (default_range > max_range)
+        default_range = max_range;
+
+    s->sync_range = default_range;
+    s->default_range = default_range;
+    s->max_range = max_range;
+    s->last.sync_points = 0;
+    s->last.stalls = 0;
+    s->last.stall_usec = 0;
+    s->last.coded_mbs = 0;
+    s->last_frame_usec = 0;
+    s->last_threads = 0;
+}
+
+void vp8_mt_sync_reset_rows(MT_ROW_PROGRESS *rows, int mb_rows)
+{
+    int i;
+
+    for (i = 0; i < mb_rows; i++)
+        rows[i].mb_col = -1;
+}
+
+void vp8_mt_sync_wait(const MT_ROW_PROGRESS *above, int mb_col, int nsync,
+                      int last_col, MT_SYNC_COUNTERS *c)
+{
+    c->sync_points++;
+
+    if (mb_col > (above->mb_col - nsync) && above->mb_col != last_col)
+    {
+        struct vpx_usec_timer timer;
+
+        vpx_usec_timer_start(&timer);
+
+        while (mb_col > (above->mb_col - nsync) && above->mb_col != last_col)
+        {
+            x86_pause_hint();
+            thread_sleep(0);
+        }
+
+        vpx_usec_timer_mark(&timer);
+        c->stalls++;
+        c->stall_usec += (unsigned int)vpx_usec_timer_elapsed(&timer);
+    }
+}
+
+void vp8_mt_sync_accumulate(MT_SYNC_COUNTERS *total, MT_SYNC_COUNTERS *c)
+{
+    total->sync_points += c->sync_points;
+    total->stalls += c->stalls;
+    total->stall_usec += c->stall_usec;
+    total->coded_mbs += c->coded_mbs;
+
+    c->sync_points = 0;
+    c->stalls = 0;
+    c->stall_usec = 0;
+    c->coded_mbs = 0;
+}
+
+void vp8_mt_sync_adapt(MT_SYNC_STATE *s, const MT_SYNC_COUNTERS *total,
+                       int threads, unsigned int frame_usec, int mb_count)
+{
+    unsigned int wait_pct = 0;
+    unsigned int stall_pct = 0;
+    int coded_pct = 0;
+
+    s->last = *total;
+    s->last_frame_usec = frame_usec;
+    s->last_threads = threads;
+
+    if (frame_usec && threads)
+        wait_pct = (unsigned int)(((double)total->stall_usec * 100)
+                                  / ((double)frame_usec * threads));
+
+    if (total->sync_points)
+        stall_pct = total->stalls * 100 / total->sync_points;
+
+    if (mb_count)
+        coded_pct = total->coded_mbs * 100 / mb_count;
+
+    if (wait_pct > MT_SYNC_SHRINK_PCT)
+    {
+        /* Threads spend their time behind the row above: a finer step lets
+         * them start sooner and shortens the ramp at the top of the frame.
+         */
+        if (s->sync_range > 1)
+            s->sync_range >>= 1;
+    }
+    else if (wait_pct < MT_SYNC_GROW_PCT && stall_pct < 25)
+    {
+        /* Nobody is waiting, so poll the neighbouring row less often. Busy
+         * content makes each MB expensive relative to a poll, so only
+         * mostly-skipped frames may go past the width based default.
+         */
+        int limit = (coded_pct > 50) ? s->default_range : s->max_range;
+
+        if (s->sync_range < limit)
+            s->sync_range <<= 1;
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#ifndef __INC_MTSYNC_H
+#define __INC_MTSYNC_H
+
+#include "vpx_config.h"
+#include "vpx/vpx_codec.h"
+#include "vpx/vp8.h"
+
+#define MT_SYNC_CACHE_LINE  64
+#define MT_SYNC_MAX_RANGE   32
+
+/* Wavefront progress of one MB row (the last column completed). Each
+ * counter sits on its own cache line so the thread publishing a row does
+ * not invalidate the line being polled by the threads on other rows.
+ */
+typedef struct
+{
+    volatile int mb_col;
+    char pad[MT_SYNC_CACHE_LINE - sizeof(int)];
+} MT_ROW_PROGRESS;
+
+/* Per-thread wavefront statistics. Each thread updates its own copy
+ * without locking; the main thread sums them once the frame is done.
+ */
+typedef struct
+{
+    unsigned int sync_points;   /* progress checks made */
+    unsigned int stalls;        /* checks that had to wait for the row above */
+    unsigned int stall_usec;    /* time spent waiting */
+    unsigned int coded_mbs;     /* MBs carrying residual */
+} MT_SYNC_COUNTERS;
+
+typedef struct
+{
+    int sync_range;             /* MB columns between progress checks */
+    int default_range;          /* width based starting point */
+    int max_range;
+
+    /* Totals of the last completed frame. */
+    MT_SYNC_COUNTERS last;
+    unsigned int last_frame_usec;
+    int last_threads;
+} MT_SYNC_STATE;
+
+#if CONFIG_MULTITHREAD
+void vp8_mt_sync_init(MT_SYNC_STATE *s, int mb_cols, int default_range);
+void vp8_mt_sync_reset_rows(MT_ROW_PROGRESS *rows, int mb_rows);
+void vp8_mt_sync_wait(const MT_ROW_PROGRESS *above, int mb_col, int nsync,
+                      int last_col, MT_SYNC_COUNTERS *c);
+void vp8_mt_sync_accumulate(MT_SYNC_COUNTERS *total, MT_SYNC_COUNTERS *c);
+void vp8_mt_sync_adapt(MT_SYNC_STATE *s, const MT_SYNC_COUNTERS *total,
+                       int threads, unsigned int frame_usec, int mb_count);
+#endif
+void vp8_mt_sync_get_stats(const MT_SYNC_STATE *s, vp8_mt_sync_stats_t *stats);
+
+#endif
@@ -112,6 +112,7 @@ extern "C"
         int Sharpness;          // parameter used for sharpening output: recommendation 0:
         int cpu_used;
         unsigned int rc_max_intra_bitrate_pct;
+        int rt_deadline_percentile; // share of real time frames to encode within the budget
 
         // mode ->
         //(0)=Realtime/Live Encoding. This mode is optimized for realtim encoding (for example, capturing
@@ -239,6 +240,10 @@ extern "C"
 // receive a frames worth of data caller can assume that a copy of this frame is made
 // and not just a copy of the pointer..
     int vp8_receive_raw_frame(struct VP8_COMP* comp, unsigned int frame_flags, YV12_BUFFER_CONFIG *sd, int64_t time_stamp, int64_t end_time_stamp);
+#if CONFIG_MULTI_RES_ENCODING
+// receive the highest resolution's frame and scale it down to this level
+    int vp8_receive_scaled_raw_frame(struct VP8_COMP* comp, unsigned int frame_flags, YV12_BUFFER_CONFIG *sd, int64_t time_stamp, int64_t end_time_stamp);
+#endif
     int vp8_get_compressed_data(struct VP8_COMP* comp, unsigned int *frame_flags, unsigned long *size, unsigned char *dest, unsigned char *dest_end, int64_t *time_stamp, int64_t *time_end, int flush);
     int vp8_get_preview_raw_frame(struct VP8_COMP* comp, YV12_BUFFER_CONFIG *dest, vp8_ppflags_t *flags);
 
@@ -251,6 +256,9 @@ extern "C"
     int vp8_set_active_map(struct VP8_COMP* comp, unsigned char *map, unsigned int rows, unsigned int cols);
     int vp8_set_internal_size(struct VP8_COMP* comp, VPX_SCALING horiz_mode, VPX_SCALING vert_mode);
     int vp8_get_quantizer(struct VP8_COMP* c);
+    void vp8_get_mt_sync_stats(struct VP8_COMP* c, vp8_mt_sync_stats_t *stats);
+    void vp8_get_rt_speed_state(struct VP8_COMP* c, vp8e_rt_speed_state_t *state);
+    void vp8_get_mem_stats(struct VP8_COMP* c, vp8_mem_stats_t *stats);
 
 #ifdef __cplusplus
 }
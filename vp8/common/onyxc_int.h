@@ -15,6 +15,7 @@
 #include "vpx_config.h"
 #include "vpx_rtcd.h"
 #include "vpx/internal/vpx_codec_internal.h"
+#include "vpx_mem/vpx_mem.h"
 #include "loopfilter.h"
 #include "entropymv.h"
 #include "entropy.h"
@@ -49,6 +50,18 @@ typedef struct frame_contexts
     MV_CONTEXT pre_mvc[2];  /* not to caculate the mvcost for the frame if mvc doesn't change. */
 } FRAME_CONTEXT;
 
+/* What the memory of a codec instance holds, see vp8_mem_usage(). */
+typedef enum
+{
+    MEM_FRAMES,         /* reference, working and postprocessed frames */
+    MEM_THREADS,        /* per-thread state and row buffers */
+    MEM_TOKENS,         /* encoder token buffer */
+    MEM_LOOKAHEAD,      /* encoder source frame queue */
+    MEM_OPENCL,         /* OpenCL device mirrors of the frames */
+    MEM_STATE,          /* mode info and the rest of the instance */
+    MEM_KINDS
+} MEM_KIND;
+
 typedef enum
 {
     ONE_PARTITION  = 0,
@@ -91,12 +104,16 @@ typedef struct VP8Common
     YV12_BUFFER_CONFIG yv12_fb[NUM_YV12_BUFFERS];
     int fb_idx_ref_cnt[NUM_YV12_BUFFERS];
     int new_fb_idx, lst_fb_idx, gld_fb_idx, alt_fb_idx;
+    int fb_external;    /* yv12_fb[] memory is attached by the application */
+    int unbordered_refs; /* yv12_fb[] borders are not extended, see
+                          * MACROBLOCKD.emulate_edges */
+    int fb_mem_id;      /* vpx_mem_alloc() placement of yv12_fb[] */
 
     YV12_BUFFER_CONFIG post_proc_buffer;
-    YV12_BUFFER_CONFIG temp_scale_frame;
 
     YV12_BUFFER_CONFIG post_proc_buffer_int;
     int post_proc_buffer_int_used;
+    unsigned char *pp_limits_buffer;   /* per MB deblocking limits, mb_rows x mb_cols */
 
     FRAME_TYPE last_frame_type;  /* Save last frame's frame type for motion search. */
     FRAME_TYPE frame_type;
@@ -127,6 +144,12 @@ typedef struct VP8Common
     unsigned int frames_since_golden;
     unsigned int frames_till_alt_ref_frame;
 
+    /* Buffers sized by the frame dimensions, allocated afresh from here
+       whenever they change, see vp8_alloc_frame_buffers(). */
+    vpx_arena_t arena;
+
+    size_t mem_peak;    /* largest vp8_mem_usage() total seen */
+
     /* We allocate a MODE_INFO struct for each macroblock, together with
        an extra row on top and column on the left to simplify prediction. */
 
@@ -134,6 +157,7 @@ typedef struct VP8Common
     MODE_INFO *mi;  /* Corresponds to upper left visible macroblock */
     MODE_INFO *prev_mip; /* MODE_INFO array 'mip' from last decoded frame */
     MODE_INFO *prev_mi;  /* 'mi' from last frame (points into prev_mip) */
+    MODE_INFO *show_frame_mi;  /* 'mi' of the frame to show, for postproc */
 
 
     INTERPOLATIONFILTERTYPE mcomp_filter_type;
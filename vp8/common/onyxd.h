@@ -22,6 +22,7 @@ extern "C"
 #include "ppflags.h"
 #include "vpx_ports/mem.h"
 #include "vpx/vpx_codec.h"
+#include "vpx/vp8dx.h"
 
     struct VP8D_COMP;
 
@@ -34,6 +35,8 @@ extern "C"
         int     max_threads;
         int     error_concealment;
         int     input_fragments;
+        int     unbordered_refs;
+        int     frame_mem_id;   /* vpx_mem_alloc() id for the frames */
     } VP8D_CONFIG;
     typedef enum
     {
@@ -54,6 +57,10 @@ extern "C"
     int vp8dx_get_setting(struct VP8D_COMP* comp, VP8D_SETTING oxst);
 
     int vp8dx_receive_compressed_data(struct VP8D_COMP* comp, unsigned long size, const unsigned char *dest, int64_t time_stamp);
+    void vp8dx_get_mem_stats(struct VP8D_COMP* comp, vp8_mem_stats_t *stats);
+    void vp8dx_set_postproc_flags(struct VP8D_COMP* comp, vp8_ppflags_t *flags);
+    int vp8dx_set_frame_buffer_functions(struct VP8D_COMP* comp, const vp8_frame_buffer_functions_t *functions);
+    int vp8dx_get_frame_buffer(struct VP8D_COMP* comp, const unsigned char *y_buffer, vp8_frame_buffer_t *fb);
     int vp8dx_get_raw_frame(struct VP8D_COMP* comp, YV12_BUFFER_CONFIG *sd, int64_t *time_stamp, int64_t *time_end_stamp, vp8_ppflags_t *flags);
 
     vpx_codec_err_t vp8dx_get_reference(struct VP8D_COMP* comp, VP8_REFFRAME ref_frame_flag, YV12_BUFFER_CONFIG *sd);
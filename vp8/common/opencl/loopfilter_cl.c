@@ -66,7 +66,8 @@ typedef unsigned char uc;
 extern void vp8_loop_filter_frame
 (
     VP8_COMMON *cm,
-    MACROBLOCKD *mbd
+    MACROBLOCKD *mbd,
+    int frame_type
 );
 
 typedef struct VP8_LOOP_MEM{
@@ -481,7 +482,7 @@ void vp8_loop_filter_build_priority(int priority, VP8_COMMON *cm, MACROBLOCKD *m
 }
 
 void vp8_loop_filter_offsets_copy(VP8_COMMON *cm, MACROBLOCKD *mbd, 
-        cl_int *dc_diffs, cl_int *rows, cl_int *cols, cl_int *filter_levels, int levels
+        int frame_type, cl_int *dc_diffs, cl_int *rows, cl_int *cols, cl_int *filter_levels, int levels
 ){
     int err, level;
     
@@ -513,7 +514,7 @@ void vp8_loop_filter_offsets_copy(VP8_COMMON *cm, MACROBLOCKD *mbd,
 #if MAP_FILTERS
     VP8_CL_UNMAP_BUF(mbd->cl_commands, loop_mem.filters_mem, filters, ,)
 #else
-    VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.filters_mem, 4*num_blocks*sizeof(cl_int), filters, vp8_loop_filter_frame(cm,mbd),)
+    VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.filters_mem, 4*num_blocks*sizeof(cl_int), filters, vp8_loop_filter_frame(cm, mbd, frame_type),)
     free(filters);
 #endif
 }
@@ -521,7 +522,8 @@ void vp8_loop_filter_offsets_copy(VP8_COMMON *cm, MACROBLOCKD *mbd,
 void vp8_loop_filter_frame_cl
 (
     VP8_COMMON *cm,
-    MACROBLOCKD *mbd
+    MACROBLOCKD *mbd,
+    int frame_type
 )
 {
     YV12_BUFFER_CONFIG *post = cm->frame_to_show;
@@ -569,7 +571,7 @@ void vp8_loop_filter_frame_cl
 #endif
 
 #if USE_MAPPED_BUFFERS || 1
-    VP8_CL_MAP_BUF(mbd->cl_commands, post->buffer_mem, buf, post->frame_size * sizeof(cl_uint), vp8_loop_filter_frame(cm,mbd),);
+    VP8_CL_MAP_BUF(mbd->cl_commands, post->buffer_mem, buf, post->frame_size * sizeof(cl_uint), vp8_loop_filter_frame(cm, mbd, frame_type),);
     //Copy frame to GPU and convert from uchar to uint
     if (cl_data.vp8_loop_filter_uint_buffer) {
         if (cl_data.endianness_mismatch == CL_TRUE) {
@@ -588,7 +590,7 @@ void vp8_loop_filter_frame_cl
     VP8_CL_UNMAP_BUF(mbd->cl_commands, post->buffer_mem, buf,,);
 #else
     VP8_CL_SET_BUF(mbd->cl_commands, post->buffer_mem, post->frame_size, post->buffer_alloc,
-            vp8_loop_filter_frame(cm,mbd),);
+            vp8_loop_filter_frame(cm, mbd, frame_type),);
 #endif
 
 #if SKIP_NON_FILTERED_MBS
@@ -633,7 +635,7 @@ void vp8_loop_filter_frame_cl
         offsets = malloc(offsets_size);
         if (offsets == NULL){
             cl_destroy(mbd->cl_commands, VP8_CL_TRIED_BUT_FAILED);
-            vp8_loop_filter_frame(cm, mbd);
+            vp8_loop_filter_frame(cm, mbd, frame_type);
             return;
         }
 #endif
@@ -646,7 +648,7 @@ void vp8_loop_filter_frame_cl
     args.filters_mem = loop_mem.filters_mem;
     args.block_offsets_mem = loop_mem.block_offsets_mem;
     args.priority_num_blocks_mem = loop_mem.priority_num_blocks_mem;
-    args.frame_type = cm->frame_type;
+    args.frame_type = frame_type;
     
     //Maximum priority = 2*(Height-1) + Width in Macroblocks
     //First identify all Macroblocks that will be processed and their priority
@@ -665,18 +667,18 @@ void vp8_loop_filter_frame_cl
 #if MAP_OFFSETS
         VP8_CL_UNMAP_BUF(mbd->cl_commands, loop_mem.offsets_mem, offsets,,);
 #else
-        VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.offsets_mem, offsets_size, offsets, vp8_loop_filter_frame(cm, mbd), )
+        VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.offsets_mem, offsets_size, offsets, vp8_loop_filter_frame(cm, mbd, frame_type), )
         free(offsets);
         offsets = NULL;
 #endif
         
         //Now re-send the block_offsets/priority_num_blocks buffers
-        VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.priority_num_blocks_mem, sizeof(cl_int)*num_levels, priority_num_blocks, vp8_loop_filter_frame(cm, mbd), )
-        VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.block_offsets_mem, sizeof(cl_int)*num_levels, block_offsets, vp8_loop_filter_frame(cm, mbd), )
+        VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.priority_num_blocks_mem, sizeof(cl_int)*num_levels, priority_num_blocks, vp8_loop_filter_frame(cm, mbd, frame_type), )
+        VP8_CL_SET_BUF(mbd->cl_commands, loop_mem.block_offsets_mem, sizeof(cl_int)*num_levels, block_offsets, vp8_loop_filter_frame(cm, mbd, frame_type), )
     }
     
     //Copy any needed buffer contents to the CL device
-    vp8_loop_filter_offsets_copy(cm, mbd, dc_diffs, rows, cols, filter_levels, num_levels);
+    vp8_loop_filter_offsets_copy(cm, mbd, frame_type, dc_diffs, rows, cols, filter_levels, num_levels);
     
     //Actually process the various priority levels
     for (priority = 0; priority < num_levels ; priority++){
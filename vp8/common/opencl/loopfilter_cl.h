@@ -44,7 +44,8 @@ void vp8_loop_filter_filters_init();
 extern void vp8_loop_filter_frame_cl
 (
     VP8_COMMON *cm,
-    MACROBLOCKD *mbd
+    MACROBLOCKD *mbd,
+    int frame_type
 );
 
 extern prototype_loopfilter_block_cl(vp8_lf_normal_mb_v_cl);
@@ -220,6 +220,108 @@ void vp8_post_proc_down_and_across_c
     }
 }
 
+/* As vp8_post_proc_down_and_across_c() for one row of size x size MBs, with
+ * a limit per MB. MBs limited to VP8_PP_LIMIT_KEEP keep their destination.
+ */
+void vp8_post_proc_down_and_across_mb_row_c
+(
+    unsigned char *src_ptr,
+    unsigned char *dst_ptr,
+    int src_pixels_per_line,
+    int dst_pixels_per_line,
+    int cols,
+    unsigned char *flimits,
+    int size
+)
+{
+    unsigned char *p_src, *p_dst;
+    int row;
+    int col;
+    int i;
+    int v;
+    int pitch = src_pixels_per_line;
+    unsigned char d[8];
+
+    for (row = 0; row < size; row++)
+    {
+        /* post_proc_down for one row */
+        p_src = src_ptr;
+        p_dst = dst_ptr;
+
+        for (col = 0; col < cols; col++)
+        {
+            int flimit = flimits[col / size];
+            int kernel = 4;
+
+            if (flimit == VP8_PP_LIMIT_KEEP)
+                continue;
+
+            v = p_src[col];
+
+            for (i = -2; i <= 2; i++)
+            {
+                if (abs(v - p_src[col+i*pitch]) > flimit)
+                    goto down_skip_convolve;
+
+                kernel += kernel5[2+i] * p_src[col+i*pitch];
+            }
+
+            v = (kernel >> 3);
+        down_skip_convolve:
+            p_dst[col] = v;
+        }
+
+        /* now post_proc_across; kept MBs go through the delay line
+         * unchanged */
+        p_src = dst_ptr;
+        p_dst = dst_ptr;
+
+        for (i = -8; i<0; i++)
+          p_src[i]=p_src[0];
+
+        for (i = cols; i<cols+8; i++)
+          p_src[i]=p_src[cols-1];
+
+        for (i = 0; i < 8; i++)
+            d[i] = p_src[i];
+
+        for (col = 0; col < cols; col++)
+        {
+            int flimit = flimits[col / size];
+            int kernel = 4;
+            v = p_src[col];
+
+            d[col&7] = v;
+
+            if (flimit == VP8_PP_LIMIT_KEEP)
+                goto across_skip_convolve;
+
+            for (i = -2; i <= 2; i++)
+            {
+                if (abs(v - p_src[col+i]) > flimit)
+                    goto across_skip_convolve;
+
+                kernel += kernel5[2+i] * p_src[col+i];
+            }
+
+            d[col&7] = (kernel >> 3);
+        across_skip_convolve:
+
+            if (col >= 2)
+                p_dst[col-2] = d[(col-2)&7];
+        }
+
+        /* handle the last two pixels */
+        p_dst[col-2] = d[(col-2)&7];
+        p_dst[col-1] = d[(col-1)&7];
+
+
+        /* next row */
+        src_ptr += pitch;
+        dst_ptr += dst_pixels_per_line;
+    }
+}
+
 static int q2mbl(int x)
 {
     if (x < 20) x = 20;
@@ -325,24 +427,76 @@ void vp8_mbpost_proc_down_c(unsigned char *dst, int pitch, int rows, int cols, i
 }
 
 
+static int q2ppl(int q)
+{
+    double level = 6.0e-05 * q * q * q - .0067 * q * q + .306 * q + .0065;
+    return (int)(level + .5);
+}
+
+/* Deblocks the MB rows [mb_row_start, mb_row_end) of source into post and,
+ * if flimit_mb is non zero, applies the horizontal half of the macroblock
+ * edge smoothing. Every pass here only changes the rows it is given, so the
+ * frame can be done in bands, in any order.
+ */
+static void deblock_mb_rows(YV12_BUFFER_CONFIG         *source,
+                            YV12_BUFFER_CONFIG         *post,
+                            int                         ppl,
+                            int                         flimit_mb,
+                            int                         mb_row_start,
+                            int                         mb_row_end)
+{
+    int y_start = mb_row_start * 16;
+    int y_rows = mb_row_end * 16;
+    int uv_start = mb_row_start * 8;
+    int uv_rows = mb_row_end * 8;
+
+    if (y_rows > source->y_height)
+        y_rows = source->y_height;
+
+    if (uv_rows > source->uv_height)
+        uv_rows = source->uv_height;
+
+    y_rows -= y_start;
+    uv_rows -= uv_start;
+
+    if (y_rows > 0)
+    {
+        vp8_post_proc_down_and_across(source->y_buffer + y_start * source->y_stride,
+                                      post->y_buffer + y_start * post->y_stride,
+                                      source->y_stride, post->y_stride,
+                                      y_rows, source->y_width, ppl);
+
+        if (flimit_mb)
+            vp8_mbpost_proc_across_ip(post->y_buffer + y_start * post->y_stride,
+                                      post->y_stride, y_rows, post->y_width,
+                                      flimit_mb);
+    }
+
+    if (uv_rows > 0)
+    {
+        vp8_post_proc_down_and_across(source->u_buffer + uv_start * source->uv_stride,
+                                      post->u_buffer + uv_start * post->uv_stride,
+                                      source->uv_stride, post->uv_stride,
+                                      uv_rows, source->uv_width, ppl);
+        vp8_post_proc_down_and_across(source->v_buffer + uv_start * source->uv_stride,
+                                      post->v_buffer + uv_start * post->uv_stride,
+                                      source->uv_stride, post->uv_stride,
+                                      uv_rows, source->uv_width, ppl);
+    }
+}
+
 static void vp8_deblock_and_de_macro_block(YV12_BUFFER_CONFIG         *source,
         YV12_BUFFER_CONFIG         *post,
         int                         q,
         int                         low_var_thresh,
         int                         flag)
 {
-    double level = 6.0e-05 * q * q * q - .0067 * q * q + .306 * q + .0065;
-    int ppl = (int)(level + .5);
     (void) low_var_thresh;
     (void) flag;
 
-    vp8_post_proc_down_and_across(source->y_buffer, post->y_buffer, source->y_stride,  post->y_stride, source->y_height, source->y_width,  ppl);
-    vp8_mbpost_proc_across_ip(post->y_buffer, post->y_stride, post->y_height, post->y_width, q2mbl(q));
+    deblock_mb_rows(source, post, q2ppl(q), q2mbl(q),
+                    0, (source->y_height + 15) >> 4);
     vp8_mbpost_proc_down(post->y_buffer, post->y_stride, post->y_height, post->y_width, q2mbl(q));
-
-    vp8_post_proc_down_and_across(source->u_buffer, post->u_buffer, source->uv_stride, post->uv_stride, source->uv_height, source->uv_width, ppl);
-    vp8_post_proc_down_and_across(source->v_buffer, post->v_buffer, source->uv_stride, post->uv_stride, source->uv_height, source->uv_width, ppl);
-
 }
 
 void vp8_deblock(YV12_BUFFER_CONFIG         *source,
@@ -351,14 +505,10 @@ void vp8_deblock(YV12_BUFFER_CONFIG         *source,
                  int                         low_var_thresh,
                  int                         flag)
 {
-    double level = 6.0e-05 * q * q * q - .0067 * q * q + .306 * q + .0065;
-    int ppl = (int)(level + .5);
     (void) low_var_thresh;
     (void) flag;
 
-    vp8_post_proc_down_and_across(source->y_buffer, post->y_buffer, source->y_stride,  post->y_stride, source->y_height, source->y_width,   ppl);
-    vp8_post_proc_down_and_across(source->u_buffer, post->u_buffer, source->uv_stride, post->uv_stride,  source->uv_height, source->uv_width, ppl);
-    vp8_post_proc_down_and_across(source->v_buffer, post->v_buffer, source->uv_stride, post->uv_stride, source->uv_height, source->uv_width, ppl);
+    deblock_mb_rows(source, post, q2ppl(q), 0, 0, (source->y_height + 15) >> 4);
 }
 
 void vp8_de_noise(YV12_BUFFER_CONFIG         *source,
@@ -900,12 +1050,215 @@ void vp8_multiframe_quality_enhance
     }
 }
 
+/* Picks the deblocking settings for these flags into the postproc state,
+ * for use by post_proc_mb_rows(). Returns 0 if the flags don't deblock.
+ */
+static int deblock_setup(VP8_COMMON *oci, vp8_ppflags_t *ppflags)
+{
+    struct postproc_state *state = &oci->postproc_state;
+    int flags = ppflags->post_proc_flag;
+    int q = oci->filter_level * 10 / 6;
+    int q_offset = 0;
+
+    if (q > 63)
+        q = 63;
+
+    if (flags & VP8D_DEMACROBLOCK)
+    {
+        q_offset = (ppflags->deblocking_level - 5) * 10;
+        state->rows_flags = VP8D_DEMACROBLOCK;
+    }
+    else if (flags & VP8D_DEBLOCK)
+        state->rows_flags = VP8D_DEBLOCK;
+    else
+    {
+        state->rows_flags = 0;
+        return 0;
+    }
+
+    vp8_clear_system_state();
+
+    state->rows_q = q + q_offset;
+    state->rows_ppl = q2ppl(q + q_offset);
+    state->rows_flimit_mb = (flags & VP8D_DEMACROBLOCK) ? q2mbl(q + q_offset) : 0;
+    state->rows_keep_static = 0;
+
+    if ((flags & VP8D_MB_ADAPTIVE) && oci->show_frame_mi)
+    {
+        int level;
+
+        state->rows_flags |= VP8D_MB_ADAPTIVE;
+
+        /* Demacroblocking filters in place, so kept MBs would be filtered
+         * again on every frame.
+         */
+        state->rows_keep_static = state->prev_deblocked &&
+                                  !(flags & VP8D_DEMACROBLOCK);
+
+        /* The frame level maps to the frame q, as above; segment and mode
+         * deltas move each MB from there.
+         */
+        for (level = 0; level <= MAX_LOOP_FILTER; level++)
+        {
+            int mb_q = level * 10 / 6;
+            int ppl;
+
+            if (mb_q > 63)
+                mb_q = 63;
+
+            ppl = q2ppl(mb_q + q_offset);
+            state->mb_ppl[level] = (ppl < 0) ? 0 :
+                                   (ppl >= VP8_PP_LIMIT_KEEP) ? VP8_PP_LIMIT_KEEP - 1 :
+                                   ppl;
+        }
+    }
+
+    return 1;
+}
+
+/* Fills the deblocking limits of one MB row from its modes. MBs with no
+ * residual only carry the blocking of their prediction and get half the
+ * strength. Skipped ZEROMV MBs from the last frame are near copies of it;
+ * when the previous output is still in post_proc_buffer they keep it.
+ */
+static void build_mb_limits(VP8_COMMON *oci, unsigned char *limits, int mb_row)
+{
+    const struct postproc_state *state = &oci->postproc_state;
+    const loop_filter_info_n *lfi_n = &oci->lf_info;
+    const MODE_INFO *mi = oci->show_frame_mi + mb_row * oci->mode_info_stride;
+    int mb_col;
+
+    for (mb_col = 0; mb_col < oci->mb_cols; mb_col++, mi++)
+    {
+        const MB_MODE_INFO *mbmi = &mi->mbmi;
+        const int coded = !mbmi->mb_skip_coeff ||
+                          mbmi->mode == B_PRED || mbmi->mode == SPLITMV;
+        int level = 0;
+
+        if (oci->filter_level)
+            level = lfi_n->lvl[mbmi->segment_id][mbmi->ref_frame]
+                              [lfi_n->mode_lf_lut[mbmi->mode]];
+
+        if (coded)
+            limits[mb_col] = state->mb_ppl[level];
+        else if (state->rows_keep_static &&
+                 mbmi->ref_frame == LAST_FRAME && mbmi->mode == ZEROMV)
+            limits[mb_col] = VP8_PP_LIMIT_KEEP;
+        else
+            limits[mb_col] = state->mb_ppl[level] >> 1;
+    }
+}
+
+static void post_proc_mb_rows(VP8_COMMON *oci, YV12_BUFFER_CONFIG *source,
+                              int mb_row_start, int mb_row_end)
+{
+    struct postproc_state *state = &oci->postproc_state;
+    YV12_BUFFER_CONFIG *post = &oci->post_proc_buffer;
+    int mb_row;
+
+    if (!(state->rows_flags & VP8D_MB_ADAPTIVE))
+    {
+        deblock_mb_rows(source, post, state->rows_ppl, state->rows_flimit_mb,
+                        mb_row_start, mb_row_end);
+        return;
+    }
+
+    for (mb_row = mb_row_start; mb_row < mb_row_end; mb_row++)
+    {
+        unsigned char *limits = oci->pp_limits_buffer + mb_row * oci->mb_cols;
+        int y_offset = mb_row * 16;
+        int uv_offset = mb_row * 8;
+
+        build_mb_limits(oci, limits, mb_row);
+
+        vp8_post_proc_down_and_across_mb_row(source->y_buffer + y_offset * source->y_stride,
+                                             post->y_buffer + y_offset * post->y_stride,
+                                             source->y_stride, post->y_stride,
+                                             source->y_width, limits, 16);
+        vp8_post_proc_down_and_across_mb_row(source->u_buffer + uv_offset * source->uv_stride,
+                                             post->u_buffer + uv_offset * post->uv_stride,
+                                             source->uv_stride, post->uv_stride,
+                                             source->uv_width, limits, 8);
+        vp8_post_proc_down_and_across_mb_row(source->v_buffer + uv_offset * source->uv_stride,
+                                             post->v_buffer + uv_offset * post->uv_stride,
+                                             source->uv_stride, post->uv_stride,
+                                             source->uv_width, limits, 8);
+
+        if (state->rows_flimit_mb)
+            vp8_mbpost_proc_across_ip(post->y_buffer + y_offset * post->y_stride,
+                                      post->y_stride, 16, post->y_width,
+                                      state->rows_flimit_mb);
+    }
+}
+
+int vp8_post_proc_rows_init(VP8_COMMON *oci, vp8_ppflags_t *ppflags)
+{
+    struct postproc_state *state = &oci->postproc_state;
+
+    state->rows_start = 0;
+    state->rows_end = 0;
+
+    /* MFQE blends in the previous frame before deblocking and needs the
+     * whole frame; leave it to vp8_post_proc_frame() when it's likely.
+     */
+    if ((ppflags->post_proc_flag & VP8D_MFQE) &&
+        oci->base_qindex - state->last_base_qindex >= 10)
+    {
+        state->rows_flags = 0;
+        return 0;
+    }
+
+    return deblock_setup(oci, ppflags);
+}
+
+void vp8_post_proc_rows(VP8_COMMON *oci, int mb_row_start, int mb_row_end)
+{
+    post_proc_mb_rows(oci, &oci->yv12_fb[oci->new_fb_idx],
+                      mb_row_start, mb_row_end);
+}
+
+/* Deblocks the frame to show into post_proc_buffer, skipping the rows done
+ * ahead if they were done with the same settings.
+ */
+static void deblock_frame(VP8_COMMON *oci, vp8_ppflags_t *ppflags)
+{
+    struct postproc_state *state = &oci->postproc_state;
+    YV12_BUFFER_CONFIG *post = &oci->post_proc_buffer;
+    const int rows_flags = state->rows_flags;
+    const int rows_q = state->rows_q;
+    const int rows_keep_static = state->rows_keep_static;
+    int rows_start = state->rows_start;
+    int rows_end = state->rows_end;
+
+    deblock_setup(oci, ppflags);
+
+    if (rows_start >= rows_end ||
+        state->rows_flags != rows_flags || state->rows_q != rows_q ||
+        state->rows_keep_static != rows_keep_static ||
+        oci->frame_to_show != &oci->yv12_fb[oci->new_fb_idx])
+    {
+        rows_start = 0;
+        rows_end = 0;
+    }
+
+    post_proc_mb_rows(oci, oci->frame_to_show, 0, rows_start);
+    post_proc_mb_rows(oci, oci->frame_to_show, rows_end, oci->mb_rows);
+
+    if (state->rows_flimit_mb)
+        vp8_mbpost_proc_down(post->y_buffer, post->y_stride, post->y_height,
+                             post->y_width, state->rows_flimit_mb);
+
+    state->rows_start = 0;
+    state->rows_end = 0;
+}
+
 int vp8_post_proc_frame(VP8_COMMON *oci, YV12_BUFFER_CONFIG *dest, vp8_ppflags_t *ppflags)
 {
     int q = oci->filter_level * 10 / 6;
     int flags = ppflags->post_proc_flag;
     int deblock_level = ppflags->deblocking_level;
     int noise_level = ppflags->noise_level;
+    int prev_deblocked = 0;
 
     if (!oci->frame_to_show)
         return -1;
@@ -922,9 +1275,16 @@ int vp8_post_proc_frame(VP8_COMMON *oci, YV12_BUFFER_CONFIG *dest, vp8_ppflags_t
         dest->y_height = oci->Height;
         dest->uv_height = dest->y_height / 2;
         oci->postproc_state.last_base_qindex = oci->base_qindex;
+        oci->postproc_state.prev_deblocked = 0;
         return 0;
     }
 
+    /* The filters read the rows around the picture, which a decoder with
+     * unbordered references has not filled in.
+     */
+    if (oci->unbordered_refs)
+        vp8_yv12_extend_frame_borders_ptr(oci->frame_to_show);
+
     /* Allocate post_proc_buffer_int if needed */
     if ((flags & VP8D_MFQE) && !oci->post_proc_buffer_int_used)
     {
@@ -968,17 +1328,13 @@ int vp8_post_proc_frame(VP8_COMMON *oci, YV12_BUFFER_CONFIG *dest, vp8_ppflags_t
         /* Move partially towards the base q of the previous frame */
         oci->postproc_state.last_base_qindex = (3*oci->postproc_state.last_base_qindex + oci->base_qindex)>>2;
     }
-    else if (flags & VP8D_DEMACROBLOCK)
+    else if ((flags & VP8D_DEMACROBLOCK) || (flags & VP8D_DEBLOCK))
     {
-        vp8_deblock_and_de_macro_block(oci->frame_to_show, &oci->post_proc_buffer,
-                                       q + (deblock_level - 5) * 10, 1, 0);
-        oci->postproc_state.last_base_qindex = oci->base_qindex;
-    }
-    else if (flags & VP8D_DEBLOCK)
-    {
-        vp8_deblock(oci->frame_to_show, &oci->post_proc_buffer,
-                    q, 1, 0);
+        deblock_frame(oci, ppflags);
         oci->postproc_state.last_base_qindex = oci->base_qindex;
+
+        /* Nothing else will draw on top of this output. */
+        prev_deblocked = !(flags & ~(VP8D_DEBLOCK | VP8D_MB_ADAPTIVE | VP8D_MFQE));
     }
     else
     {
@@ -1363,6 +1719,8 @@ int vp8_post_proc_frame(VP8_COMMON *oci, YV12_BUFFER_CONFIG *dest, vp8_ppflags_t
     }
 #endif
 
+    oci->postproc_state.prev_deblocked = prev_deblocked;
+
     *dest = oci->post_proc_buffer;
 
     /* handle problem with extending borders */
@@ -13,6 +13,12 @@
 #define POSTPROC_H
 
 #include "vpx_ports/mem.h"
+
+/* Per MB limit of vp8_post_proc_down_and_across_mb_row() for an MB whose
+ * destination pixels are to be left as they are.
+ */
+#define VP8_PP_LIMIT_KEEP 255
+
 struct postproc_state
 {
     int           last_q;
@@ -22,12 +28,39 @@ struct postproc_state
     DECLARE_ALIGNED(16, char, blackclamp[16]);
     DECLARE_ALIGNED(16, char, whiteclamp[16]);
     DECLARE_ALIGNED(16, char, bothclamp[16]);
+
+    /* Deblocking applied ahead of vp8_post_proc_frame(), e.g. by the decoder
+     * threads: MB rows [rows_start, rows_end) have been done with these
+     * settings.
+     */
+    int           rows_flags;
+    int           rows_q;
+    int           rows_ppl;
+    int           rows_flimit_mb;
+    int           rows_start;
+    int           rows_end;
+
+    /* VP8D_MB_ADAPTIVE: deblocking limit per loop filter level, whether
+     * static MBs keep the previous output, and whether post_proc_buffer
+     * holds the previous frame deblocked with no further processing.
+     */
+    unsigned char mb_ppl[64];
+    int           rows_keep_static;
+    int           prev_deblocked;
 };
 #include "onyxc_int.h"
 #include "ppflags.h"
 int vp8_post_proc_frame(struct VP8Common *oci, YV12_BUFFER_CONFIG *dest,
                         vp8_ppflags_t *flags);
 
+/* Row-wise deblocking of the frame being decoded, so that the decoder can
+ * postprocess each MB row while it is still in cache. Returns non zero if
+ * these flags have row work to do; the caller then records the rows done in
+ * rows_start/rows_end and vp8_post_proc_frame() completes the rest.
+ */
+int vp8_post_proc_rows_init(struct VP8Common *oci, vp8_ppflags_t *flags);
+void vp8_post_proc_rows(struct VP8Common *oci, int mb_row_start, int mb_row_end);
+
 
 void vp8_de_noise(YV12_BUFFER_CONFIG         *source,
                   YV12_BUFFER_CONFIG         *post,
@@ -24,7 +24,8 @@ enum
     VP8D_DEBUG_DRAW_MV          = 1<<7,
     VP8D_DEBUG_CLR_BLK_MODES    = 1<<8,
     VP8D_DEBUG_CLR_FRM_REF_BLKS = 1<<9,
-    VP8D_MFQE                   = 1<<10
+    VP8D_MFQE                   = 1<<10,
+    VP8D_MB_ADAPTIVE            = 1<<11
 };
 
 typedef struct
@@ -158,21 +158,90 @@ void vp8_build_inter_predictors_b(BLOCKD *d, int pitch, vp8_subpix_fn_t sppf)
     }
 }
 
+/* With unbordered references (x->emulate_edges) nothing outside the
+ * reference picture may be read. A w x h block at (col, row) of its
+ * MB, displaced by mv, whose filter taps reach outside the picture is
+ * copied to buf with the edge pixels replicated, as the extended border
+ * would have held them, and is predicted from there. Returns where to
+ * predict from and updates stride to match.
+ */
+static unsigned char *emulate_edges(const MACROBLOCKD *x, unsigned char *ptr,
+                                    int *stride, int col, int row,
+                                    const MV *mv, int w, int h, int uv,
+                                    unsigned char *buf)
+{
+    /* The sub-pixel filters read 2 pixels before and 3 after the block. */
+    const int before = (mv->row & 7 || mv->col & 7) ? 2 : 0;
+    const int after = before ? 3 : 0;
+    const int width = ((x->mb_to_right_edge - x->mb_to_left_edge) >> (3 + uv))
+                      + (16 >> uv);
+    const int height = ((x->mb_to_bottom_edge - x->mb_to_top_edge) >> (3 + uv))
+                       + (16 >> uv);
+    int r, c;
+
+    col += (-x->mb_to_left_edge >> (3 + uv)) + (mv->col >> 3);
+    row += (-x->mb_to_top_edge >> (3 + uv)) + (mv->row >> 3);
+
+    if (col - before >= 0 && row - before >= 0
+        && col + w + after <= width && row + h + after <= height)
+        return ptr;
+
+    for (r = 0; r < before + h + after; r++)
+    {
+        int y = row - before + r;
+        const unsigned char *src;
+
+        y = y < 0 ? 0 : y >= height ? height - 1 : y;
+        src = ptr + (y - row) * *stride - col;
+
+        for (c = 0; c < before + w + after; c++)
+        {
+            int x0 = col - before + c;
+
+            x0 = x0 < 0 ? 0 : x0 >= width ? width - 1 : x0;
+            buf[r * EDGE_BUF_STRIDE + c] = src[x0];
+        }
+    }
+
+    *stride = EDGE_BUF_STRIDE;
+    return buf + before * EDGE_BUF_STRIDE + before;
+}
+
+/* emulate_edges() for block d of x, at its place in the MB */
+static unsigned char *emulate_block_edges(MACROBLOCKD *x,
+                                          const BLOCKD *d, unsigned char *ptr,
+                                          int *stride, int w, int h)
+{
+    const int i = (int)(d - x->block);
+    const int j = (i - 16) & 3;
+
+    if (i < 16)
+        return emulate_edges(x, ptr, stride, (i & 3) * 4, (i >> 2) * 4,
+                             &d->bmi.mv.as_mv, w, h, 0, x->edge_buf);
+
+    return emulate_edges(x, ptr, stride, (j & 1) * 4, (j >> 1) * 4,
+                         &d->bmi.mv.as_mv, w, h, 1, x->edge_buf);
+}
+
 static void build_inter_predictors4b(MACROBLOCKD *x, BLOCKD *d, unsigned char *dst, int dst_stride)
 {
     unsigned char *ptr_base;
     unsigned char *ptr;
+    int pre_stride = d->pre_stride;
 
     ptr_base = *(d->base_pre);
     ptr = ptr_base + d->pre + (d->bmi.mv.as_mv.row >> 3) * d->pre_stride + (d->bmi.mv.as_mv.col >> 3);
 
+    if (x->emulate_edges)
+        ptr = emulate_block_edges(x, d, ptr, &pre_stride, 8, 8);
+
     if (d->bmi.mv.as_mv.row & 7 || d->bmi.mv.as_mv.col & 7)
     {
-        x->subpixel_predict8x8(ptr, d->pre_stride, d->bmi.mv.as_mv.col & 7, d->bmi.mv.as_mv.row & 7, dst, dst_stride);
+        x->subpixel_predict8x8(ptr, pre_stride, d->bmi.mv.as_mv.col & 7, d->bmi.mv.as_mv.row & 7, dst, dst_stride);
     }
     else
     {
-        vp8_copy_mem8x8(ptr, d->pre_stride, dst, dst_stride);
+        vp8_copy_mem8x8(ptr, pre_stride, dst, dst_stride);
     }
 }
 
@@ -180,38 +249,41 @@ static void build_inter_predictors2b(MACROBLOCKD *x, BLOCKD *d, unsigned char *d
 {
     unsigned char *ptr_base;
     unsigned char *ptr;
+    int pre_stride = d->pre_stride;
 
     ptr_base = *(d->base_pre);
     ptr = ptr_base + d->pre + (d->bmi.mv.as_mv.row >> 3) * d->pre_stride + (d->bmi.mv.as_mv.col >> 3);
 
+    if (x->emulate_edges)
+        ptr = emulate_block_edges(x, d, ptr, &pre_stride, 8, 4);
+
     if (d->bmi.mv.as_mv.row & 7 || d->bmi.mv.as_mv.col & 7)
     {
-        x->subpixel_predict8x4(ptr, d->pre_stride, d->bmi.mv.as_mv.col & 7, d->bmi.mv.as_mv.row & 7, dst, dst_stride);
+        x->subpixel_predict8x4(ptr, pre_stride, d->bmi.mv.as_mv.col & 7, d->bmi.mv.as_mv.row & 7, dst, dst_stride);
     }
     else
     {
-        vp8_copy_mem8x4(ptr, d->pre_stride, dst, dst_stride);
+        vp8_copy_mem8x4(ptr, pre_stride, dst, dst_stride);
     }
 }
 
-static void build_inter_predictors_b(BLOCKD *d, unsigned char *dst, int dst_stride, vp8_subpix_fn_t sppf)
+static void build_inter_predictors_b(MACROBLOCKD *x, BLOCKD *d, unsigned char *dst, int dst_stride, vp8_subpix_fn_t sppf)
 {
     int r;
-    unsigned char *ptr_base;
     unsigned char *ptr;
+    int pre_stride = d->pre_stride;
 
-    ptr_base = *(d->base_pre);
+    ptr = *(d->base_pre) + d->pre + (d->bmi.mv.as_mv.row >> 3) * d->pre_stride + (d->bmi.mv.as_mv.col >> 3);
+
+    if (x->emulate_edges)
+        ptr = emulate_block_edges(x, d, ptr, &pre_stride, 4, 4);
 
     if (d->bmi.mv.as_mv.row & 7 || d->bmi.mv.as_mv.col & 7)
     {
-        ptr = ptr_base + d->pre + (d->bmi.mv.as_mv.row >> 3) * d->pre_stride + (d->bmi.mv.as_mv.col >> 3);
-        sppf(ptr, d->pre_stride, d->bmi.mv.as_mv.col & 7, d->bmi.mv.as_mv.row & 7, dst, dst_stride);
+        sppf(ptr, pre_stride, d->bmi.mv.as_mv.col & 7, d->bmi.mv.as_mv.row & 7, dst, dst_stride);
     }
     else
     {
-        ptr_base += d->pre + (d->bmi.mv.as_mv.row >> 3) * d->pre_stride + (d->bmi.mv.as_mv.col >> 3);
-        ptr = ptr_base;
-
         for (r = 0; r < 4; r++)
         {
 #if !(CONFIG_FAST_UNALIGNED)
@@ -223,7 +295,7 @@ static void build_inter_predictors_b(BLOCKD *d, unsigned char *dst, int dst_stri
             *(uint32_t *)dst = *(uint32_t *)ptr ;
 #endif
             dst     += dst_stride;
-            ptr         += d->pre_stride;
+            ptr         += pre_stride;
         }
     }
 }
@@ -396,6 +468,7 @@ void vp8_build_inter16x16_predictors_mb(MACROBLOCKD *x,
 
     unsigned char *ptr_base = x->pre.y_buffer;
     int pre_stride = x->block[0].pre_stride;
+    int ptr_stride;
 
     _16x16mv.as_int = x->mode_info_context->mbmi.mv.as_int;
 
@@ -405,14 +478,19 @@ void vp8_build_inter16x16_predictors_mb(MACROBLOCKD *x,
     }
 
     ptr = ptr_base + ( _16x16mv.as_mv.row >> 3) * pre_stride + (_16x16mv.as_mv.col >> 3);
+    ptr_stride = pre_stride;
+
+    if (x->emulate_edges)
+        ptr = emulate_edges(x, ptr, &ptr_stride, 0, 0, &_16x16mv.as_mv,
+                            16, 16, 0, x->edge_buf);
 
     if ( _16x16mv.as_int & 0x00070007)
     {
-        x->subpixel_predict16x16(ptr, pre_stride, _16x16mv.as_mv.col & 7,  _16x16mv.as_mv.row & 7, dst_y, dst_ystride);
+        x->subpixel_predict16x16(ptr, ptr_stride, _16x16mv.as_mv.col & 7,  _16x16mv.as_mv.row & 7, dst_y, dst_ystride);
     }
     else
     {
-        vp8_copy_mem16x16(ptr, pre_stride, dst_y, dst_ystride);
+        vp8_copy_mem16x16(ptr, ptr_stride, dst_y, dst_ystride);
     }
 
     /* calc uv motion vectors */
@@ -427,15 +505,25 @@ void vp8_build_inter16x16_predictors_mb(MACROBLOCKD *x,
     offset = ( _16x16mv.as_mv.row >> 3) * pre_stride + (_16x16mv.as_mv.col >> 3);
     uptr = x->pre.u_buffer + offset;
     vptr = x->pre.v_buffer + offset;
+    ptr_stride = pre_stride;
+
+    /* U and V go side by side in edge_buf. */
+    if (x->emulate_edges)
+    {
+        uptr = emulate_edges(x, uptr, &ptr_stride, 0, 0, &_16x16mv.as_mv,
+                             8, 8, 1, x->edge_buf);
+        vptr = emulate_edges(x, vptr, &pre_stride, 0, 0, &_16x16mv.as_mv,
+                             8, 8, 1, x->edge_buf + 16);
+    }
 
     if ( _16x16mv.as_int & 0x00070007)
     {
-        x->subpixel_predict8x8(uptr, pre_stride, _16x16mv.as_mv.col & 7,  _16x16mv.as_mv.row & 7, dst_u, dst_uvstride);
+        x->subpixel_predict8x8(uptr, ptr_stride, _16x16mv.as_mv.col & 7,  _16x16mv.as_mv.row & 7, dst_u, dst_uvstride);
         x->subpixel_predict8x8(vptr, pre_stride, _16x16mv.as_mv.col & 7,  _16x16mv.as_mv.row & 7, dst_v, dst_uvstride);
     }
     else
     {
-        vp8_copy_mem8x8(uptr, pre_stride, dst_u, dst_uvstride);
+        vp8_copy_mem8x8(uptr, ptr_stride, dst_u, dst_uvstride);
         vp8_copy_mem8x8(vptr, pre_stride, dst_v, dst_uvstride);
     }
 }
@@ -490,8 +578,8 @@ static void build_inter4x4_predictors_mb(MACROBLOCKD *x)
                 build_inter_predictors2b(x, d0, *(d0->base_dst) + d0->dst, dst_stride);
             else
             {
-                build_inter_predictors_b(d0, *(d0->base_dst) + d0->dst, dst_stride, x->subpixel_predict);
-                build_inter_predictors_b(d1, *(d1->base_dst) + d1->dst, dst_stride, x->subpixel_predict);
+                build_inter_predictors_b(x, d0, *(d0->base_dst) + d0->dst, dst_stride, x->subpixel_predict);
+                build_inter_predictors_b(x, d1, *(d1->base_dst) + d1->dst, dst_stride, x->subpixel_predict);
             }
 
         }
@@ -510,8 +598,8 @@ static void build_inter4x4_predictors_mb(MACROBLOCKD *x)
             build_inter_predictors2b(x, d0, *(d0->base_dst) + d0->dst, dst_stride);
         else
         {
-            build_inter_predictors_b(d0, *(d0->base_dst) + d0->dst, dst_stride, x->subpixel_predict);
-            build_inter_predictors_b(d1, *(d1->base_dst) + d1->dst, dst_stride, x->subpixel_predict);
+            build_inter_predictors_b(x, d0, *(d0->base_dst) + d0->dst, dst_stride, x->subpixel_predict);
+            build_inter_predictors_b(x, d1, *(d1->base_dst) + d1->dst, dst_stride, x->subpixel_predict);
         }
     }
 }
@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include <math.h>
+#include "vpx_config.h"
+#include "vpx_rtcd.h"
+#include "vpx_mem/vpx_mem.h"
+#include "filter.h"
+#include "resize.h"
+
+void vp8_resize_v_c(const unsigned char *const *rows, unsigned char *dst,
+                    int width, const short *filter)
+{
+    int x, k;
+
+    for (x = 0; x < width; x++)
+    {
+        int sum = VP8_FILTER_WEIGHT / 2;
+
+        for (k = 0; k < RESIZE_TAPS; k++)
+            sum += rows[k][x] * filter[k];
+
+        sum >>= VP8_FILTER_SHIFT;
+        dst[x] = sum < 0 ? 0 : sum > 255 ? 255 : sum;
+    }
+}
+
+void vp8_resize_h_c(const unsigned char *src, unsigned char *dst, int width,
+                    const int *offset, const short *filter)
+{
+    int x, k;
+
+    for (x = 0; x < width; x++)
+    {
+        const unsigned char *s = src + offset[x];
+        int sum = VP8_FILTER_WEIGHT / 2;
+
+        for (k = 0; k < RESIZE_TAPS; k++)
+            sum += s[k] * filter[k];
+
+        sum >>= VP8_FILTER_SHIFT;
+        dst[x] = sum < 0 ? 0 : sum > 255 ? 255 : sum;
+        filter += RESIZE_TAPS;
+    }
+}
+
+/* Keys' cubic convolution kernel, a = -0.5. */
+static double cubic(double x)
+{
+    x = fabs(x);
+
+    if (x < 1)
+        return (1.5 * x - 2.5) * x * x + 1;
+
+    if (x < 2)
+        return ((-0.5 * x + 2.5) * x - 4) * x + 2;
+
+    return 0;
+}
+
+static void free_axis(RESIZE_AXIS *a)
+{
+    vpx_free(a->offset);
+    vpx_free(a->filter);
+    a->offset = 0;
+    a->filter = 0;
+    a->in_size = 0;
+    a->out_size = 0;
+}
+
+static int init_axis(RESIZE_AXIS *a, int in, int out)
+{
+    const double ratio = (double)in / out;
+
+    /* Down-scaling stretches the kernel by the ratio to cut the
+     * frequencies the output cannot hold, up to what RESIZE_TAPS covers.
+     */
+    const double scale = ratio > 1 ? 1 / ratio : 1;
+    int i, k;
+
+    if (a->in_size == in && a->out_size == out)
+        return 0;
+
+    free_axis(a);
+    a->offset = vpx_malloc(out * sizeof(*a->offset));
+    a->filter = vpx_malloc(out * RESIZE_TAPS * sizeof(*a->filter));
+
+    if (!a->offset || !a->filter)
+    {
+        free_axis(a);
+        return 1;
+    }
+
+    for (i = 0; i < out; i++)
+    {
+        const double center = (i + 0.5) * ratio - 0.5;
+        const int first = (int)floor(center) - (RESIZE_TAPS / 2 - 1);
+        short *f = a->filter + i * RESIZE_TAPS;
+        double w[RESIZE_TAPS];
+        double sum = 0;
+        int total = 0;
+        int peak = 0;
+
+        for (k = 0; k < RESIZE_TAPS; k++)
+        {
+            w[k] = cubic((first + k - center) * scale);
+            sum += w[k];
+        }
+
+        for (k = 0; k < RESIZE_TAPS; k++)
+        {
+            f[k] = (short)floor(w[k] * VP8_FILTER_WEIGHT / sum + 0.5);
+            total += f[k];
+
+            if (f[k] > f[peak])
+                peak = k;
+        }
+
+        /* Rounding must not change the gain. */
+        f[peak] += VP8_FILTER_WEIGHT - total;
+        a->offset[i] = first;
+    }
+
+    a->in_size = in;
+    a->out_size = out;
+    return 0;
+}
+
+int vp8_resize_init(RESIZE_CTX *ctx, int in_width, int in_height,
+                    int out_width, int out_height, int threads)
+{
+    /* The row buffers have RESIZE_TAPS pixels of margin on both sides for
+     * the taps that reach past the picture.
+     */
+    const int row_size = (in_width + 2 * RESIZE_TAPS + 15) & ~15;
+
+    if (init_axis(&ctx->h[0], in_width, out_width)
+        || init_axis(&ctx->v[0], in_height, out_height)
+        || init_axis(&ctx->h[1], (in_width + 1) / 2, (out_width + 1) / 2)
+        || init_axis(&ctx->v[1], (in_height + 1) / 2, (out_height + 1) / 2))
+    {
+        vp8_resize_free(ctx);
+        return 1;
+    }
+
+    if (ctx->rows < threads || ctx->row_size != row_size)
+    {
+        vpx_free(ctx->row_buf);
+        ctx->row_buf = vpx_memalign(16, threads * row_size);
+        ctx->rows = threads;
+        ctx->row_size = row_size;
+
+        if (!ctx->row_buf)
+        {
+            vp8_resize_free(ctx);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void vp8_resize_free(RESIZE_CTX *ctx)
+{
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        free_axis(&ctx->h[i]);
+        free_axis(&ctx->v[i]);
+    }
+
+    vpx_free(ctx->row_buf);
+    ctx->row_buf = 0;
+    ctx->rows = 0;
+    ctx->row_size = 0;
+}
+
+int vp8_resize_bands(const RESIZE_CTX *ctx)
+{
+    return (ctx->v[0].out_size + RESIZE_BAND_HEIGHT - 1) / RESIZE_BAND_HEIGHT;
+}
+
+static void resize_plane(const RESIZE_AXIS *h, const RESIZE_AXIS *v,
+                         const unsigned char *src, int src_stride,
+                         unsigned char *dst, int dst_stride,
+                         int y, int height, unsigned char *row)
+{
+    const unsigned char *rows[RESIZE_TAPS];
+    const int end = y + height < v->out_size ? y + height : v->out_size;
+    int k;
+
+    for (; y < end; y++)
+    {
+        const int first = v->offset[y];
+
+        for (k = 0; k < RESIZE_TAPS; k++)
+        {
+            int r = first + k;
+
+            r = r < 0 ? 0 : r >= v->in_size ? v->in_size - 1 : r;
+            rows[k] = src + r * src_stride;
+        }
+
+        vp8_resize_v(rows, row, h->in_size, v->filter + y * RESIZE_TAPS);
+
+        vpx_memset(row - RESIZE_TAPS, row[0], RESIZE_TAPS);
+        vpx_memset(row + h->in_size, row[h->in_size - 1], RESIZE_TAPS);
+
+        vp8_resize_h(row, dst + y * dst_stride, h->out_size, h->offset,
+                     h->filter);
+    }
+}
+
+void vp8_resize_band(const RESIZE_CTX *ctx, const YV12_BUFFER_CONFIG *src,
+                     YV12_BUFFER_CONFIG *dst, int band, int thread)
+{
+    unsigned char *row = ctx->row_buf + thread * ctx->row_size + RESIZE_TAPS;
+    const int y = band * RESIZE_BAND_HEIGHT;
+
+    resize_plane(&ctx->h[0], &ctx->v[0], src->y_buffer, src->y_stride,
+                 dst->y_buffer, dst->y_stride, y, RESIZE_BAND_HEIGHT, row);
+    resize_plane(&ctx->h[1], &ctx->v[1], src->u_buffer, src->uv_stride,
+                 dst->u_buffer, dst->uv_stride, y / 2, RESIZE_BAND_HEIGHT / 2,
+                 row);
+    resize_plane(&ctx->h[1], &ctx->v[1], src->v_buffer, src->uv_stride,
+                 dst->v_buffer, dst->uv_stride, y / 2, RESIZE_BAND_HEIGHT / 2,
+                 row);
+}
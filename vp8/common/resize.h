@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#ifndef __INC_RESIZE_H
+#define __INC_RESIZE_H
+
+#include "vpx_scale/yv12config.h"
+
+/* Polyphase frame resizer for any ratio. Each output pixel is a RESIZE_TAPS
+ * tap filter, in VP8_FILTER_WEIGHT units, of the source pixels around its
+ * position: a bicubic kernel, stretched when down-scaling so it also
+ * low-pass filters. A frame is resized vertically into a row, then
+ * horizontally, one band of 16 luma rows at a time, so the bands can be
+ * spread over threads. The filters of a given resize live in a RESIZE_CTX;
+ * there is no shared state.
+ */
+#define RESIZE_TAPS         8
+#define RESIZE_BAND_HEIGHT  16
+
+typedef struct
+{
+    int in_size;
+    int out_size;
+    int *offset;        /* first source pixel of each output pixel's taps */
+    short *filter;      /* RESIZE_TAPS taps per output pixel */
+} RESIZE_AXIS;
+
+typedef struct
+{
+    RESIZE_AXIS h[2];   /* [0] luma, [1] chroma */
+    RESIZE_AXIS v[2];
+    int rows;           /* number of row buffers */
+    int row_size;
+    unsigned char *row_buf;
+} RESIZE_CTX;
+
+/* Sets ctx up to resize in_width x in_height frames to out_width x
+ * out_height, with one row buffer for each of threads callers. Does
+ * nothing if it is set up that way already. Returns non-zero if out of
+ * memory.
+ */
+int vp8_resize_init(RESIZE_CTX *ctx, int in_width, int in_height,
+                    int out_width, int out_height, int threads);
+void vp8_resize_free(RESIZE_CTX *ctx);
+
+/* Number of bands of RESIZE_BAND_HEIGHT output rows in a frame. */
+int vp8_resize_bands(const RESIZE_CTX *ctx);
+
+/* Resizes band of src into dst, using row buffer thread. Only the output
+ * picture is written; the caller extends it.
+ */
+void vp8_resize_band(const RESIZE_CTX *ctx, const YV12_BUFFER_CONFIG *src,
+                     YV12_BUFFER_CONFIG *dst, int band, int thread);
+
+#endif
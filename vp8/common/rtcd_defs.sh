@@ -154,6 +154,9 @@ if [ "$CONFIG_POSTPROC" = "yes" ]; then
     specialize vp8_post_proc_down_and_across mmx sse2
     vp8_post_proc_down_and_across_sse2=vp8_post_proc_down_and_across_xmm
 
+    prototype void vp8_post_proc_down_and_across_mb_row "unsigned char *src, unsigned char *dst, int src_pitch, int dst_pitch, int cols, unsigned char *flimits, int size"
+    # no asm yet
+
     prototype void vp8_plane_add_noise "unsigned char *s, char *noise, char blackclamp[16], char whiteclamp[16], char bothclamp[16], unsigned int w, unsigned int h, int pitch"
     specialize vp8_plane_add_noise mmx sse2
     vp8_plane_add_noise_sse2=vp8_plane_add_noise_wmt
@@ -203,6 +206,15 @@ prototype void vp8_bilinear_predict4x4 "unsigned char *src, int src_pitch, int x
 specialize vp8_bilinear_predict4x4 mmx media neon
 vp8_bilinear_predict4x4_media=vp8_bilinear_predict4x4_armv6
 
+#
+# Polyphase resize (RESIZE_TAPS tap filters, see resize.h)
+#
+prototype void vp8_resize_v "const unsigned char *const *rows, unsigned char *dst, int width, const short *filter"
+specialize vp8_resize_v sse2
+
+prototype void vp8_resize_h "const unsigned char *src, unsigned char *dst, int width, const int *offset, const short *filter"
+specialize vp8_resize_h sse2
+
 #
 # Encoder functions below this point.
 #
@@ -294,6 +306,12 @@ vp8_mse16x16_media=vp8_mse16x16_armv6
 prototype unsigned int vp8_get4x4sse_cs "const unsigned char *src_ptr, int source_stride, const unsigned char *ref_ptr, int  ref_stride"
 specialize vp8_get4x4sse_cs mmx neon
 
+#
+# 4x4 intra mode search: the predictors of several modes and their SSE in one pass
+#
+prototype void vp8_intra4x4_predict_all "unsigned char *dst, int dst_stride, const unsigned char *src, int src_stride, int num_modes, unsigned char *pred, unsigned int *sse"
+specialize vp8_intra4x4_predict_all sse2
+
 #
 # Single block SAD
 #
@@ -318,6 +336,18 @@ specialize vp8_sad16x16 mmx sse2 sse3 media neon
 vp8_sad16x16_sse2=vp8_sad16x16_wmt
 vp8_sad16x16_media=vp8_sad16x16_armv6
 
+#
+# Single block SATD (sum of absolute 4x4 Walsh-Hadamard transformed differences)
+#
+prototype unsigned int vp8_satd4x4 "const unsigned char *src_ptr, int source_stride, const unsigned char *ref_ptr, int ref_stride"
+specialize vp8_satd4x4 sse2
+
+prototype unsigned int vp8_satd8x8 "const unsigned char *src_ptr, int source_stride, const unsigned char *ref_ptr, int ref_stride"
+specialize vp8_satd8x8 sse2
+
+prototype unsigned int vp8_satd16x16 "const unsigned char *src_ptr, int source_stride, const unsigned char *ref_ptr, int ref_stride"
+specialize vp8_satd16x16 sse2
+
 #
 # Multi-block SAD, comparing a reference to N blocks 1 pixel apart horizontally
 #
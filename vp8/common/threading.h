@@ -90,4 +90,39 @@
 
 #endif /* CONFIG_OS_SUPPORT && CONFIG_MULTITHREAD */
 
+/* Counters one thread publishes and another polls. The store is ordered
+ * after the writes of the data it guards, and the data read after a load
+ * that saw the new value is at least as new as the store.
+ */
+#if CONFIG_OS_SUPPORT && CONFIG_MULTITHREAD
+#if defined(_MSC_VER)
+#define vp8_memory_barrier() MemoryBarrier()
+#elif defined(__GNUC__)
+#define vp8_memory_barrier() __sync_synchronize()
+#else
+#define vp8_memory_barrier() \
+    { \
+        static pthread_mutex_t barrier_lock = PTHREAD_MUTEX_INITIALIZER; \
+        pthread_mutex_lock(&barrier_lock); \
+        pthread_mutex_unlock(&barrier_lock); \
+    }
+#endif
+#else
+#define vp8_memory_barrier()
+#endif
+
+static __inline void vp8_atomic_store_release(volatile int *p, int v)
+{
+    vp8_memory_barrier();
+    *p = v;
+}
+
+static __inline int vp8_atomic_load_acquire(const volatile int *p)
+{
+    int v = *p;
+
+    vp8_memory_barrier();
+    return v;
+}
+
 #endif
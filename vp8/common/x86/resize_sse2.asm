@@ -0,0 +1,231 @@
+;
+;  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+;
+;  Use of this source code is governed by a BSD-style license
+;  that can be found in the LICENSE file in the root of the source
+;  tree. An additional intellectual property rights grant can be found
+;  in the file PATENTS.  All contributing project authors may
+;  be found in the AUTHORS file in the root of the source tree.
+;
+
+
+%include "vpx_ports/x86_abi_support.asm"
+
+%define VP8_FILTER_SHIFT 7
+
+;void vp8_resize_v_sse2_impl
+;(
+;    const unsigned char *const *rows,
+;    unsigned char *dst,
+;    int width,                          multiple of 8
+;    const short *filter
+;)
+global sym(vp8_resize_v_sse2_impl)
+sym(vp8_resize_v_sse2_impl):
+    push        rbp
+    mov         rbp, rsp
+    SHADOW_ARGS_TO_STACK 4
+    SAVE_XMM 7
+    GET_GOT     rbx
+    push        rsi
+    push        rdi
+    ALIGN_STACK 16, rax
+    sub         rsp, 16*4
+    ; end prolog
+
+        ; broadcast the tap pairs (f0,f1) (f2,f3) (f4,f5) (f6,f7)
+        mov         rax,            arg(3)          ; filter
+        movdqu      xmm0,           [rax]
+        pshufd      xmm1,           xmm0, 0x00
+        pshufd      xmm2,           xmm0, 0x55
+        pshufd      xmm3,           xmm0, 0xaa
+        pshufd      xmm0,           xmm0, 0xff
+        movdqa      [rsp],          xmm1
+        movdqa      [rsp+16],       xmm2
+        movdqa      [rsp+32],       xmm3
+        movdqa      [rsp+48],       xmm0
+
+        mov         rsi,            arg(0)          ; rows
+        mov         rdi,            arg(1)          ; dst
+        movsxd      rdx,            dword ptr arg(2) ; width
+        xor         rcx,            rcx
+        pxor        xmm7,           xmm7
+        movdqa      xmm6,           [GLOBAL(rd)]
+
+.resize_v_loop:
+        movdqa      xmm4,           xmm6            ; pixels 0-3
+        movdqa      xmm5,           xmm6            ; pixels 4-7
+
+        mov         rax,            [rsi]
+        movq        xmm0,           [rax+rcx]       ; rows[0]
+        mov         rax,            [rsi+REG_SZ_BYTES]
+        movq        xmm1,           [rax+rcx]       ; rows[1]
+        punpcklbw   xmm0,           xmm1
+        movdqa      xmm1,           xmm0
+        punpcklbw   xmm0,           xmm7
+        punpckhbw   xmm1,           xmm7
+        pmaddwd     xmm0,           [rsp]
+        pmaddwd     xmm1,           [rsp]
+        paddd       xmm4,           xmm0
+        paddd       xmm5,           xmm1
+
+        mov         rax,            [rsi+REG_SZ_BYTES*2]
+        movq        xmm0,           [rax+rcx]       ; rows[2]
+        mov         rax,            [rsi+REG_SZ_BYTES*3]
+        movq        xmm1,           [rax+rcx]       ; rows[3]
+        punpcklbw   xmm0,           xmm1
+        movdqa      xmm1,           xmm0
+        punpcklbw   xmm0,           xmm7
+        punpckhbw   xmm1,           xmm7
+        pmaddwd     xmm0,           [rsp+16]
+        pmaddwd     xmm1,           [rsp+16]
+        paddd       xmm4,           xmm0
+        paddd       xmm5,           xmm1
+
+        mov         rax,            [rsi+REG_SZ_BYTES*4]
+        movq        xmm0,           [rax+rcx]       ; rows[4]
+        mov         rax,            [rsi+REG_SZ_BYTES*5]
+        movq        xmm1,           [rax+rcx]       ; rows[5]
+        punpcklbw   xmm0,           xmm1
+        movdqa      xmm1,           xmm0
+        punpcklbw   xmm0,           xmm7
+        punpckhbw   xmm1,           xmm7
+        pmaddwd     xmm0,           [rsp+32]
+        pmaddwd     xmm1,           [rsp+32]
+        paddd       xmm4,           xmm0
+        paddd       xmm5,           xmm1
+
+        mov         rax,            [rsi+REG_SZ_BYTES*6]
+        movq        xmm0,           [rax+rcx]       ; rows[6]
+        mov         rax,            [rsi+REG_SZ_BYTES*7]
+        movq        xmm1,           [rax+rcx]       ; rows[7]
+        punpcklbw   xmm0,           xmm1
+        movdqa      xmm1,           xmm0
+        punpcklbw   xmm0,           xmm7
+        punpckhbw   xmm1,           xmm7
+        pmaddwd     xmm0,           [rsp+48]
+        pmaddwd     xmm1,           [rsp+48]
+        paddd       xmm4,           xmm0
+        paddd       xmm5,           xmm1
+
+        psrad       xmm4,           VP8_FILTER_SHIFT
+        psrad       xmm5,           VP8_FILTER_SHIFT
+        packssdw    xmm4,           xmm5
+        packuswb    xmm4,           xmm4            ; clamp to 0..255
+        movq        [rdi+rcx],      xmm4
+
+        add         rcx,            8
+        cmp         rcx,            rdx
+        jl          .resize_v_loop
+
+    ; begin epilog
+    add         rsp, 16*4
+    pop         rsp
+    pop         rdi
+    pop         rsi
+    RESTORE_GOT
+    RESTORE_XMM
+    UNSHADOW_ARGS
+    pop         rbp
+    ret
+
+
+;void vp8_resize_h_sse2_impl
+;(
+;    const unsigned char *src,
+;    unsigned char *dst,
+;    int width,                          multiple of 4
+;    const int *offset,
+;    const short *filter
+;)
+global sym(vp8_resize_h_sse2_impl)
+sym(vp8_resize_h_sse2_impl):
+    push        rbp
+    mov         rbp, rsp
+    SHADOW_ARGS_TO_STACK 5
+    SAVE_XMM 7
+    GET_GOT     rbx
+    push        rsi
+    push        rdi
+    ; end prolog
+
+        pxor        xmm7,           xmm7
+        movdqa      xmm6,           [GLOBAL(rd)]
+
+        mov         rsi,            arg(0)          ; src
+        mov         rdi,            arg(1)          ; dst
+        movsxd      rax,            dword ptr arg(2) ; width
+        mov         rdx,            arg(3)          ; offset
+        mov         rcx,            arg(4)          ; filter
+        add         rax,            rdi             ; end of dst
+        push        rbx
+
+.resize_h_loop:
+        ; the 8 source pixels under the taps of 4 output pixels
+        movsxd      rbx,            dword ptr [rdx]
+        movq        xmm0,           [rsi+rbx]
+        movsxd      rbx,            dword ptr [rdx+4]
+        movq        xmm1,           [rsi+rbx]
+        movsxd      rbx,            dword ptr [rdx+8]
+        movq        xmm2,           [rsi+rbx]
+        movsxd      rbx,            dword ptr [rdx+12]
+        movq        xmm3,           [rsi+rbx]
+
+        punpcklbw   xmm0,           xmm7
+        punpcklbw   xmm1,           xmm7
+        punpcklbw   xmm2,           xmm7
+        punpcklbw   xmm3,           xmm7
+
+        ; each output pixel has taps of its own
+        movdqu      xmm4,           [rcx]
+        movdqu      xmm5,           [rcx+16]
+        pmaddwd     xmm0,           xmm4            ; a0 a1 a2 a3
+        pmaddwd     xmm1,           xmm5            ; b0 b1 b2 b3
+        movdqu      xmm4,           [rcx+32]
+        movdqu      xmm5,           [rcx+48]
+        pmaddwd     xmm2,           xmm4            ; c0 c1 c2 c3
+        pmaddwd     xmm3,           xmm5            ; d0 d1 d2 d3
+
+        ; transpose and add up the partial sums
+        movdqa      xmm4,           xmm0
+        punpckldq   xmm0,           xmm1            ; a0 b0 a1 b1
+        punpckhdq   xmm4,           xmm1            ; a2 b2 a3 b3
+        paddd       xmm0,           xmm4
+
+        movdqa      xmm5,           xmm2
+        punpckldq   xmm2,           xmm3            ; c0 d0 c1 d1
+        punpckhdq   xmm5,           xmm3            ; c2 d2 c3 d3
+        paddd       xmm2,           xmm5
+
+        movdqa      xmm1,           xmm0
+        punpcklqdq  xmm0,           xmm2
+        punpckhqdq  xmm1,           xmm2
+        paddd       xmm0,           xmm1            ; a b c d
+
+        paddd       xmm0,           xmm6
+        psrad       xmm0,           VP8_FILTER_SHIFT
+        packssdw    xmm0,           xmm0
+        packuswb    xmm0,           xmm0            ; clamp to 0..255
+        movd        [rdi],          xmm0
+
+        lea         rdx,            [rdx+16]
+        lea         rcx,            [rcx+64]
+        lea         rdi,            [rdi+4]
+        cmp         rdi,            rax
+        jb          .resize_h_loop
+
+    ; begin epilog
+    pop         rbx
+    pop         rdi
+    pop         rsi
+    RESTORE_GOT
+    RESTORE_XMM
+    UNSHADOW_ARGS
+    pop         rbp
+    ret
+
+
+SECTION_RODATA
+align 16
+rd:
+    times 4 dd 0x40
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "vpx_config.h"
+#include "vpx_rtcd.h"
+#include "vp8/common/resize.h"
+
+extern void vp8_resize_v_sse2_impl(const unsigned char *const *rows,
+                                   unsigned char *dst, int width,
+                                   const short *filter);
+extern void vp8_resize_h_sse2_impl(const unsigned char *src,
+                                   unsigned char *dst, int width,
+                                   const int *offset, const short *filter);
+
+/* The kernels do 8 (vertical) or 4 (horizontal) pixels at a time and read
+ * nothing past the last of them; the few pixels left over go through the
+ * C versions.
+ */
+void vp8_resize_v_sse2(const unsigned char *const *rows, unsigned char *dst,
+                       int width, const short *filter)
+{
+    const int done = width & ~7;
+
+    if (done)
+        vp8_resize_v_sse2_impl(rows, dst, done, filter);
+
+    if (done < width)
+    {
+        const unsigned char *tail[RESIZE_TAPS];
+        int k;
+
+        for (k = 0; k < RESIZE_TAPS; k++)
+            tail[k] = rows[k] + done;
+
+        vp8_resize_v_c(tail, dst + done, width - done, filter);
+    }
+}
+
+void vp8_resize_h_sse2(const unsigned char *src, unsigned char *dst,
+                       int width, const int *offset, const short *filter)
+{
+    const int done = width & ~3;
+
+    if (done)
+        vp8_resize_h_sse2_impl(src, dst, done, offset, filter);
+
+    if (done < width)
+        vp8_resize_h_c(src, dst + done, width - done, offset + done,
+                       filter + done * RESIZE_TAPS);
+}
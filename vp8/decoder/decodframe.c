@@ -684,6 +684,8 @@ static void init_frame(VP8D_COMP *pbi)
     if(pc->full_pixel)
         xd->fullpixel_mask = 0xfffffff8;
 
+    xd->emulate_edges = pc->unbordered_refs;
+
 }
 
 
@@ -770,7 +772,8 @@ int vp8_decode_frame(VP8D_COMP *pbi)
 
             if (Width != pc->Width  ||  Height != pc->Height)
             {
-                int prev_mb_rows = pc->mb_rows;
+                const int new_width = pc->Width;
+                const int new_height = pc->Height;
 
                 if (pc->Width <= 0)
                 {
@@ -786,9 +789,23 @@ int vp8_decode_frame(VP8D_COMP *pbi)
                                        "Invalid frame height");
                 }
 
-                if (vp8_alloc_frame_buffers(pc, pc->Width, pc->Height))
+                /* The size is only kept once everything sized by it is
+                 * there: after a failure below, the next key frame
+                 * allocates again instead of using buffers that went
+                 * with the arena.
+                 */
+                pc->Width = 0;
+                pc->Height = 0;
+
+#if CONFIG_MULTITHREAD
+                if (pbi->b_multithreaded_rd)
+                    vp8mt_de_alloc_temp_buffers(pbi);
+#endif
+
+                if (vp8_alloc_frame_buffers(pc, new_width, new_height))
                     vpx_internal_error(&pc->error, VPX_CODEC_MEM_ERROR,
                                        "Failed to allocate frame buffers");
+                vp8_attach_frame_buffers(pbi);
 
 #if CONFIG_ERROR_CONCEALMENT
                 pbi->overlaps = NULL;
@@ -803,8 +820,11 @@ int vp8_decode_frame(VP8D_COMP *pbi)
 
 #if CONFIG_MULTITHREAD
                 if (pbi->b_multithreaded_rd)
-                    vp8mt_alloc_temp_buffers(pbi, pc->Width, prev_mb_rows);
+                    vp8mt_alloc_temp_buffers(pbi, new_width);
 #endif
+
+                pc->Width = new_width;
+                pc->Height = new_height;
             }
         }
     }
@@ -1082,7 +1102,15 @@ int vp8_decode_frame(VP8D_COMP *pbi)
     {
         /* Motion vectors are missing in this frame. We will try to estimate
          * them and then continue decoding the frame as usual */
-        vp8_estimate_missing_mvs(pbi);
+#if CONFIG_MULTITHREAD
+        /* The multithreaded decoder estimates the vectors row by row, just
+         * ahead of the wavefront. */
+        if (pbi->b_multithreaded_rd &&
+            pc->multi_token_partition != ONE_PARTITION)
+            vp8_calculate_missing_mv_overlaps(pbi);
+        else
+#endif
+            vp8_estimate_missing_mvs(pbi);
     }
 #endif
 
@@ -1100,8 +1128,8 @@ int vp8_decode_frame(VP8D_COMP *pbi)
     {
         int i;
         pbi->frame_corrupt_residual = 0;
+        /* The rows' borders are extended as they are finished. */
         vp8mt_decode_mb_rows(pbi, xd);
-        vp8_yv12_extend_frame_borders_ptr(&pc->yv12_fb[pc->new_fb_idx]);    /*cm->frame_to_show);*/
         for (i = 0; i < pbi->decoding_thread_count; ++i)
             corrupt_tokens |= pbi->mb_row_di[i].mbd.corrupted;
     }
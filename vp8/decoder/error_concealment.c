@@ -343,16 +343,14 @@ static void calc_prev_mb_overlaps(MB_OVERLAP *overlaps, MODE_INFO *prev_mi,
     }
 }
 
-/* Estimate all missing motion vectors. This function does the same as the one
- * above, but has different input arguments. */
-static void estimate_missing_mvs(MB_OVERLAP *overlaps,
-                                 MODE_INFO *mi, MODE_INFO *prev_mi,
-                                 int mb_rows, int mb_cols,
-                                 unsigned int first_corrupt)
+/* Calculate the overlaps of all blocks of the previous frame which refer to
+ * the last frame, i.e. where those blocks end up in the current frame.
+ */
+static void calc_overlaps(MB_OVERLAP *overlaps, MODE_INFO *prev_mi,
+                          int mb_rows, int mb_cols)
 {
     int mb_row, mb_col;
     vpx_memset(overlaps, 0, sizeof(MB_OVERLAP) * mb_rows * mb_cols);
-    /* First calculate the overlaps for all blocks */
     for (mb_row = 0; mb_row < mb_rows; ++mb_row)
     {
         for (mb_col = 0; mb_col < mb_cols; ++mb_col)
@@ -370,38 +368,65 @@ static void estimate_missing_mvs(MB_OVERLAP *overlaps,
         }
         ++prev_mi;
     }
+}
+
+/* Calculate new MVs for the macroblocks of one row, starting at mb_col,
+ * using the overlaps. mi points at the first macroblock of the row.
+ */
+static void estimate_missing_mvs_row(const MB_OVERLAP *overlaps,
+                                     MODE_INFO *mi,
+                                     int mb_row, int mb_col,
+                                     int mb_rows, int mb_cols)
+{
+    int mb_to_top_edge = -((mb_row * 16)) << 3;
+    int mb_to_bottom_edge = ((mb_rows - 1 - mb_row) * 16) << 3;
+
+    mi += mb_col;
+    for (; mb_col < mb_cols; ++mb_col)
+    {
+        int mb_to_left_edge = -((mb_col * 16) << 3);
+        int mb_to_right_edge = ((mb_cols - 1 - mb_col) * 16) << 3;
+        const B_OVERLAP *block_overlaps =
+                overlaps[mb_row*mb_cols + mb_col].overlaps;
+        mi->mbmi.ref_frame = LAST_FRAME;
+        mi->mbmi.mode = SPLITMV;
+        mi->mbmi.uv_mode = DC_PRED;
+        mi->mbmi.partitioning = 3;
+        mi->mbmi.segment_id = 0;
+        estimate_mb_mvs(block_overlaps,
+                        mi,
+                        mb_to_left_edge,
+                        mb_to_right_edge,
+                        mb_to_top_edge,
+                        mb_to_bottom_edge);
+        ++mi;
+    }
+}
+
+/* Estimate all missing motion vectors. This function does the same as the one
+ * above, but has different input arguments. */
+static void estimate_missing_mvs(MB_OVERLAP *overlaps,
+                                 MODE_INFO *mi, MODE_INFO *prev_mi,
+                                 int mb_rows, int mb_cols,
+                                 unsigned int first_corrupt)
+{
+    int mb_row, mb_col;
+
+    /* First calculate the overlaps for all blocks */
+    calc_overlaps(overlaps, prev_mi, mb_rows, mb_cols);
 
     mb_row = first_corrupt / mb_cols;
     mb_col = first_corrupt - mb_row * mb_cols;
-    mi += mb_row*(mb_cols + 1) + mb_col;
+    mi += mb_row*(mb_cols + 1);
     /* Go through all macroblocks in the current image with missing MVs
      * and calculate new MVs using the overlaps.
      */
     for (; mb_row < mb_rows; ++mb_row)
     {
-        int mb_to_top_edge = -((mb_row * 16)) << 3;
-        int mb_to_bottom_edge = ((mb_rows - 1 - mb_row) * 16) << 3;
-        for (; mb_col < mb_cols; ++mb_col)
-        {
-            int mb_to_left_edge = -((mb_col * 16) << 3);
-            int mb_to_right_edge = ((mb_cols - 1 - mb_col) * 16) << 3;
-            const B_OVERLAP *block_overlaps =
-                    overlaps[mb_row*mb_cols + mb_col].overlaps;
-            mi->mbmi.ref_frame = LAST_FRAME;
-            mi->mbmi.mode = SPLITMV;
-            mi->mbmi.uv_mode = DC_PRED;
-            mi->mbmi.partitioning = 3;
-            mi->mbmi.segment_id = 0;
-            estimate_mb_mvs(block_overlaps,
-                            mi,
-                            mb_to_left_edge,
-                            mb_to_right_edge,
-                            mb_to_top_edge,
-                            mb_to_bottom_edge);
-            ++mi;
-        }
+        estimate_missing_mvs_row(overlaps, mi, mb_row, mb_col,
+                                 mb_rows, mb_cols);
         mb_col = 0;
-        ++mi;
+        mi += mb_cols + 1;
     }
 }
 
@@ -414,6 +439,30 @@ void vp8_estimate_missing_mvs(VP8D_COMP *pbi)
                          pbi->mvs_corrupt_from_mb);
 }
 
+void vp8_calculate_missing_mv_overlaps(VP8D_COMP *pbi)
+{
+    VP8_COMMON * const pc = &pbi->common;
+    calc_overlaps(pbi->overlaps, pc->prev_mi, pc->mb_rows, pc->mb_cols);
+}
+
+void vp8_estimate_missing_mvs_row(VP8D_COMP *pbi, int mb_row)
+{
+    VP8_COMMON * const pc = &pbi->common;
+    const unsigned int first_corrupt = pbi->mvs_corrupt_from_mb;
+    int mb_col = 0;
+
+    if ((unsigned int)(mb_row + 1) * pc->mb_cols <= first_corrupt)
+        return;
+
+    if ((unsigned int)mb_row * pc->mb_cols < first_corrupt)
+        mb_col = first_corrupt - mb_row * pc->mb_cols;
+
+    estimate_missing_mvs_row(pbi->overlaps,
+                             pc->mi + mb_row * pc->mode_info_stride,
+                             mb_row, mb_col,
+                             pc->mb_rows, pc->mb_cols);
+}
+
 static void assign_neighbor(EC_BLOCK *neighbor, MODE_INFO *mi, int block_idx)
 {
     assert(mi->mbmi.ref_frame < MAX_REF_FRAMES);
@@ -24,6 +24,13 @@ void vp8_de_alloc_overlap_lists(VP8D_COMP *pbi);
 /* Estimate all missing motion vectors. */
 void vp8_estimate_missing_mvs(VP8D_COMP *pbi);
 
+/* The two halves of vp8_estimate_missing_mvs(), for the multithreaded
+ * decoder: the overlaps are calculated once for the whole frame, after which
+ * the missing motion vectors can be estimated independently for each row.
+ */
+void vp8_calculate_missing_mv_overlaps(VP8D_COMP *pbi);
+void vp8_estimate_missing_mvs_row(VP8D_COMP *pbi, int mb_row);
+
 /* Functions for spatial MV interpolation */
 
 /* Interpolates all motion vectors for a macroblock mb at position
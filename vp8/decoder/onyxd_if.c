@@ -46,7 +46,9 @@ static cl_command_queue cl_commands = NULL;
 
 extern void vp8_init_loop_filter(VP8_COMMON *cm);
 extern void vp8cx_init_de_quantizer(VP8D_COMP *pbi);
-static int get_free_fb (VP8_COMMON *cm);
+static int get_free_fb (VP8D_COMP *pbi);
+static void release_frame_buffers(VP8D_COMP *pbi,
+                                  const YV12_BUFFER_CONFIG *keep, int all);
 static void ref_cnt_fb (int *buf, int *idx, int new_idx);
 
 #define PROFILE_OUTPUT 0
@@ -123,6 +125,12 @@ struct VP8D_COMP * vp8dx_create_decompressor(VP8D_CONFIG *oxcf)
     pbi->input_fragments = oxcf->input_fragments;
     pbi->num_fragments = 0;
 
+#if !CONFIG_OPENCL
+    /* The OpenCL predictors read the reference borders directly. */
+    pbi->common.unbordered_refs = oxcf->unbordered_refs;
+    pbi->common.fb_mem_id = oxcf->frame_mem_id;
+#endif
+
     /* Independent partitions is activated when a frame updates the
      * token probability table to have equal probabilities over the
      * PREV_COEF context.
@@ -146,12 +154,13 @@ void vp8dx_remove_decompressor(VP8D_COMP *pbi)
     
 #if CONFIG_MULTITHREAD
     if (pbi->b_multithreaded_rd)
-        vp8mt_de_alloc_temp_buffers(pbi, pbi->common.mb_rows);
+        vp8mt_de_alloc_temp_buffers(pbi);
     vp8_decoder_remove_threads(pbi);
 #endif
 #if CONFIG_ERROR_CONCEALMENT
     vp8_de_alloc_overlap_lists(pbi);
 #endif
+    release_frame_buffers(pbi, NULL, 1);
     vp8_remove_common(&pbi->common);
     vpx_free(pbi->mbc);
     vpx_free(pbi);
@@ -216,7 +225,10 @@ vpx_codec_err_t vp8dx_set_reference(VP8D_COMP *pbi, VP8_REFFRAME ref_frame_flag,
     }
     else{
         /* Find an empty frame buffer. */
-        free_fb = get_free_fb(cm);
+        free_fb = get_free_fb(pbi);
+        if (free_fb < 0)
+            return pbi->common.error.error_code;
+
         /* Decrease fb_idx_ref_cnt since it will be increased again in
          * ref_cnt_fb() below. */
         cm->fb_idx_ref_cnt[free_fb]--;
@@ -235,14 +247,114 @@ extern void vp8_push_neon(int64_t *store);
 extern void vp8_pop_neon(int64_t *store);
 #endif
 
-static int get_free_fb (VP8_COMMON *cm)
+/* Backs yv12_fb[idx] with memory from the application allocator, if one is
+ * in use and the frame size is known.
+ */
+static int attach_fb(VP8D_COMP *pbi, int idx)
+{
+    VP8_COMMON *cm = &pbi->common;
+    YV12_BUFFER_CONFIG *ybf = &cm->yv12_fb[idx];
+    vp8_frame_buffer_t *fb = &pbi->ext_fb[idx];
+
+    if (!cm->fb_external || fb->data || !ybf->y_width)
+        return 0;
+
+    if (pbi->fb_functions.get_fb(pbi->fb_functions.cb_priv,
+                                 ybf->frame_size, fb))
+    {
+        vpx_memset(fb, 0, sizeof(*fb));
+        return -1;
+    }
+
+    if (!fb->data || fb->size < (size_t)ybf->frame_size)
+    {
+        pbi->fb_functions.release_fb(pbi->fb_functions.cb_priv, fb);
+        vpx_memset(fb, 0, sizeof(*fb));
+        return -1;
+    }
+
+    vp8_yv12_external_frame_buffer(ybf, ybf->y_width, ybf->y_height,
+                                   ybf->border, fb->data);
+    return 0;
+}
+
+/* Hands application memory back once the decoder is done with it. Unless
+ * all are released, a buffer is kept while it is referenced or is the
+ * frame the application may still be reading (keep).
+ */
+static void release_frame_buffers(VP8D_COMP *pbi,
+                                  const YV12_BUFFER_CONFIG *keep, int all)
+{
+    VP8_COMMON *cm = &pbi->common;
+    int i;
+
+    for (i = 0; i < NUM_YV12_BUFFERS; i++)
+    {
+        YV12_BUFFER_CONFIG *ybf = &cm->yv12_fb[i];
+
+        if (!pbi->ext_fb[i].data)
+            continue;
+
+        if (!all && (cm->fb_idx_ref_cnt[i] > 0 || ybf == keep))
+            continue;
+
+        pbi->fb_functions.release_fb(pbi->fb_functions.cb_priv,
+                                     &pbi->ext_fb[i]);
+        vpx_memset(&pbi->ext_fb[i], 0, sizeof(pbi->ext_fb[i]));
+
+        /* Keep the layout, drop the pointers into memory we no longer own. */
+        if (ybf->buffer_external)
+            vp8_yv12_external_frame_buffer(ybf, ybf->y_width, ybf->y_height,
+                                           ybf->border, NULL);
+    }
+}
+
+/* vp8_alloc_frame_buffers() laid the frame buffers out anew: return the
+ * memory sized for the previous layout and back the referenced ones again.
+ */
+void vp8_attach_frame_buffers(VP8D_COMP *pbi)
 {
+    VP8_COMMON *cm = &pbi->common;
+    int i;
+
+    if (!cm->fb_external)
+        return;
+
+    for (i = 0; i < NUM_YV12_BUFFERS; i++)
+    {
+        if (pbi->ext_fb[i].data)
+        {
+            pbi->fb_functions.release_fb(pbi->fb_functions.cb_priv,
+                                         &pbi->ext_fb[i]);
+            vpx_memset(&pbi->ext_fb[i], 0, sizeof(pbi->ext_fb[i]));
+        }
+    }
+
+    for (i = 0; i < NUM_YV12_BUFFERS; i++)
+    {
+        if (cm->fb_idx_ref_cnt[i] > 0 && attach_fb(pbi, i))
+            vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                               "Failed to get frame buffer");
+    }
+}
+
+static int get_free_fb (VP8D_COMP *pbi)
+{
+    VP8_COMMON *cm = &pbi->common;
     int i;
     for (i = 0; i < NUM_YV12_BUFFERS; i++)
         if (cm->fb_idx_ref_cnt[i] == 0)
             break;
 
     assert(i < NUM_YV12_BUFFERS);
+
+    if (attach_fb(pbi, i))
+    {
+        vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                           "Failed to get frame buffer");
+        return -1;
+    }
+
     cm->fb_idx_ref_cnt[i] = 1;
     return i;
 }
@@ -315,6 +427,39 @@ static int swap_frame_buffers (VP8_COMMON *cm)
     return err;
 }
 
+/* Adds the memory the decoder instance holds to bytes, see vp8_mem_usage(). */
+static void mem_usage(VP8D_COMP *pbi, size_t bytes[MEM_KINDS])
+{
+    VP8_COMMON *const cm = &pbi->common;
+
+    vp8_mem_usage(cm, bytes);
+    bytes[MEM_STATE] += sizeof(*pbi);
+
+    if (pbi->mbc)
+        bytes[MEM_STATE] += (1 << cm->multi_token_partition) * sizeof(vp8_reader);
+
+#if CONFIG_ERROR_CONCEALMENT
+
+    if (pbi->overlaps)
+        bytes[MEM_STATE] += cm->mb_rows * cm->mb_cols * sizeof(MB_OVERLAP);
+
+#endif
+#if CONFIG_MULTITHREAD
+
+    if (pbi->b_multithreaded_rd)
+    {
+        bytes[MEM_THREADS] += pbi->allocated_decoding_thread_count
+                              * (sizeof(pthread_t) + sizeof(sem_t)
+                                 + sizeof(MB_ROW_DEC) + sizeof(DECODETHREAD_DATA));
+
+        /* The row buffers come out of the arena. */
+        bytes[MEM_THREADS] += pbi->mt_buffer_bytes;
+        bytes[MEM_STATE] -= pbi->mt_buffer_bytes;
+    }
+
+#endif
+}
+
 int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsigned char *source, int64_t time_stamp)
 {
 #if HAVE_NEON
@@ -322,6 +467,7 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
 #endif
     VP8_COMMON *cm = &pbi->common;
     int retcode = 0;
+    int free_fb;
 
     /*if(pbi->ready_for_new_data == 0)
         return -1;*/
@@ -333,6 +479,19 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
 
     pbi->common.error.error_code = VPX_CODEC_OK;
 
+#if CONFIG_POSTPROC
+    /* Rows postprocessed while decoding the previous frame are stale. */
+    cm->postproc_state.rows_start = 0;
+    cm->postproc_state.rows_end = 0;
+
+    /* The postprocessed previous frame can only stand in for static MBs if
+     * it is the last frame this one predicts from. cm still describes the
+     * previous frame here.
+     */
+    if (!cm->show_frame || !cm->refresh_last_frame)
+        cm->postproc_state.prev_deblocked = 0;
+#endif
+
     if (pbi->num_fragments == 0)
     {
         /* New frame, reset fragment pointers and sizes */
@@ -372,6 +531,11 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
         pbi->fragment_sizes[0] = 0;
     }
 
+    /* The previously shown frame is no longer needed by the application,
+     * unless it took its own reference on the buffer.
+     */
+    release_frame_buffers(pbi, NULL, 0);
+
     if (!pbi->ec_active &&
         pbi->num_fragments <= 1 && pbi->fragment_sizes[0] == 0)
     {
@@ -385,8 +549,16 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
              * corrupt, otherwise we will make multiple buffers corrupt.
              */
             const int prev_idx = cm->lst_fb_idx;
+            const int free_fb = get_free_fb(pbi);
+
+            if (free_fb < 0)
+            {
+                pbi->num_fragments = 0;
+                return -1;
+            }
+
             cm->fb_idx_ref_cnt[prev_idx]--;
-            cm->lst_fb_idx = get_free_fb(cm);
+            cm->lst_fb_idx = free_fb;
             vp8_yv12_copy_frame_ptr(&cm->yv12_fb[prev_idx],
                                     &cm->yv12_fb[cm->lst_fb_idx]);
         }
@@ -406,6 +578,14 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
         return 0;
     }
 
+    free_fb = get_free_fb (pbi);
+    if (free_fb < 0)
+    {
+        pbi->num_fragments = 0;
+        return -1;
+    }
+    cm->new_fb_idx = free_fb;
+
 #if HAVE_NEON
 #if CONFIG_RUNTIME_CPU_DETECT
     if (cm->cpu_caps & HAS_NEON)
@@ -415,8 +595,6 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
     }
 #endif
 
-    cm->new_fb_idx = get_free_fb (cm);
-
     if (setjmp(pbi->common.error.jmp))
     {
 #if HAVE_NEON
@@ -511,6 +689,7 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
 
     pbi->common.error.setjmp = 1;
 
+    cm->show_frame_mi = cm->mi;
     retcode = vp8_decode_frame(pbi);
 
 #if PROFILE_OUTPUT
@@ -582,7 +761,7 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
 #endif
            
             /* Apply the loop filter if appropriate. */
-            vp8_loop_filter_frame(cm, &pbi->mb);
+            vp8_loop_filter_frame(cm, &pbi->mb, cm->frame_type);
 
 #if PROFILE_OUTPUT
             vpx_usec_timer_mark(&lpftimer);
@@ -604,7 +783,8 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
             printf("No Loop Filter\n");
         }
 #endif
-        vp8_yv12_extend_frame_borders_ptr(cm->frame_to_show);
+        if (!cm->unbordered_refs)
+            vp8_yv12_extend_frame_borders_ptr(cm->frame_to_show);
     }
 
 #if CONFIG_OPENCL && ENABLE_CL_SUBPIXEL
@@ -646,6 +826,8 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
     if (cm->show_frame)
         cm->current_video_frame++;
 
+    release_frame_buffers(pbi, cm->frame_to_show, 0);
+
     pbi->ready_for_new_data = 0;
     pbi->last_time_stamp = time_stamp;
     pbi->num_fragments = 0;
@@ -692,6 +874,13 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
         vp8_pop_neon(dx_store_reg);
     }
 #endif
+    {
+        size_t bytes[MEM_KINDS] = {0};
+
+        mem_usage(pbi, bytes);
+        vp8_mem_update_peak(cm, bytes);
+    }
+
     pbi->common.error.setjmp = 0;
 
 
@@ -704,6 +893,51 @@ int vp8dx_receive_compressed_data(VP8D_COMP *pbi, unsigned long size, const unsi
 
     return retcode;
 }
+void vp8dx_get_mem_stats(VP8D_COMP *pbi, vp8_mem_stats_t *stats)
+{
+    size_t bytes[MEM_KINDS] = {0};
+
+    mem_usage(pbi, bytes);
+    vp8_fill_mem_stats(&pbi->common, bytes, stats);
+}
+
+void vp8dx_set_postproc_flags(VP8D_COMP *pbi, vp8_ppflags_t *flags)
+{
+    pbi->postproc_flags = *flags;
+}
+
+int vp8dx_set_frame_buffer_functions(VP8D_COMP *pbi,
+                                     const vp8_frame_buffer_functions_t *functions)
+{
+    /* Buffers can only be switched over before the first frame. */
+    if (pbi->common.Width || (functions->get_fb && !functions->release_fb))
+        return -1;
+
+    pbi->fb_functions = *functions;
+    pbi->common.fb_external = functions->get_fb != NULL;
+    return 0;
+}
+
+int vp8dx_get_frame_buffer(VP8D_COMP *pbi, const unsigned char *y_buffer,
+                           vp8_frame_buffer_t *fb)
+{
+    int i;
+
+    for (i = 0; i < NUM_YV12_BUFFERS; i++)
+    {
+        if (pbi->ext_fb[i].data &&
+            pbi->common.yv12_fb[i].y_buffer == y_buffer)
+        {
+            *fb = pbi->ext_fb[i];
+            return 0;
+        }
+    }
+
+    /* Not drawn from the application, e.g. postprocessed. */
+    vpx_memset(fb, 0, sizeof(*fb));
+    return -1;
+}
+
 int vp8dx_get_raw_frame(VP8D_COMP *pbi, YV12_BUFFER_CONFIG *sd, int64_t *time_stamp, int64_t *time_end_stamp, vp8_ppflags_t *flags)
 {
     int ret = -1;
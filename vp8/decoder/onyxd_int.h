@@ -16,6 +16,7 @@
 #include "treereader.h"
 #include "vp8/common/onyxc_int.h"
 #include "vp8/common/threading.h"
+#include "vp8/common/mtsync.h"
 
 #if CONFIG_ERROR_CONCEALMENT
 #include "ec_types.h"
@@ -34,6 +35,9 @@ typedef struct
     int mb_row;
     int current_mb_col;
     short *coef_ptr;
+#if CONFIG_MULTITHREAD
+    MT_SYNC_COUNTERS sync_counters;
+#endif
 } MB_ROW_DEC;
 
 typedef struct
@@ -68,8 +72,13 @@ typedef struct VP8D_COMP
     int allocated_decoding_thread_count;
 
     int mt_baseline_filter_level[MAX_MB_SEGMENTS];
-    int sync_range;
-    int *mt_current_mb_col;                  /* Each row remembers its already decoded column. */
+    MT_SYNC_STATE mt_sync;                   /* Adaptive wavefront step and last frame's stalls. */
+    MT_SYNC_COUNTERS mt_sync_main;           /* Main thread's share of the stall counters. */
+    MT_ROW_PROGRESS *mt_current_mb_col;      /* Each row remembers its already decoded column. */
+    int mt_postproc_rows;                    /* Rows are postprocessed in the wavefront. */
+#if CONFIG_ERROR_CONCEALMENT
+    int *mt_corrupt_from_col;                /* First column of each row with thrown residual. */
+#endif
 
     unsigned char **mt_yabove_row;           /* mb_rows x width */
     unsigned char **mt_uabove_row;
@@ -77,6 +86,7 @@ typedef struct VP8D_COMP
     unsigned char **mt_yleft_col;            /* mb_rows x 16 */
     unsigned char **mt_uleft_col;            /* mb_rows x 8 */
     unsigned char **mt_vleft_col;            /* mb_rows x 8 */
+    size_t mt_buffer_bytes;                  /* What the buffers above take of common.arena. */
 
     MB_ROW_DEC           *mb_row_di;
     DECODETHREAD_DATA    *de_thread_data;
@@ -91,6 +101,15 @@ typedef struct VP8D_COMP
     int64_t last_time_stamp;
     int   ready_for_new_data;
 
+    /* Postprocessing the next vp8dx_get_raw_frame() is expected to apply. */
+    vp8_ppflags_t postproc_flags;
+
+    /* Application frame buffer allocator and the buffers currently backing
+     * common.yv12_fb[], data is NULL for a slot without memory.
+     */
+    vp8_frame_buffer_functions_t fb_functions;
+    vp8_frame_buffer_t ext_fb[NUM_YV12_BUFFERS];
+
     DATARATE dr[16];
 
     vp8_prob prob_intra;
@@ -113,6 +132,7 @@ typedef struct VP8D_COMP
 } VP8D_COMP;
 
 int vp8_decode_frame(VP8D_COMP *cpi);
+void vp8_attach_frame_buffers(VP8D_COMP *pbi);
 
 #if CONFIG_DEBUG
 #define CHECK_MEM_ERROR(lval,expr) do {\
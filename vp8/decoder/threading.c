@@ -20,10 +20,14 @@
 
 #include "vp8/common/loopfilter.h"
 #include "vp8/common/extend.h"
+#include "vpx_scale/yv12extend.h"
 #include "vpx_ports/vpx_timer.h"
 #include "detokenize.h"
 #include "vp8/common/reconinter.h"
 #include "reconintra_mt.h"
+#if CONFIG_POSTPROC
+#include "vp8/common/postproc.h"
+#endif
 #if CONFIG_ERROR_CONCEALMENT
 #include "error_concealment.h"
 #endif
@@ -79,17 +83,76 @@ static void setup_decoding_thread_data(VP8D_COMP *pbi, MACROBLOCKD *xd, MB_ROW_D
         if(pc->full_pixel)
             mbd->fullpixel_mask = 0xfffffff8;
 
+        mbd->emulate_edges = pc->unbordered_refs;
+
     }
 
-    for (i=0; i< pc->mb_rows; i++)
-        pbi->mt_current_mb_col[i]=-1;
+    vp8_mt_sync_reset_rows(pbi->mt_current_mb_col, pc->mb_rows);
+}
+
+
+#if CONFIG_ERROR_CONCEALMENT
+/* Corrupt residual spreads through the entropy contexts, i.e. along the row
+ * and down into the row below. Following that dependency per row, instead of
+ * the frame wide frame_corrupt_residual flag of the single threaded decoder,
+ * keeps the result independent of how the rows are scheduled on the threads.
+ */
+static int mt_residual_corrupt(VP8D_COMP *pbi, int mb_row, int mb_col)
+{
+    /* When we have independent partitions we can apply residual even
+     * though other partitions within the frame are corrupt.
+     */
+    const volatile int *corrupt_from_col = pbi->mt_corrupt_from_col;
+
+    if (pbi->independent_partitions)
+        return 0;
+
+    return corrupt_from_col[mb_row] <= mb_col ||
+           (mb_row > 0 && corrupt_from_col[mb_row - 1] <= mb_col);
 }
+#endif
 
 
+/* Called by the thread that decoded mb_row once the row is loop filtered.
+ * The row above is final then, as is mb_row itself if it is the last one:
+ * extend their borders and postprocess them while they're in cache. Nothing
+ * reads those rows of the frame any more, so this runs alongside the
+ * decoding of the rows below.
+ */
+static void mt_finish_rows(VP8D_COMP *pbi, int mb_row)
+{
+    VP8_COMMON *pc = &pbi->common;
+    int first = mb_row > 0 ? mb_row - 1 : 0;
+    int end = mb_row == pc->mb_rows - 1 ? mb_row + 1 : mb_row;
+
+    if (!pc->unbordered_refs && first < end)
+        vp8_yv12_extend_frame_rows(&pc->yv12_fb[pc->new_fb_idx],
+                                   first * 16, (end - first) * 16);
+
+#if CONFIG_POSTPROC
+    if (pbi->mt_postproc_rows)
+    {
+        /* Without borders the first and last rows are left to
+         * vp8_post_proc_frame(), which extends the frame first.
+         */
+        if (pc->unbordered_refs)
+        {
+            first = first < 1 ? 1 : first;
+            end = end > pc->mb_rows - 1 ? pc->mb_rows - 1 : end;
+        }
+
+        if (first < end)
+            vp8_post_proc_rows(pc, first, end);
+    }
+#endif
+}
+
 static void decode_macroblock(VP8D_COMP *pbi, MACROBLOCKD *xd, int mb_row, int mb_col)
 {
     int eobtotal = 0;
+#if CONFIG_ERROR_CONCEALMENT
     int throw_residual = 0;
+#endif
     int i;
 
     if (xd->mode_info_context->mbmi.mb_skip_coeff)
@@ -145,14 +208,10 @@ static void decode_macroblock(VP8D_COMP *pbi, MACROBLOCKD *xd, int mb_row, int m
         vp8_build_inter_predictors_mb(xd);
     }
 
-    /* When we have independent partitions we can apply residual even
-     * though other partitions within the frame are corrupt.
-     */
-    throw_residual = (!pbi->independent_partitions &&
-                      pbi->frame_corrupt_residual);
-    throw_residual = (throw_residual || vp8dx_bool_error(xd->current_bc));
-
 #if CONFIG_ERROR_CONCEALMENT
+    throw_residual = (mt_residual_corrupt(pbi, mb_row, mb_col) ||
+                      vp8dx_bool_error(xd->current_bc));
+
     if (pbi->ec_active &&
         (mb_row * pbi->common.mb_cols + mb_col >= pbi->mvs_corrupt_from_mb ||
          throw_residual))
@@ -160,7 +219,10 @@ static void decode_macroblock(VP8D_COMP *pbi, MACROBLOCKD *xd, int mb_row, int m
         /* MB with corrupt residuals or corrupt mode/motion vectors.
          * Better to use the predictor as reconstruction.
          */
-        pbi->frame_corrupt_residual = 1;
+        volatile int *corrupt_from_col = pbi->mt_corrupt_from_col;
+
+        if (mb_col < corrupt_from_col[mb_row])
+            corrupt_from_col[mb_row] = mb_col;
         vpx_memset(xd->qcoeff, 0, sizeof(xd->qcoeff));
         vp8_conceal_corrupt_mb(xd);
         return;
@@ -186,13 +248,13 @@ static void decode_macroblock(VP8D_COMP *pbi, MACROBLOCKD *xd, int mb_row, int m
                 if (xd->eobs[i] > 1)
                 {
                     vp8_dequant_idct_add
-                        (b->qcoeff, DQC,
+                        (qcoeff, DQC,
                         *(b->base_dst) + b->dst, b->dst_stride);
                 }
                 else
                 {
                     vp8_dc_only_idct_add
-                        (b->qcoeff[0] * DQC[0],
+                        (qcoeff[0] * DQC[0],
                         *(b->base_dst) + b->dst, b->dst_stride,
                         *(b->base_dst) + b->dst, b->dst_stride);
                     ((int *)qcoeff)[0] = 0;
@@ -273,8 +335,9 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data)
 
                 int mb_row;
                 int num_part = 1 << pbi->common.multi_token_partition;
-                volatile int *last_row_current_mb_col;
-                int nsync = pbi->sync_range;
+                const MT_ROW_PROGRESS *last_row_current_mb_col;
+                MT_SYNC_COUNTERS *sync_counters = &mbrd->sync_counters;
+                int nsync = pbi->mt_sync.sync_range;
 
                 for (mb_row = ithread+1; mb_row < pc->mb_rows; mb_row += (pbi->decoding_thread_count + 1))
                 {
@@ -306,16 +369,18 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data)
                     xd->mb_to_top_edge = -((mb_row * 16)) << 3;
                     xd->mb_to_bottom_edge = ((pc->mb_rows - 1 - mb_row) * 16) << 3;
 
+#if CONFIG_ERROR_CONCEALMENT
+                    /* Concealment of this row looks at the row below, so
+                     * its missing MVs are estimated one row ahead. */
+                    if (pbi->ec_active && mb_row + 1 < pc->mb_rows)
+                        vp8_estimate_missing_mvs_row(pbi, mb_row + 1);
+#endif
+
                     for (mb_col = 0; mb_col < pc->mb_cols; mb_col++)
                     {
                         if ((mb_col & (nsync-1)) == 0)
-                        {
-                            while (mb_col > (*last_row_current_mb_col - nsync) && *last_row_current_mb_col != pc->mb_cols - 1)
-                            {
-                                x86_pause_hint();
-                                thread_sleep(0);
-                            }
-                        }
+                            vp8_mt_sync_wait(last_row_current_mb_col, mb_col, nsync,
+                                             pc->mb_cols - 1, sync_counters);
 
                         /* Distance of MB to the various image edges.
                          * These are specified to 8th pel as they are always
@@ -327,8 +392,7 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data)
 #if CONFIG_ERROR_CONCEALMENT
                         {
                             int corrupt_residual =
-                                        (!pbi->independent_partitions &&
-                                        pbi->frame_corrupt_residual) ||
+                                        mt_residual_corrupt(pbi, mb_row, mb_col) ||
                                         vp8dx_bool_error(xd->current_bc);
                             if (pbi->ec_active &&
                                 (xd->mode_info_context->mbmi.ref_frame ==
@@ -382,6 +446,9 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data)
 
                         decode_macroblock(pbi, xd, mb_row, mb_col);
 
+                        if (!xd->mode_info_context->mbmi.mb_skip_coeff)
+                            sync_counters->coded_mbs++;
+
                         /* check if the boolean decoder has suffered an error */
                         xd->corrupted |= vp8dx_bool_error(xd->current_bc);
 
@@ -483,7 +550,7 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data)
                         xd->above_context++;
 
                         /*pbi->mb_row_di[ithread].current_mb_col = mb_col;*/
-                        pbi->mt_current_mb_col[mb_row] = mb_col;
+                        pbi->mt_current_mb_col[mb_row].mb_col = mb_col;
                     }
 
                     /* adjust to the next row of mbs */
@@ -504,6 +571,8 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data)
                     } else
                         vp8_extend_mb_row(&pc->yv12_fb[dst_fb_idx], xd->dst.y_buffer + 16, xd->dst.u_buffer + 8, xd->dst.v_buffer + 8);
 
+                    mt_finish_rows(pbi, mb_row);
+
                     ++xd->mode_info_context;      /* skip prediction column */
 
                     /* since we have multithread */
@@ -511,12 +580,10 @@ static THREAD_FUNCTION thread_decoding_proc(void *p_data)
                 }
             }
         }
-        /*  add this to each frame */
-        if ((mbrd->mb_row == pbi->common.mb_rows-1) || ((mbrd->mb_row == pbi->common.mb_rows-2) && (pbi->common.mb_rows % (pbi->decoding_thread_count+1))==1))
-        {
-            /*SetEvent(pbi->h_event_end_decoding);*/
-            sem_post(&pbi->h_event_end_decoding);
-        }
+        /* Each thread signals once it is done with all of its rows,
+         * including the postprocessing that trails the last one.
+         */
+        sem_post(&pbi->h_event_end_decoding);
     }
 
     return 0 ;
@@ -567,135 +634,87 @@ void vp8_decoder_create_threads(VP8D_COMP *pbi)
 }
 
 
-void vp8mt_de_alloc_temp_buffers(VP8D_COMP *pbi, int mb_rows)
+/* The buffers are allocated from pbi->common.arena and released with it;
+ * this only drops the pointers.
+ */
+void vp8mt_de_alloc_temp_buffers(VP8D_COMP *pbi)
 {
-    int i;
-
-    if (pbi->b_multithreaded_rd)
-    {
-            vpx_free(pbi->mt_current_mb_col);
-            pbi->mt_current_mb_col = NULL ;
-
-        /* Free above_row buffers. */
-        if (pbi->mt_yabove_row)
-        {
-            for (i=0; i< mb_rows; i++)
-            {
-                    vpx_free(pbi->mt_yabove_row[i]);
-                    pbi->mt_yabove_row[i] = NULL ;
-            }
-            vpx_free(pbi->mt_yabove_row);
-            pbi->mt_yabove_row = NULL ;
-        }
-
-        if (pbi->mt_uabove_row)
-        {
-            for (i=0; i< mb_rows; i++)
-            {
-                    vpx_free(pbi->mt_uabove_row[i]);
-                    pbi->mt_uabove_row[i] = NULL ;
-            }
-            vpx_free(pbi->mt_uabove_row);
-            pbi->mt_uabove_row = NULL ;
-        }
-
-        if (pbi->mt_vabove_row)
-        {
-            for (i=0; i< mb_rows; i++)
-            {
-                    vpx_free(pbi->mt_vabove_row[i]);
-                    pbi->mt_vabove_row[i] = NULL ;
-            }
-            vpx_free(pbi->mt_vabove_row);
-            pbi->mt_vabove_row = NULL ;
-        }
-
-        /* Free left_col buffers. */
-        if (pbi->mt_yleft_col)
-        {
-            for (i=0; i< mb_rows; i++)
-            {
-                    vpx_free(pbi->mt_yleft_col[i]);
-                    pbi->mt_yleft_col[i] = NULL ;
-            }
-            vpx_free(pbi->mt_yleft_col);
-            pbi->mt_yleft_col = NULL ;
-        }
-
-        if (pbi->mt_uleft_col)
-        {
-            for (i=0; i< mb_rows; i++)
-            {
-                    vpx_free(pbi->mt_uleft_col[i]);
-                    pbi->mt_uleft_col[i] = NULL ;
-            }
-            vpx_free(pbi->mt_uleft_col);
-            pbi->mt_uleft_col = NULL ;
-        }
-
-        if (pbi->mt_vleft_col)
-        {
-            for (i=0; i< mb_rows; i++)
-            {
-                    vpx_free(pbi->mt_vleft_col[i]);
-                    pbi->mt_vleft_col[i] = NULL ;
-            }
-            vpx_free(pbi->mt_vleft_col);
-            pbi->mt_vleft_col = NULL ;
-        }
-    }
+    pbi->mt_buffer_bytes = 0;
+    pbi->mt_current_mb_col = NULL;
+#if CONFIG_ERROR_CONCEALMENT
+    pbi->mt_corrupt_from_col = NULL;
+#endif
+    pbi->mt_yabove_row = NULL;
+    pbi->mt_uabove_row = NULL;
+    pbi->mt_vabove_row = NULL;
+    pbi->mt_yleft_col = NULL;
+    pbi->mt_uleft_col = NULL;
+    pbi->mt_vleft_col = NULL;
 }
 
 
-void vp8mt_alloc_temp_buffers(VP8D_COMP *pbi, int width, int prev_mb_rows)
+/* Called after vp8_alloc_frame_buffers(), which emptied the arena. */
+void vp8mt_alloc_temp_buffers(VP8D_COMP *pbi, int width)
 {
     VP8_COMMON *const pc = & pbi->common;
+    vpx_arena_t *const arena = &pc->arena;
+    const size_t arena_used = vpx_arena_used(arena);
     int i;
     int uv_width;
 
     if (pbi->b_multithreaded_rd)
     {
-        vp8mt_de_alloc_temp_buffers(pbi, prev_mb_rows);
-
         /* our internal buffers are always multiples of 16 */
         if ((width & 0xf) != 0)
             width += 16 - (width & 0xf);
 
-        if (width < 640) pbi->sync_range = 1;
-        else if (width <= 1280) pbi->sync_range = 8;
-        else if (width <= 2560) pbi->sync_range =16;
-        else pbi->sync_range = 32;
+        /* Starting sync step; adapted per frame from the measured stalls. */
+        if (width < 640) i = 1;
+        else if (width <= 1280) i = 8;
+        else if (width <= 2560) i = 16;
+        else i = 32;
+
+        vp8_mt_sync_init(&pbi->mt_sync, pc->mb_cols, i);
 
         uv_width = width >>1;
 
-        /* Allocate an int for each mb row. */
-        CHECK_MEM_ERROR(pbi->mt_current_mb_col, vpx_malloc(sizeof(int) * pc->mb_rows));
+        /* Allocate a cache line for each mb row's progress. */
+        CHECK_MEM_ERROR(pbi->mt_current_mb_col,
+                        vpx_arena_memalign(arena, MT_SYNC_CACHE_LINE,
+                                           sizeof(MT_ROW_PROGRESS) * pc->mb_rows));
+
+#if CONFIG_ERROR_CONCEALMENT
+        CHECK_MEM_ERROR(pbi->mt_corrupt_from_col,
+                        vpx_arena_malloc(arena, sizeof(int) * pc->mb_rows));
+#endif
 
         /* Allocate memory for above_row buffers. */
-        CHECK_MEM_ERROR(pbi->mt_yabove_row, vpx_malloc(sizeof(unsigned char *) * pc->mb_rows));
+        CHECK_MEM_ERROR(pbi->mt_yabove_row, vpx_arena_malloc(arena, sizeof(unsigned char *) * pc->mb_rows));
         for (i=0; i< pc->mb_rows; i++)
-            CHECK_MEM_ERROR(pbi->mt_yabove_row[i], vpx_calloc(sizeof(unsigned char) * (width + (VP8BORDERINPIXELS<<1)), 1));
+            CHECK_MEM_ERROR(pbi->mt_yabove_row[i], vpx_arena_calloc(arena, sizeof(unsigned char) * (width + (VP8BORDERINPIXELS<<1)), 1));
 
-        CHECK_MEM_ERROR(pbi->mt_uabove_row, vpx_malloc(sizeof(unsigned char *) * pc->mb_rows));
+        CHECK_MEM_ERROR(pbi->mt_uabove_row, vpx_arena_malloc(arena, sizeof(unsigned char *) * pc->mb_rows));
         for (i=0; i< pc->mb_rows; i++)
-            CHECK_MEM_ERROR(pbi->mt_uabove_row[i], vpx_calloc(sizeof(unsigned char) * (uv_width + VP8BORDERINPIXELS), 1));
+            CHECK_MEM_ERROR(pbi->mt_uabove_row[i], vpx_arena_calloc(arena, sizeof(unsigned char) * (uv_width + VP8BORDERINPIXELS), 1));
 
-        CHECK_MEM_ERROR(pbi->mt_vabove_row, vpx_malloc(sizeof(unsigned char *) * pc->mb_rows));
+        CHECK_MEM_ERROR(pbi->mt_vabove_row, vpx_arena_malloc(arena, sizeof(unsigned char *) * pc->mb_rows));
         for (i=0; i< pc->mb_rows; i++)
-            CHECK_MEM_ERROR(pbi->mt_vabove_row[i], vpx_calloc(sizeof(unsigned char) * (uv_width + VP8BORDERINPIXELS), 1));
+            CHECK_MEM_ERROR(pbi->mt_vabove_row[i], vpx_arena_calloc(arena, sizeof(unsigned char) * (uv_width + VP8BORDERINPIXELS), 1));
 
         /* Allocate memory for left_col buffers. */
-        CHECK_MEM_ERROR(pbi->mt_yleft_col, vpx_malloc(sizeof(unsigned char *) * pc->mb_rows));
+        CHECK_MEM_ERROR(pbi->mt_yleft_col, vpx_arena_malloc(arena, sizeof(unsigned char *) * pc->mb_rows));
         for (i=0; i< pc->mb_rows; i++)
-            CHECK_MEM_ERROR(pbi->mt_yleft_col[i], vpx_calloc(sizeof(unsigned char) * 16, 1));
+            CHECK_MEM_ERROR(pbi->mt_yleft_col[i], vpx_arena_calloc(arena, sizeof(unsigned char) * 16, 1));
 
-        CHECK_MEM_ERROR(pbi->mt_uleft_col, vpx_malloc(sizeof(unsigned char *) * pc->mb_rows));
+        CHECK_MEM_ERROR(pbi->mt_uleft_col, vpx_arena_malloc(arena, sizeof(unsigned char *) * pc->mb_rows));
         for (i=0; i< pc->mb_rows; i++)
-            CHECK_MEM_ERROR(pbi->mt_uleft_col[i], vpx_calloc(sizeof(unsigned char) * 8, 1));
+            CHECK_MEM_ERROR(pbi->mt_uleft_col[i], vpx_arena_calloc(arena, sizeof(unsigned char) * 8, 1));
 
-        CHECK_MEM_ERROR(pbi->mt_vleft_col, vpx_malloc(sizeof(unsigned char *) * pc->mb_rows));
+        CHECK_MEM_ERROR(pbi->mt_vleft_col, vpx_arena_malloc(arena, sizeof(unsigned char *) * pc->mb_rows));
         for (i=0; i< pc->mb_rows; i++)
-            CHECK_MEM_ERROR(pbi->mt_vleft_col[i], vpx_calloc(sizeof(unsigned char) * 8, 1));
+            CHECK_MEM_ERROR(pbi->mt_vleft_col[i], vpx_arena_calloc(arena, sizeof(unsigned char) * 8, 1));
+
+        pbi->mt_buffer_bytes = vpx_arena_used(arena) - arena_used;
     }
 }
 
@@ -744,8 +763,10 @@ void vp8mt_decode_mb_rows( VP8D_COMP *pbi, MACROBLOCKD *xd)
 
     int num_part = 1 << pbi->common.multi_token_partition;
     int i;
-    volatile int *last_row_current_mb_col = NULL;
-    int nsync = pbi->sync_range;
+    const MT_ROW_PROGRESS *last_row_current_mb_col = NULL;
+    MT_SYNC_COUNTERS *sync_counters = &pbi->mt_sync_main;
+    int nsync = pbi->mt_sync.sync_range;
+    struct vpx_usec_timer frame_timer;
 
     int filter_level = pc->filter_level;
     loop_filter_info_n *lfi_n = &pc->lf_info;
@@ -778,6 +799,25 @@ void vp8mt_decode_mb_rows( VP8D_COMP *pbi, MACROBLOCKD *xd)
 
     setup_decoding_thread_data(pbi, xd, pbi->mb_row_di, pbi->decoding_thread_count);
 
+#if CONFIG_POSTPROC
+    pbi->mt_postproc_rows = pc->show_frame &&
+                            vp8_post_proc_rows_init(pc, &pbi->postproc_flags);
+#endif
+
+#if CONFIG_ERROR_CONCEALMENT
+    for (i = 0; i < pc->mb_rows; i++)
+        pbi->mt_corrupt_from_col[i] = pc->mb_cols;
+
+    /* Each row estimates the missing MVs of the row below before decoding
+     * it; the first row is done here, before the workers start. Only the
+     * overlaps were calculated for the whole frame in vp8_decode_frame().
+     */
+    if (pbi->ec_active)
+        vp8_estimate_missing_mvs_row(pbi, 0);
+#endif
+
+    vpx_usec_timer_start(&frame_timer);
+
     for (i = 0; i < pbi->decoding_thread_count; i++)
         sem_post(&pbi->h_event_start_decoding[i]);
 
@@ -810,15 +850,16 @@ void vp8mt_decode_mb_rows( VP8D_COMP *pbi, MACROBLOCKD *xd)
             xd->mb_to_top_edge = -((mb_row * 16)) << 3;
             xd->mb_to_bottom_edge = ((pc->mb_rows - 1 - mb_row) * 16) << 3;
 
+#if CONFIG_ERROR_CONCEALMENT
+            if (pbi->ec_active && mb_row + 1 < pc->mb_rows)
+                vp8_estimate_missing_mvs_row(pbi, mb_row + 1);
+#endif
+
             for (mb_col = 0; mb_col < pc->mb_cols; mb_col++)
             {
-                if ( mb_row > 0 && (mb_col & (nsync-1)) == 0){
-                    while (mb_col > (*last_row_current_mb_col - nsync) && *last_row_current_mb_col != pc->mb_cols - 1)
-                    {
-                        x86_pause_hint();
-                        thread_sleep(0);
-                    }
-                }
+                if ( mb_row > 0 && (mb_col & (nsync-1)) == 0)
+                    vp8_mt_sync_wait(last_row_current_mb_col, mb_col, nsync,
+                                     pc->mb_cols - 1, sync_counters);
 
                 /* Distance of MB to the various image edges.
                  * These are specified to 8th pel as they are always compared to
@@ -829,9 +870,9 @@ void vp8mt_decode_mb_rows( VP8D_COMP *pbi, MACROBLOCKD *xd)
 
 #if CONFIG_ERROR_CONCEALMENT
                 {
-                    int corrupt_residual = (!pbi->independent_partitions &&
-                                            pbi->frame_corrupt_residual) ||
-                                            vp8dx_bool_error(xd->current_bc);
+                    int corrupt_residual =
+                                mt_residual_corrupt(pbi, mb_row, mb_col) ||
+                                vp8dx_bool_error(xd->current_bc);
                     if (pbi->ec_active &&
                         (xd->mode_info_context->mbmi.ref_frame == INTRA_FRAME) &&
                         corrupt_residual)
@@ -880,6 +921,9 @@ void vp8mt_decode_mb_rows( VP8D_COMP *pbi, MACROBLOCKD *xd)
 
                 decode_macroblock(pbi, xd, mb_row, mb_col);
 
+                if (!xd->mode_info_context->mbmi.mb_skip_coeff)
+                    sync_counters->coded_mbs++;
+
                 /* check if the boolean decoder has suffered an error */
                 xd->corrupted |= vp8dx_bool_error(xd->current_bc);
 
@@ -979,7 +1023,7 @@ void vp8mt_decode_mb_rows( VP8D_COMP *pbi, MACROBLOCKD *xd)
 
                 xd->above_context++;
 
-                pbi->mt_current_mb_col[mb_row] = mb_col;
+                pbi->mt_current_mb_col[mb_row].mb_col = mb_col;
             }
 
             /* adjust to the next row of mbs */
@@ -1000,10 +1044,45 @@ void vp8mt_decode_mb_rows( VP8D_COMP *pbi, MACROBLOCKD *xd)
             }else
                 vp8_extend_mb_row(&pc->yv12_fb[dst_fb_idx], xd->dst.y_buffer + 16, xd->dst.u_buffer + 8, xd->dst.v_buffer + 8);
 
+            mt_finish_rows(pbi, mb_row);
+
             ++xd->mode_info_context;      /* skip prediction column */
         }
         xd->mode_info_context += xd->mode_info_stride * pbi->decoding_thread_count;
     }
 
-    sem_wait(&pbi->h_event_end_decoding);   /* add back for each frame */
+    for (i = 0; i < pbi->decoding_thread_count; i++)
+        sem_wait(&pbi->h_event_end_decoding);
+
+#if CONFIG_POSTPROC
+    if (pbi->mt_postproc_rows)
+    {
+        if (!pc->unbordered_refs)
+        {
+            pc->postproc_state.rows_start = 0;
+            pc->postproc_state.rows_end = pc->mb_rows;
+        }
+        else if (pc->mb_rows > 2)
+        {
+            pc->postproc_state.rows_start = 1;
+            pc->postproc_state.rows_end = pc->mb_rows - 1;
+        }
+    }
+#endif
+
+    vpx_usec_timer_mark(&frame_timer);
+
+    /* Pick the sync step for the next frame from this frame's stalls. */
+    {
+        MT_SYNC_COUNTERS total = {0};
+
+        vp8_mt_sync_accumulate(&total, &pbi->mt_sync_main);
+
+        for (i = 0; i < pbi->decoding_thread_count; i++)
+            vp8_mt_sync_accumulate(&total, &pbi->mb_row_di[i].sync_counters);
+
+        vp8_mt_sync_adapt(&pbi->mt_sync, &total, pbi->decoding_thread_count + 1,
+                          (unsigned int)vpx_usec_timer_elapsed(&frame_timer),
+                          pc->mb_rows * pc->mb_cols);
+    }
 }
@@ -18,6 +18,12 @@
 #include "vp8/common/entropy.h"
 #include "vpx_ports/mem.h"
 
+// Largest quantized level the approximate coefficient costing tabulates,
+// bigger ones are costed as this. Blocks up to EST_MIN_EOB coefficients
+// long are cheaper to cost exactly.
+#define EST_LEVEL_MAX 63
+#define EST_MIN_EOB   8
+
 // motion search site
 typedef struct
 {
@@ -117,6 +123,15 @@ typedef struct macroblock
     int optimize;
     int q_index;
 
+    // Approximate coefficient costing (speed feature fast_coef_costing):
+    // the rate of a block is est_eob_costs[type][ctx][eob] plus, for each
+    // nonzero coefficient, est_level_costs[type][raster pos][min(|v|, max)].
+    int fast_coef_costing;
+    short est_level_costs[BLOCK_TYPES][16][EST_LEVEL_MAX + 1];
+    unsigned short est_eob_costs[BLOCK_TYPES][PREV_COEF_CONTEXTS][17];
+
+    int64_t satd_sum;           // of the chosen modes, for the SATD rate model
+
     void (*short_fdct4x4)(short *input, short *output, int pitch);
     void (*short_fdct8x4)(short *input, short *output, int pitch);
     void (*short_walsh4x4)(short *input, short *output, int pitch);
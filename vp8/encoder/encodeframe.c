@@ -28,6 +28,9 @@
 #include <limits.h>
 #include "vp8/common/invtrans.h"
 #include "vpx_ports/vpx_timer.h"
+#if CONFIG_MULTI_RES_ENCODING
+#include "mr_dissim.h"
+#endif
 
 extern void vp8_stuff_mb(VP8_COMP *cpi, MACROBLOCKD *x, TOKENEXTRA **t) ;
 extern void vp8_calc_ref_frame_costs(int *ref_frame_cost,
@@ -37,7 +40,6 @@ extern void vp8_calc_ref_frame_costs(int *ref_frame_cost,
                                     );
 extern void vp8_convert_rfct_to_prob(VP8_COMP *const cpi);
 extern void vp8cx_initialize_me_consts(VP8_COMP *cpi, int QIndex);
-extern void vp8_auto_select_speed(VP8_COMP *cpi);
 extern void vp8cx_init_mbrthread_data(VP8_COMP *cpi,
                                       MACROBLOCK *x,
                                       MB_ROW_COMP *mbr_ei,
@@ -255,69 +257,144 @@ static void calc_activity_index( VP8_COMP *cpi, MACROBLOCK *x )
 }
 #endif
 
-// Loop through all MBs. Note activity of each, average activity and
-// calculate a normalized activity for each
-static void build_activity_map( VP8_COMP *cpi )
+// Note the activity of each MB of a row in the activity map and return
+// their sum. With the encoding threads sharing the rows each MB waits for
+// the MB above it, as the intra measure predicts from its reconstruction.
+int64_t vp8cx_activity_map_row(VP8_COMP *cpi, MACROBLOCK *x, int mb_row)
 {
-    MACROBLOCK *const x = & cpi->mb;
     MACROBLOCKD *xd = &x->e_mbd;
     VP8_COMMON *const cm = & cpi->common;
+    unsigned int *activity = &cpi->mb_activity_map[mb_row * cm->mb_cols];
+    int mb_col;
+    unsigned int mb_activity;
+    int64_t activity_sum = 0;
 
 #if ALT_ACT_MEASURE
     YV12_BUFFER_CONFIG *new_yv12 = &cm->yv12_fb[cm->new_fb_idx];
-    int recon_yoffset;
-    int recon_y_stride = new_yv12->y_stride;
+    int recon_yoffset = mb_row * new_yv12->y_stride * 16;
+    int recon_uvoffset = mb_row * new_yv12->uv_stride * 8;
 #endif
 
-    int mb_row, mb_col;
-    unsigned int mb_activity;
-    int64_t activity_sum = 0;
+#if CONFIG_MULTITHREAD
+    const int nsync = cpi->mt_sync.sync_range;
+    const MT_ROW_PROGRESS *last_row_current_mb_col = NULL;
 
-    // for each macroblock row in image
-    for (mb_row = 0; mb_row < cm->mb_rows; mb_row++)
-    {
-#if ALT_ACT_MEASURE
-        // reset above block coeffs
-        xd->up_available = (mb_row != 0);
-        recon_yoffset = (mb_row * recon_y_stride * 16);
+    // Not part of the encode, so kept out of the sync range statistics
+    MT_SYNC_COUNTERS sync_counters = {0};
+
+    if ((cpi->b_multi_threaded != 0) && (mb_row != 0))
+        last_row_current_mb_col = &cpi->mt_current_mb_col[mb_row - 1];
 #endif
-        // for each macroblock col in image
-        for (mb_col = 0; mb_col < cm->mb_cols; mb_col++)
-        {
+
+    x->src.y_buffer = cpi->Source->y_buffer + 16 * mb_row * x->src.y_stride;
+
 #if ALT_ACT_MEASURE
-            xd->dst.y_buffer = new_yv12->y_buffer + recon_yoffset;
-            xd->left_available = (mb_col != 0);
-            recon_yoffset += 16;
+    // reset above block coeffs
+    xd->up_available = (mb_row != 0);
+
+    // The trellis only reads these; leave them where the frame's encode
+    // starts rather than wherever the last coded row left them.
+    xd->above_context = cm->above_context;
+    xd->left_context = &cm->left_context;
 #endif
-            //Copy current mb to a buffer
-            vp8_copy_mem16x16(x->src.y_buffer, x->src.y_stride, x->thismb, 16);
 
-            // measure activity
-            mb_activity = mb_activity_measure( cpi, x, mb_row, mb_col );
+    x->rddiv = cpi->RDDIV;
+    x->rdmult = cpi->RDMULT;
+
+    // for each macroblock col in image
+    for (mb_col = 0; mb_col < cm->mb_cols; mb_col++)
+    {
+#if CONFIG_MULTITHREAD
+        if (last_row_current_mb_col && (mb_col & (nsync - 1)) == 0)
+            vp8_mt_sync_wait(last_row_current_mb_col, mb_col, nsync,
+                             cm->mb_cols - 1, &sync_counters);
+#endif
 
-            // Keep frame sum
-            activity_sum += mb_activity;
+#if ALT_ACT_MEASURE
+        xd->dst.y_buffer = new_yv12->y_buffer + recon_yoffset;
+        xd->dst.u_buffer = new_yv12->u_buffer + recon_uvoffset;
+        xd->dst.v_buffer = new_yv12->v_buffer + recon_uvoffset;
+        xd->left_available = (mb_col != 0);
+        recon_yoffset += 16;
+        recon_uvoffset += 8;
+#endif
+        //Copy current mb to a buffer
+        vp8_copy_mem16x16(x->src.y_buffer, x->src.y_stride, x->thismb, 16);
 
-            // Store MB level activity details.
-            *x->mb_activity_ptr = mb_activity;
+        // measure activity
+        mb_activity = mb_activity_measure( cpi, x, mb_row, mb_col );
 
-            // Increment activity map pointer
-            x->mb_activity_ptr++;
+        // Keep row sum
+        activity_sum += mb_activity;
 
-            // adjust to the next column of source macroblocks
-            x->src.y_buffer += 16;
-        }
+        // Store MB level activity details.
+        activity[mb_col] = mb_activity;
 
+        // adjust to the next column of source macroblocks
+        x->src.y_buffer += 16;
 
-        // adjust to the next row of mbs
-        x->src.y_buffer += 16 * x->src.y_stride - 16 * cm->mb_cols;
+#if CONFIG_MULTITHREAD
+        if (cpi->b_multi_threaded != 0)
+            cpi->mt_current_mb_col[mb_row].mb_col = mb_col;
+#endif
+    }
 
 #if ALT_ACT_MEASURE
-        //extend the recon for intra prediction
-        vp8_extend_mb_row(new_yv12, xd->dst.y_buffer + 16,
-                          xd->dst.u_buffer + 8, xd->dst.v_buffer + 8);
+    //extend the recon for intra prediction
+    vp8_extend_mb_row(new_yv12, xd->dst.y_buffer + 16,
+                      xd->dst.u_buffer + 8, xd->dst.v_buffer + 8);
 #endif
 
+    return activity_sum;
+}
+
+// Loop through all MBs. Note activity of each, average activity and
+// calculate a normalized activity for each
+static void build_activity_map( VP8_COMP *cpi )
+{
+    MACROBLOCK *const x = & cpi->mb;
+    VP8_COMMON *const cm = & cpi->common;
+
+    int mb_row;
+    int64_t activity_sum = 0;
+
+#if CONFIG_MULTITHREAD
+    if (cpi->b_multi_threaded)
+    {
+        int i, j;
+
+        vp8cx_init_mbrthread_data(cpi, x, cpi->mb_row_ei, 1,  cpi->encoding_thread_count);
+
+        // The threads still hold the zbin_extra of the last MB they coded,
+        // measure with the frame's like the main thread.
+        for (i = 0; i < cpi->encoding_thread_count; i++)
+            for (j = 0; j < 25; j++)
+                cpi->mb_row_ei[i].mb.block[j].zbin_extra = x->block[j].zbin_extra;
+
+        vp8_mt_sync_reset_rows(cpi->mt_current_mb_col, cm->mb_rows);
+
+        cpi->mt_activity_map = 1;
+
+        for (i = 0; i < cpi->encoding_thread_count; i++)
+            sem_post(&cpi->h_event_start_encoding[i]);
+
+        for (mb_row = 0; mb_row < cm->mb_rows; mb_row += (cpi->encoding_thread_count + 1))
+            activity_sum += vp8cx_activity_map_row(cpi, x, mb_row);
+
+        for (i = 0; i < cpi->encoding_thread_count; i++)
+            sem_wait(&cpi->h_event_end_job);
+
+        for (i = 0; i < cpi->encoding_thread_count; i++)
+            activity_sum += cpi->mb_row_ei[i].activity_sum;
+
+        cpi->mt_activity_map = 0;
+    }
+    else
+#endif
+    {
+        // for each macroblock row in image
+        for (mb_row = 0; mb_row < cm->mb_rows; mb_row++)
+            activity_sum += vp8cx_activity_map_row(cpi, x, mb_row);
     }
 
     // Calculate an "average" MB activity
@@ -374,14 +451,11 @@ void encode_mb_row(VP8_COMP *cpi,
     int map_index = (mb_row * cpi->common.mb_cols);
 
 #if CONFIG_MULTITHREAD
-    const int nsync = cpi->mt_sync_range;
-    const int rightmost_col = cm->mb_cols - 1;
-    volatile const int *last_row_current_mb_col;
+    const int nsync = cpi->mt_sync.sync_range;
+    const MT_ROW_PROGRESS *last_row_current_mb_col = NULL;
 
     if ((cpi->b_multi_threaded != 0) && (mb_row != 0))
         last_row_current_mb_col = &cpi->mt_current_mb_col[mb_row - 1];
-    else
-        last_row_current_mb_col = &rightmost_col;
 #endif
 
     // reset above block coeffs
@@ -438,14 +512,8 @@ void encode_mb_row(VP8_COMP *cpi,
         if ((cpi->b_multi_threaded != 0) && (mb_row != 0))
         {
             if ((mb_col & (nsync - 1)) == 0)
-            {
-                while (mb_col > (*last_row_current_mb_col - nsync)
-                        && (*last_row_current_mb_col) != (cm->mb_cols - 1))
-                {
-                    x86_pause_hint();
-                    thread_sleep(0);
-                }
-            }
+                vp8_mt_sync_wait(last_row_current_mb_col, mb_col, nsync,
+                                 cm->mb_cols - 1, &cpi->mt_sync_main);
         }
 #endif
 
@@ -525,6 +593,12 @@ void encode_mb_row(VP8_COMP *cpi,
 
         cpi->tplist[mb_row].stop = *tp;
 
+#if CONFIG_MULTITHREAD
+        // Only the MT sync step adaptation reads this.
+        if (cpi->b_multi_threaded && !xd->mode_info_context->mbmi.mb_skip_coeff)
+            cpi->mt_sync_main.coded_mbs++;
+#endif
+
         // Increment pointer into gf useage flags structure.
         x->gf_active_ptr++;
 
@@ -550,7 +624,7 @@ void encode_mb_row(VP8_COMP *cpi,
 #if CONFIG_MULTITHREAD
         if (cpi->b_multi_threaded != 0)
         {
-            cpi->mt_current_mb_col[mb_row] = mb_col;
+            cpi->mt_current_mb_col[mb_row].mb_col = mb_col;
         }
 #endif
     }
@@ -566,6 +640,10 @@ void encode_mb_row(VP8_COMP *cpi,
     xd->mode_info_context++;
     x->partition_info++;
 
+#if CONFIG_MULTI_RES_ENCODING
+    vp8_mr_row_coded(cpi, mb_row);
+#endif
+
 #if CONFIG_MULTITHREAD
     if ((cpi->b_multi_threaded != 0) && (mb_row == cm->mb_rows - 1))
     {
@@ -672,7 +750,7 @@ void vp8_encode_frame(VP8_COMP *cpi)
         if (cpi->oxcf.cpu_used < 0)
             cpi->Speed = -(cpi->oxcf.cpu_used);
         else
-            vp8_auto_select_speed(cpi);
+            vp8_speed_ctrl_select(cpi);
     }
 
     // Functions setup for all frame types so we can use MC in AltRef
@@ -719,6 +797,16 @@ void vp8_encode_frame(VP8_COMP *cpi)
 
     vp8cx_initialize_me_consts(cpi, cm->base_qindex);
 
+    // Coarse motion field the full pel searches start from
+    vp8_hme_frame(cpi);
+
+    // A key frame starts the mode history over
+    if (cm->frame_type == KEY_FRAME)
+        vpx_memset(cpi->mode_history, 0, (cm->mb_cols + 1) * (cm->mb_rows + 1)
+                   * sizeof(*cpi->mode_history));
+
+    x->satd_sum = 0;
+
     if(cpi->oxcf.tuning == VP8_TUNE_SSIM)
     {
         // Initialize encode frame context.
@@ -742,8 +830,7 @@ void vp8_encode_frame(VP8_COMP *cpi)
 
             vp8cx_init_mbrthread_data(cpi, x, cpi->mb_row_ei, 1,  cpi->encoding_thread_count);
 
-            for (i = 0; i < cm->mb_rows; i++)
-                cpi->mt_current_mb_col[i] = -1;
+            vp8_mt_sync_reset_rows(cpi->mt_current_mb_col, cm->mb_rows);
 
             for (i = 0; i < cpi->encoding_thread_count; i++)
             {
@@ -771,6 +858,25 @@ void vp8_encode_frame(VP8_COMP *cpi)
 
             sem_wait(&cpi->h_event_end_encoding); /* wait for other threads to finish */
 
+            vpx_usec_timer_mark(&emr_timer);
+
+            /* Pick the sync step for the next frame from this frame's
+             * stalls.
+             */
+            {
+                MT_SYNC_COUNTERS total = {0};
+
+                vp8_mt_sync_accumulate(&total, &cpi->mt_sync_main);
+
+                for (i = 0; i < cpi->encoding_thread_count; i++)
+                    vp8_mt_sync_accumulate(&total, &cpi->mb_row_ei[i].sync_counters);
+
+                vp8_mt_sync_adapt(&cpi->mt_sync, &total,
+                                  cpi->encoding_thread_count + 1,
+                                  (unsigned int)vpx_usec_timer_elapsed(&emr_timer),
+                                  cm->mb_rows * cm->mb_cols);
+            }
+
             cpi->tok_count = 0;
 
             for (mb_row = 0; mb_row < cm->mb_rows; mb_row ++)
@@ -796,6 +902,7 @@ void vp8_encode_frame(VP8_COMP *cpi)
             for (i = 0; i < cpi->encoding_thread_count; i++)
             {
                 totalrate += cpi->mb_row_ei[i].totalrate;
+                x->satd_sum += cpi->mb_row_ei[i].mb.satd_sum;
             }
 
         }
@@ -1148,7 +1255,7 @@ int vp8cx_encode_inter_macroblock
             cpi->zbin_mode_boost_enabled = 0;
         }
         vp8_rd_pick_inter_mode(cpi, x, recon_yoffset, recon_uvoffset, &rate,
-                               &distortion, &intra_error);
+                               &distortion, &intra_error, mb_row, mb_col);
 
         /* switch back to the regular quantizer for the encode */
         if (cpi->sf.improved_quant)
@@ -228,6 +228,9 @@ static void optimize_b(MACROBLOCK *mb, int ib, int type,
     BLOCKD *d;
     vp8_token_state tokens[17][2];
     unsigned best_mask[2];
+    int err0[16];
+    int err1[16];
+    int lower_mask;
     const short *dequant_ptr;
     const short *coeff_ptr;
     short *qcoeff_ptr;
@@ -236,7 +239,6 @@ static void optimize_b(MACROBLOCK *mb, int ib, int type,
     int i0;
     int rc;
     int x;
-    int sz = 0;
     int next;
     int rdmult;
     int rddiv;
@@ -272,6 +274,52 @@ static void optimize_b(MACROBLOCK *mb, int ib, int type,
     i0 = !type;
     eob = *d->eob;
 
+    /* Nothing to optimize in an empty block. The fast trellis also leaves
+     * blocks with a single coefficient alone.
+     */
+    if (eob <= i0 + (mb->optimize == 2))
+    {
+        if (eob <= i0)
+        {
+            *a = *l = 0;
+            *d->eob = (char)i0;
+        }
+        else
+            *a = *l = 1;
+
+        return;
+    }
+
+    /* The squared error of keeping each coefficient (err0) and of moving
+     * it one step towards zero (err1), and the coefficients for which the
+     * latter is a candidate at all: those that were rounded away from
+     * zero. For the others the second trellis state is a copy of the
+     * first. The fast trellis only tries lowering levels of 1 to 0.
+     */
+    lower_mask = 0;
+
+    for (i = 0; i < 16; i++)
+    {
+        int q = qcoeff_ptr[i];
+        int dq = dequant_ptr[i];
+        int c = coeff_ptr[i];
+        int ax = (q < 0 ? -q : q) * dq;
+        int ac = c < 0 ? -c : c;
+        int dx = dqcoeff_ptr[i] - c;
+        int dx1 = dx - (q < 0 ? -dq : dq);
+
+        err0[i] = dx * dx;
+        err1[i] = dx1 * dx1;
+        lower_mask |= (ax > ac && ax < ac + dq) << i;
+    }
+
+    if (mb->optimize == 2)
+    {
+        for (i = 0; i < 16; i++)
+            if (qcoeff_ptr[i] != 1 && qcoeff_ptr[i] != -1)
+                lower_mask &= ~(1 << i);
+    }
+
     /* Now set up a Viterbi trellis to evaluate alternative roundings. */
     rdmult = mb->rdmult * err_mult;
     if(mb->e_mbd.mode_info_context->mbmi.ref_frame==INTRA_FRAME)
@@ -290,15 +338,12 @@ static void optimize_b(MACROBLOCK *mb, int ib, int type,
     for (i = eob; i-- > i0;)
     {
         int base_bits;
-        int d2;
-        int dx;
 
         rc = vp8_default_zig_zag1d[i];
         x = qcoeff_ptr[rc];
         /* Only add a trellis state for non-zero coefficients. */
         if (x)
         {
-            int shortcut=0;
             error0 = tokens[next][0].error;
             error1 = tokens[next][1].error;
             /* Evaluate the first possibility for this state. */
@@ -325,29 +370,29 @@ static void optimize_b(MACROBLOCK *mb, int ib, int type,
             /* And pick the best. */
             best = rd_cost1 < rd_cost0;
             base_bits = *(vp8_dct_value_cost_ptr + x);
-            dx = dqcoeff_ptr[rc] - coeff_ptr[rc];
-            d2 = dx*dx;
             tokens[i][0].rate = base_bits + (best ? rate1 : rate0);
-            tokens[i][0].error = d2 + (best ? error1 : error0);
+            tokens[i][0].error = err0[rc] + (best ? error1 : error0);
             tokens[i][0].next = next;
             tokens[i][0].token = t0;
             tokens[i][0].qc = x;
             best_mask[0] |= best << i;
+
+            /* Keeping the level is the only choice here, the second state
+             * would come out the same as the first.
+             */
+            if (!((lower_mask >> rc) & 1))
+            {
+                tokens[i][1] = tokens[i][0];
+                best_mask[1] |= best << i;
+                next = i;
+                continue;
+            }
+
             /* Evaluate the second possibility for this state. */
             rate0 = tokens[next][0].rate;
             rate1 = tokens[next][1].rate;
 
-            if((abs(x)*dequant_ptr[rc]>abs(coeff_ptr[rc])) &&
-               (abs(x)*dequant_ptr[rc]<abs(coeff_ptr[rc])+dequant_ptr[rc]))
-                shortcut = 1;
-            else
-                shortcut = 0;
-
-            if(shortcut)
-            {
-                sz = -(x < 0);
-                x -= 2*sz + 1;
-            }
+            x -= x < 0 ? -1 : 1;
 
             /* Consider both possible successor states. */
             if (!x)
@@ -392,13 +437,8 @@ static void optimize_b(MACROBLOCK *mb, int ib, int type,
             best = rd_cost1 < rd_cost0;
             base_bits = *(vp8_dct_value_cost_ptr + x);
 
-            if(shortcut)
-            {
-                dx -= (dequant_ptr[rc] + sz) ^ sz;
-                d2 = dx*dx;
-            }
             tokens[i][1].rate = base_bits + (best ? rate1 : rate0);
-            tokens[i][1].error = d2 + (best ? error1 : error0);
+            tokens[i][1].error = err1[rc] + (best ? error1 : error0);
             tokens[i][1].next = next;
             tokens[i][1].token =best?t1:t0;
             tokens[i][1].qc = x;
@@ -12,19 +12,28 @@
 #include "vp8/common/threading.h"
 #include "vp8/common/common.h"
 #include "vp8/common/extend.h"
+#if CONFIG_MULTI_RES_ENCODING
+#include "mr_dissim.h"
+#endif
 
 #if CONFIG_MULTITHREAD
 
 extern int vp8cx_encode_inter_macroblock(VP8_COMP *cpi, MACROBLOCK *x,
                                          TOKENEXTRA **t, int recon_yoffset,
-                                         int recon_uvoffset);
+                                         int recon_uvoffset, int mb_row,
+                                         int mb_col);
 extern int vp8cx_encode_intra_macro_block(VP8_COMP *cpi, MACROBLOCK *x,
-                                          TOKENEXTRA **t);
+                                          TOKENEXTRA **t, int mb_row,
+                                          int mb_col);
 extern void vp8cx_mb_init_quantizer(VP8_COMP *cpi, MACROBLOCK *x, int ok_to_skip);
 extern void vp8_build_block_offsets(MACROBLOCK *x);
 extern void vp8_setup_block_ptrs(MACROBLOCK *x);
 
 extern void loopfilter_frame(VP8_COMP *cpi, VP8_COMMON *cm);
+extern int vp8cx_calc_lpf_level_err(VP8_COMP *cpi, YV12_BUFFER_CONFIG *sd,
+                                    YV12_BUFFER_CONFIG *dst, int filt_lvl);
+extern int64_t vp8cx_activity_map_row(VP8_COMP *cpi, MACROBLOCK *x,
+                                      int mb_row);
 
 static THREAD_FUNCTION loopfilter_thread(void *p_data)
 {
@@ -57,8 +66,8 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
     VP8_COMP *cpi = (VP8_COMP *)(((ENCODETHREAD_DATA *)p_data)->ptr1);
     MB_ROW_COMP *mbri = (MB_ROW_COMP *)(((ENCODETHREAD_DATA *)p_data)->ptr2);
     ENTROPY_CONTEXT_PLANES mb_row_left_context;
+    MT_SYNC_COUNTERS *sync_counters = &mbri->sync_counters;
 
-    const int nsync = cpi->mt_sync_range;
     //printf("Started thread %d\n", ithread);
 
     while (1)
@@ -77,10 +86,43 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
 
             int *segment_counts = mbri->segment_counts;
             int *totalrate = &mbri->totalrate;
+            const int nsync = cpi->mt_sync.sync_range;
 
             if (cpi->b_multi_threaded == 0) // we're shutting down
                 break;
 
+            if (cpi->mt_lpf_search)
+            {
+                mbri->lpf_err = vp8cx_calc_lpf_level_err(cpi, cpi->lpf_search_src,
+                                                         &mbri->lpf_frame,
+                                                         mbri->lpf_level);
+                sem_post(&cpi->h_event_end_job);
+                continue;
+            }
+
+            if (cpi->mt_activity_map)
+            {
+                mbri->activity_sum = 0;
+
+                for (mb_row = ithread + 1; mb_row < cm->mb_rows; mb_row += (cpi->encoding_thread_count + 1))
+                    mbri->activity_sum += vp8cx_activity_map_row(cpi, x, mb_row);
+
+                sem_post(&cpi->h_event_end_job);
+                continue;
+            }
+
+            if (cpi->mt_resize)
+            {
+                int band;
+
+                for (band = ithread + 1; band < vp8_resize_bands(&cpi->resize); band += (cpi->encoding_thread_count + 1))
+                    vp8_resize_band(&cpi->resize, cpi->resize_src,
+                                    &cpi->scaled_source, band, ithread + 1);
+
+                sem_post(&cpi->h_event_end_job);
+                continue;
+            }
+
             for (mb_row = ithread + 1; mb_row < cm->mb_rows; mb_row += (cpi->encoding_thread_count + 1))
             {
 
@@ -91,7 +133,7 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
                 int recon_y_stride = cm->yv12_fb[ref_fb_idx].y_stride;
                 int recon_uv_stride = cm->yv12_fb[ref_fb_idx].uv_stride;
                 int map_index = (mb_row * cm->mb_cols);
-                volatile int *last_row_current_mb_col;
+                const MT_ROW_PROGRESS *last_row_current_mb_col;
 
                 tp = cpi->tok + (mb_row * (cm->mb_cols * 16 * 24));
 
@@ -118,13 +160,8 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
                 for (mb_col = 0; mb_col < cm->mb_cols; mb_col++)
                 {
                     if ((mb_col & (nsync - 1)) == 0)
-                    {
-                        while (mb_col > (*last_row_current_mb_col - nsync) && *last_row_current_mb_col != cm->mb_cols - 1)
-                        {
-                            x86_pause_hint();
-                            thread_sleep(0);
-                        }
-                    }
+                        vp8_mt_sync_wait(last_row_current_mb_col, mb_col, nsync,
+                                         cm->mb_cols - 1, sync_counters);
 
                     // Distance of Mb to the various image edges.
                     // These specified to 8th pel as they are always compared to values that are in 1/8th pel units
@@ -172,14 +209,14 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
 
                     if (cm->frame_type == KEY_FRAME)
                     {
-                        *totalrate += vp8cx_encode_intra_macro_block(cpi, x, &tp);
+                        *totalrate += vp8cx_encode_intra_macro_block(cpi, x, &tp, mb_row, mb_col);
 #ifdef MODE_STATS
                         y_modes[xd->mbmi.mode] ++;
 #endif
                     }
                     else
                     {
-                        *totalrate += vp8cx_encode_inter_macroblock(cpi, x, &tp, recon_yoffset, recon_uvoffset);
+                        *totalrate += vp8cx_encode_inter_macroblock(cpi, x, &tp, recon_yoffset, recon_uvoffset, mb_row, mb_col);
 
 #ifdef MODE_STATS
                         inter_y_modes[xd->mbmi.mode] ++;
@@ -225,6 +262,9 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
                     }
                     cpi->tplist[mb_row].stop = tp;
 
+                    if (!xd->mode_info_context->mbmi.mb_skip_coeff)
+                        sync_counters->coded_mbs++;
+
                     // Increment pointer into gf useage flags structure.
                     x->gf_active_ptr++;
 
@@ -247,7 +287,7 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
                     x->partition_info++;
                     xd->above_context++;
 
-                    cpi->mt_current_mb_col[mb_row] = mb_col;
+                    cpi->mt_current_mb_col[mb_row].mb_col = mb_col;
                 }
 
                 //extend the recon for intra prediction
@@ -269,6 +309,10 @@ THREAD_FUNCTION thread_encoding_proc(void *p_data)
                 x->partition_info += xd->mode_info_stride * cpi->encoding_thread_count;
                 x->gf_active_ptr   += cm->mb_cols * cpi->encoding_thread_count;
 
+#if CONFIG_MULTI_RES_ENCODING
+                vp8_mr_row_coded(cpi, mb_row);
+#endif
+
                 if (mb_row == cm->mb_rows - 1)
                 {
                     //SetEvent(cpi->h_event_main);
@@ -310,6 +354,7 @@ static void setup_mbby_copy(MACROBLOCK *mbdst, MACROBLOCK *mbsrc)
     z->quantize_b        = x->quantize_b;
     z->quantize_b_pair   = x->quantize_b_pair;
     z->optimize          = x->optimize;
+    z->fast_coef_costing = x->fast_coef_costing;
 
     /*
     z->mvc              = x->mvc;
@@ -327,6 +372,14 @@ static void setup_mbby_copy(MACROBLOCK *mbdst, MACROBLOCK *mbsrc)
 
 
     vpx_memcpy(z->token_costs,       x->token_costs,      sizeof(x->token_costs));
+
+    if (x->fast_coef_costing)
+    {
+        vpx_memcpy(z->est_level_costs, x->est_level_costs,
+                   sizeof(x->est_level_costs));
+        vpx_memcpy(z->est_eob_costs, x->est_eob_costs,
+                   sizeof(x->est_eob_costs));
+    }
     vpx_memcpy(z->inter_bmode_costs,  x->inter_bmode_costs, sizeof(x->inter_bmode_costs));
     //memcpy(z->mvcosts,            x->mvcosts,         sizeof(x->mvcosts));
     //memcpy(z->mvcost,         x->mvcost,          sizeof(x->mvcost));
@@ -429,6 +482,7 @@ void vp8cx_init_mbrthread_data(VP8_COMP *cpi,
 
         vpx_memset(mbr_ei[i].segment_counts, 0, sizeof(mbr_ei[i].segment_counts));
         mbr_ei[i].totalrate = 0;
+        mb->satd_sum = 0;
 
         mb->partition_info = x->pi + x->e_mbd.mode_info_stride * (i + 1);
 
@@ -465,6 +519,81 @@ void vp8cx_init_mbrthread_data(VP8_COMP *cpi,
     }
 }
 
+/* Scores the n loop filter levels in levels[] at once, the calling
+ * (loop filter) thread taking the first and the idle encoding threads the
+ * others. The encoding threads must not be busy with a frame.
+ */
+void vp8cx_calc_lpf_levels_err_mt(VP8_COMP *cpi, YV12_BUFFER_CONFIG *sd,
+                                  const int *levels, int *errs, int n)
+{
+    int i;
+
+    cpi->mt_lpf_search = 1;
+    cpi->lpf_search_src = sd;
+
+    for (i = 1; i < n; i++)
+    {
+        cpi->mb_row_ei[i - 1].lpf_level = levels[i];
+        sem_post(&cpi->h_event_start_encoding[i - 1]);
+    }
+
+    errs[0] = vp8cx_calc_lpf_level_err(cpi, sd, &cpi->pick_lf_lvl_frame,
+                                       levels[0]);
+
+    for (i = 1; i < n; i++)
+        sem_wait(&cpi->h_event_end_job);
+
+    for (i = 1; i < n; i++)
+        errs[i] = cpi->mb_row_ei[i - 1].lpf_err;
+
+    cpi->mt_lpf_search = 0;
+}
+
+/* Resizes src into cpi->scaled_source with cpi->resize, the bands
+ * interleaved over the calling thread and the encoding threads. The
+ * encoding threads must not be busy with a frame.
+ */
+void vp8cx_resize_frame_mt(VP8_COMP *cpi, YV12_BUFFER_CONFIG *src)
+{
+    int band, i;
+
+    cpi->mt_resize = 1;
+    cpi->resize_src = src;
+
+    for (i = 0; i < cpi->encoding_thread_count; i++)
+        sem_post(&cpi->h_event_start_encoding[i]);
+
+    for (band = 0; band < vp8_resize_bands(&cpi->resize); band += (cpi->encoding_thread_count + 1))
+        vp8_resize_band(&cpi->resize, src, &cpi->scaled_source, band, 0);
+
+    for (i = 0; i < cpi->encoding_thread_count; i++)
+        sem_wait(&cpi->h_event_end_job);
+
+    cpi->mt_resize = 0;
+}
+
+/* (Re)allocates the scratch frames of the encoding threads for the loop
+ * filter level search, sized like cpi->pick_lf_lvl_frame.
+ */
+void vp8cx_alloc_lpf_search_frames(VP8_COMP *cpi)
+{
+    int i;
+
+    for (i = 0; i < cpi->encoding_thread_count; i++)
+    {
+        YV12_BUFFER_CONFIG *frame = &cpi->mb_row_ei[i].lpf_frame;
+
+        vp8_yv12_de_alloc_frame_buffer(frame);
+
+        if (vp8_yv12_alloc_frame_buffer(frame,
+                                        cpi->pick_lf_lvl_frame.y_width,
+                                        cpi->pick_lf_lvl_frame.y_height,
+                                        VP8BORDERINPIXELS))
+            vpx_internal_error(&cpi->common.error, VPX_CODEC_MEM_ERROR,
+                               "Failed to allocate loop filter search buffer");
+    }
+}
+
 void vp8cx_create_encoder_threads(VP8_COMP *cpi)
 {
     const VP8_COMMON * cm = &cpi->common;
@@ -483,9 +612,9 @@ void vp8cx_create_encoder_threads(VP8_COMP *cpi)
 
         /* we have th_count + 1 (main) threads processing one row each */
         /* no point to have more threads than the sync range allows */
-        if(th_count > ((cm->mb_cols / cpi->mt_sync_range) - 1))
+        if(th_count > ((cm->mb_cols / cpi->mt_sync.default_range) - 1))
         {
-            th_count = (cm->mb_cols / cpi->mt_sync_range) - 1;
+            th_count = (cm->mb_cols / cpi->mt_sync.default_range) - 1;
         }
 
         if(th_count == 0)
@@ -498,13 +627,17 @@ void vp8cx_create_encoder_threads(VP8_COMP *cpi)
         CHECK_MEM_ERROR(cpi->en_thread_data,
                         vpx_malloc(sizeof(ENCODETHREAD_DATA) * th_count));
         CHECK_MEM_ERROR(cpi->mt_current_mb_col,
-                        vpx_malloc(sizeof(*cpi->mt_current_mb_col) * cm->mb_rows));
+                        vpx_memalign(MT_SYNC_CACHE_LINE,
+                                     sizeof(*cpi->mt_current_mb_col) * cm->mb_rows));
 
         sem_init(&cpi->h_event_end_encoding, 0, 0);
+        sem_init(&cpi->h_event_end_job, 0, 0);
 
         cpi->b_multi_threaded = 1;
         cpi->encoding_thread_count = th_count;
 
+        vp8cx_alloc_lpf_search_frames(cpi);
+
         /*
         printf("[VP8:] multi_threaded encoding is enabled with %d threads\n\n",
                (cpi->encoding_thread_count +1));
@@ -551,6 +684,7 @@ void vp8cx_remove_encoder_threads(VP8_COMP *cpi)
                 pthread_join(cpi->h_encoding_thread[i], 0);
 
                 sem_destroy(&cpi->h_event_start_encoding[i]);
+                vp8_yv12_de_alloc_frame_buffer(&cpi->mb_row_ei[i].lpf_frame);
             }
 
             sem_post(&cpi->h_event_start_lpf);
@@ -558,6 +692,7 @@ void vp8cx_remove_encoder_threads(VP8_COMP *cpi)
         }
 
         sem_destroy(&cpi->h_event_end_encoding);
+        sem_destroy(&cpi->h_event_end_job);
         sem_destroy(&cpi->h_event_end_lpf);
         sem_destroy(&cpi->h_event_start_lpf);
 
@@ -0,0 +1,334 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include <stdlib.h>
+#include <limits.h>
+#include "onyx_int.h"
+#include "hme.h"
+#include "vpx_mem/vpx_mem.h"
+
+/* Coarse search range in 8:1 pels, i.e. +/-64 full pels. */
+#define HME_RANGE 8
+
+/* The seeded motion is good to a pel or two, so the full pel search that
+ * starts from it can begin with its small steps.
+ */
+#define HME_STEP_PARAM (MAX_MVSEARCH_STEPS - 3)
+
+int vp8_hme_alloc(HME_STATE *hme, int mb_rows, int mb_cols)
+{
+    int i, size = 0;
+    unsigned char *p;
+
+    vp8_hme_free(hme);
+
+    for (i = 0; i < HME_LEVELS; i++)
+    {
+        hme->width[i] = (mb_cols * 16) >> (i + 1);
+        hme->height[i] = (mb_rows * 16) >> (i + 1);
+        hme->stride[i] = hme->width[i];
+        size += 2 * hme->stride[i] * hme->height[i];
+    }
+
+    hme->buf = vpx_malloc(size);
+    hme->mvs = vpx_calloc(mb_rows * mb_cols, sizeof(*hme->mvs));
+
+    if (!hme->buf || !hme->mvs)
+    {
+        vp8_hme_free(hme);
+        return 1;
+    }
+
+    p = hme->buf;
+
+    for (i = 0; i < HME_LEVELS; i++)
+    {
+        hme->src[i] = p;
+        p += hme->stride[i] * hme->height[i];
+        hme->ref[i] = p;
+        p += hme->stride[i] * hme->height[i];
+    }
+
+    return 0;
+}
+
+void vp8_hme_free(HME_STATE *hme)
+{
+    vpx_free(hme->buf);
+    vpx_free(hme->mvs);
+    vpx_memset(hme, 0, sizeof(*hme));
+}
+
+static void downsample_2to1(const unsigned char *src, int src_stride,
+                            unsigned char *dst, int dst_stride,
+                            int width, int height)
+{
+    int r, c;
+
+    for (r = 0; r < height; r++)
+    {
+        const unsigned char *s0 = src + 2 * r * src_stride;
+        const unsigned char *s1 = s0 + src_stride;
+
+        for (c = 0; c < width; c++)
+            dst[c] = (s0[2*c] + s0[2*c+1] + s1[2*c] + s1[2*c+1] + 2) >> 2;
+
+        dst += dst_stride;
+    }
+}
+
+/* Checks one candidate of the n x n block at (x, y) on a level, keeping
+ * the cheapest. Small motion is slightly preferred so flat areas do not
+ * pick up noise.
+ */
+static void check_candidate(const HME_STATE *hme, vp8_sad_fn_t sdf,
+                            int level, int x, int y, int n, int row, int col,
+                            unsigned int *best_cost, int_mv *best)
+{
+    const int stride = hme->stride[level];
+    unsigned int cost;
+
+    if (x + col < 0 || x + col > hme->width[level] - n ||
+        y + row < 0 || y + row > hme->height[level] - n)
+        return;
+
+    cost = sdf(hme->src[level] + y * stride + x, stride,
+               hme->ref[level] + (y + row) * stride + x + col, stride,
+               INT_MAX) + abs(row) + abs(col);
+
+    if (cost < *best_cost)
+    {
+        *best_cost = cost;
+        best->as_mv.row = row;
+        best->as_mv.col = col;
+    }
+}
+
+/* Searches the coarsest level with a 4x4 block centred on the MB, i.e. the
+ * MB and half of each of its neighbours, which is small enough to be
+ * cheap and wide enough not to lock on to noise.
+ */
+static int_mv search_coarse(const HME_STATE *hme, vp8_sad_fn_t sdf,
+                            int mb_row, int mb_col, int mb_cols)
+{
+    const int level = HME_LEVELS - 1;
+    const int n = 4, mb_size = 16 >> HME_LEVELS;
+    unsigned int best_cost = UINT_MAX;
+    int_mv best, center;
+    int x, y, r, c, step;
+
+    x = mb_col * mb_size - (n - mb_size) / 2;
+    x = x < 0 ? 0 : x > hme->width[level] - n ? hme->width[level] - n : x;
+    y = mb_row * mb_size - (n - mb_size) / 2;
+    y = y < 0 ? 0 : y > hme->height[level] - n ? hme->height[level] - n : y;
+
+    best.as_int = 0;
+    check_candidate(hme, sdf, level, x, y, n, 0, 0, &best_cost, &best);
+
+    /* The neighbours already searched usually share the motion. */
+    if (mb_col > 0)
+    {
+        int_mv left = hme->mvs[mb_row * mb_cols + mb_col - 1];
+        check_candidate(hme, sdf, level, x, y, n,
+                        left.as_mv.row >> HME_LEVELS,
+                        left.as_mv.col >> HME_LEVELS, &best_cost, &best);
+    }
+
+    if (mb_row > 0)
+    {
+        int_mv above = hme->mvs[(mb_row - 1) * mb_cols + mb_col];
+        check_candidate(hme, sdf, level, x, y, n,
+                        above.as_mv.row >> HME_LEVELS,
+                        above.as_mv.col >> HME_LEVELS, &best_cost, &best);
+    }
+
+    for (r = -HME_RANGE; r <= HME_RANGE; r += HME_RANGE / 2)
+        for (c = -HME_RANGE; c <= HME_RANGE; c += HME_RANGE / 2)
+            check_candidate(hme, sdf, level, x, y, n, r, c, &best_cost, &best);
+
+    for (step = HME_RANGE / 4; step > 0; step >>= 1)
+    {
+        center = best;
+
+        for (r = -step; r <= step; r += step)
+            for (c = -step; c <= step; c += step)
+                if (r || c)
+                    check_candidate(hme, sdf, level, x, y, n,
+                                    center.as_mv.row + r,
+                                    center.as_mv.col + c, &best_cost, &best);
+    }
+
+    return best;
+}
+
+/* Refines the motion one level up, returning it in the next finer level's
+ * pels.
+ */
+static int_mv refine(const HME_STATE *hme, vp8_sad_fn_t sdf, int level,
+                     int mb_row, int mb_col, int_mv mv)
+{
+    const int n = 16 >> (level + 1);
+    const int x = mb_col * n, y = mb_row * n;
+    unsigned int best_cost = UINT_MAX;
+    int_mv best, center;
+    int r, c;
+
+    center.as_mv.row = mv.as_mv.row * 2;
+    center.as_mv.col = mv.as_mv.col * 2;
+    best.as_int = 0;
+
+    for (r = -1; r <= 1; r++)
+        for (c = -1; c <= 1; c++)
+            check_candidate(hme, sdf, level, x, y, n,
+                            center.as_mv.row + r, center.as_mv.col + c,
+                            &best_cost, &best);
+
+    /* Clipped at the frame edge: keep the coarse estimate. */
+    if (best_cost == UINT_MAX)
+        best = center;
+
+    best.as_mv.row *= 2;
+    best.as_mv.col *= 2;
+    return best;
+}
+
+void vp8_hme_frame(VP8_COMP *cpi)
+{
+    VP8_COMMON *cm = &cpi->common;
+    HME_STATE *hme = &cpi->hme;
+    const YV12_BUFFER_CONFIG *ref = &cm->yv12_fb[cm->lst_fb_idx];
+    int mb_row, mb_col, i;
+
+    hme->active = 0;
+
+    if (!cpi->sf.hierarchical_me || !hme->buf ||
+        cm->frame_type == KEY_FRAME ||
+        !(cpi->ref_frame_flags & VP8_LAST_FLAG))
+        return;
+
+#if CONFIG_MULTI_RES_ENCODING
+    /* The lower resolution encoder's motion seeds the search instead. */
+    if (cpi->oxcf.mr_encoder_id)
+        return;
+#endif
+
+    downsample_2to1(cpi->Source->y_buffer, cpi->Source->y_stride,
+                    hme->src[0], hme->stride[0],
+                    hme->width[0], hme->height[0]);
+    downsample_2to1(ref->y_buffer, ref->y_stride,
+                    hme->ref[0], hme->stride[0],
+                    hme->width[0], hme->height[0]);
+
+    for (i = 1; i < HME_LEVELS; i++)
+    {
+        downsample_2to1(hme->src[i-1], hme->stride[i-1],
+                        hme->src[i], hme->stride[i],
+                        hme->width[i], hme->height[i]);
+        downsample_2to1(hme->ref[i-1], hme->stride[i-1],
+                        hme->ref[i], hme->stride[i],
+                        hme->width[i], hme->height[i]);
+    }
+
+    for (mb_row = 0; mb_row < cm->mb_rows; mb_row++)
+    {
+        for (mb_col = 0; mb_col < cm->mb_cols; mb_col++)
+        {
+            int_mv mv = search_coarse(hme, cpi->fn_ptr[BLOCK_4X4].sdf,
+                                      mb_row, mb_col, cm->mb_cols);
+
+            mv = refine(hme, cpi->fn_ptr[BLOCK_4X4].sdf, 1, mb_row, mb_col, mv);
+            mv = refine(hme, cpi->fn_ptr[BLOCK_8X8].sdf, 0, mb_row, mb_col, mv);
+
+            hme->mvs[mb_row * cm->mb_cols + mb_col] = mv;
+        }
+    }
+
+    hme->active = 1;
+}
+
+static void clamp_full_mv(int_mv *mv, const MACROBLOCK *x)
+{
+    if (mv->as_mv.col < x->mv_col_min)
+        mv->as_mv.col = x->mv_col_min;
+    if (mv->as_mv.col > x->mv_col_max)
+        mv->as_mv.col = x->mv_col_max;
+    if (mv->as_mv.row < x->mv_row_min)
+        mv->as_mv.row = x->mv_row_min;
+    if (mv->as_mv.row > x->mv_row_max)
+        mv->as_mv.row = x->mv_row_max;
+}
+
+/* Full pel SAD of the MB at mv plus the rate of coding mv, as the full pel
+ * searches count it.
+ */
+static unsigned int seed_cost(VP8_COMP *cpi, MACROBLOCK *x, int_mv *mv,
+                              int_mv *ref_mv, unsigned int max_sad)
+{
+    BLOCK *b = &x->block[0];
+    BLOCKD *d = &x->e_mbd.block[0];
+    const unsigned char *pre = *(d->base_pre) + d->pre +
+                               mv->as_mv.row * d->pre_stride + mv->as_mv.col;
+    int row = mv->as_mv.row - ref_mv->as_mv.row;
+    int col = mv->as_mv.col - ref_mv->as_mv.col;
+
+    row = row < -mvfp_max ? -mvfp_max : row > mvfp_max ? mvfp_max : row;
+    col = col < -mvfp_max ? -mvfp_max : col > mvfp_max ? mvfp_max : col;
+
+    return cpi->fn_ptr[BLOCK_16X16].sdf(*(b->base_src) + b->src,
+                                        b->src_stride, pre, d->pre_stride,
+                                        max_sad) +
+           (((x->mvsadcost[0][row] + x->mvsadcost[1][col]) *
+             x->sadperbit16 + 128) >> 8);
+}
+
+/* Starts the full pel search of the current MB from the pre-pass motion
+ * rather than from the predicted one when it is cheaper. The caller has
+ * already narrowed x->mv_*_min/max to the search window.
+ */
+void vp8_hme_seed(VP8_COMP *cpi, MACROBLOCK *x, int_mv *best_ref_mv,
+                  int_mv *mvp_full, int *step_param)
+{
+    VP8_COMMON *cm = &cpi->common;
+    MACROBLOCKD *xd = &x->e_mbd;
+    int idx, mb_row, mb_col;
+    unsigned int pred_cost, hme_cost;
+    int_mv ref_full, pred, mv;
+
+    if (!cpi->hme.active || xd->mode_info_context->mbmi.ref_frame != LAST_FRAME)
+        return;
+
+    idx = xd->mode_info_context - cm->mi;
+    mb_row = idx / cm->mode_info_stride;
+    mb_col = idx % cm->mode_info_stride;
+
+    mv = cpi->hme.mvs[mb_row * cm->mb_cols + mb_col];
+    clamp_full_mv(&mv, x);
+
+    pred = *mvp_full;
+    clamp_full_mv(&pred, x);
+
+    if (mv.as_int == pred.as_int)
+        return;
+
+    ref_full.as_mv.row = best_ref_mv->as_mv.row >> 3;
+    ref_full.as_mv.col = best_ref_mv->as_mv.col >> 3;
+
+    pred_cost = seed_cost(cpi, x, &pred, &ref_full, INT_MAX);
+    hme_cost = seed_cost(cpi, x, &mv, &ref_full, pred_cost);
+
+    if (hme_cost < pred_cost)
+    {
+        *mvp_full = mv;
+
+        if (*step_param < HME_STEP_PARAM)
+            *step_param = HME_STEP_PARAM;
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#ifndef __INC_HME_H
+#define __INC_HME_H
+
+#include "vp8/common/mv.h"
+#include "block.h"
+
+/* Hierarchical motion estimation: a frame level pre-pass that searches
+ * the last frame on a 2:1, 4:1 and 8:1 downsampled pyramid and leaves a
+ * coarse motion field the per MB full pel searches start from.
+ */
+#define HME_LEVELS 3
+
+typedef struct
+{
+    int active;                         /* field is valid for this frame */
+
+    unsigned char *buf;                 /* backing store of all planes */
+    unsigned char *src[HME_LEVELS];     /* source luma, level 0 is 2:1 */
+    unsigned char *ref[HME_LEVELS];     /* last frame luma */
+    int stride[HME_LEVELS];
+    int width[HME_LEVELS];
+    int height[HME_LEVELS];
+
+    int_mv *mvs;                        /* full pel motion per MB */
+} HME_STATE;
+
+struct VP8_COMP;
+
+int vp8_hme_alloc(HME_STATE *hme, int mb_rows, int mb_cols);
+void vp8_hme_free(HME_STATE *hme);
+
+void vp8_hme_frame(struct VP8_COMP *cpi);
+void vp8_hme_seed(struct VP8_COMP *cpi, MACROBLOCK *x, int_mv *best_ref_mv,
+                  int_mv *mvp_full, int *step_param);
+
+#endif
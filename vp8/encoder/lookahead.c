@@ -107,8 +107,7 @@ vp8_lookahead_push(struct lookahead_ctx *ctx,
 {
     struct lookahead_entry* buf;
     int row, col, active_end;
-    int mb_rows = (src->y_height + 15) >> 4;
-    int mb_cols = (src->y_width + 15) >> 4;
+    int mb_rows, mb_cols;
 
     if(ctx->sz + 1 > ctx->max_sz)
         return 1;
@@ -119,8 +118,15 @@ vp8_lookahead_push(struct lookahead_ctx *ctx,
     // 1. Lookahead queue has has size of 1.
     // 2. Active map is provided.
     // 3. This is not a key frame, golden nor altref frame.
-    if (ctx->max_sz == 1 && active_map && !flags)
+    if (!src)
     {
+        // The frame was written into vp8_lookahead_next_buffer() already.
+    }
+    else if (ctx->max_sz == 1 && active_map && !flags)
+    {
+        mb_rows = (src->y_height + 15) >> 4;
+        mb_cols = (src->y_width + 15) >> 4;
+
         for (row = 0; row < mb_rows; ++row)
         {
             col = 0;
@@ -171,6 +177,15 @@ vp8_lookahead_push(struct lookahead_ctx *ctx,
 }
 
 
+YV12_BUFFER_CONFIG *
+vp8_lookahead_next_buffer(struct lookahead_ctx *ctx)
+{
+    if(ctx->sz + 1 > ctx->max_sz)
+        return NULL;
+    return &ctx->buf[ctx->write_idx].img;
+}
+
+
 struct lookahead_entry*
 vp8_lookahead_pop(struct lookahead_ctx *ctx,
                   int                   drain)
@@ -209,3 +224,16 @@ vp8_lookahead_depth(struct lookahead_ctx *ctx)
 {
     return ctx->sz;
 }
+
+
+size_t
+vp8_lookahead_mem(struct lookahead_ctx *ctx)
+{
+    size_t bytes = sizeof(*ctx) + ctx->max_sz * sizeof(*ctx->buf);
+    unsigned int i;
+
+    for(i=0; i<ctx->max_sz; i++)
+        bytes += ctx->buf[i].img.frame_size;
+
+    return bytes;
+}
@@ -51,7 +51,8 @@ void vp8_lookahead_destroy(struct lookahead_ctx *ctx);
  * only active macroblocks.
  *
  * \param[in] ctx         Pointer to the lookahead context
- * \param[in] src         Pointer to the image to enqueue
+ * \param[in] src         Pointer to the image to enqueue, or NULL if the
+ *                        frame was written to vp8_lookahead_next_buffer()
  * \param[in] ts_start    Timestamp for the start of this frame
  * \param[in] ts_end      Timestamp for the end of this frame
  * \param[in] flags       Flags set on this frame
@@ -66,6 +67,19 @@ vp8_lookahead_push(struct lookahead_ctx *ctx,
                    unsigned char        *active_map);
 
 
+/**\brief Get the buffer the next vp8_lookahead_push() will fill
+ *
+ * Lets a producer write the frame straight into the queue and then push
+ * it with a NULL source, instead of having it copied.
+ *
+ * \param[in] ctx       Pointer to the lookahead context
+ *
+ * \retval NULL, if the queue is full
+ */
+YV12_BUFFER_CONFIG *
+vp8_lookahead_next_buffer(struct lookahead_ctx *ctx);
+
+
 /**\brief Get the next source buffer to encode
  *
  *
@@ -103,4 +117,12 @@ unsigned int
 vp8_lookahead_depth(struct lookahead_ctx *ctx);
 
 
+/**\brief Get the bytes of memory the lookahead queue holds
+ *
+ * \param[in] ctx       Pointer to the lookahead context
+ */
+size_t
+vp8_lookahead_mem(struct lookahead_ctx *ctx);
+
+
 #endif
@@ -15,17 +15,23 @@
 #include "mr_dissim.h"
 #include "vpx_mem/vpx_mem.h"
 #include "rdopt.h"
+#include "vp8/common/findnearmv.h"
 
 void vp8_cal_low_res_mb_cols(VP8_COMP *cpi)
 {
     int low_res_w;
+    int low_res_h;
 
     /* Support arbitrary down-sampling factor */
     unsigned int iw = cpi->oxcf.Width*cpi->oxcf.mr_down_sampling_factor.den
                       + cpi->oxcf.mr_down_sampling_factor.num - 1;
+    unsigned int ih = cpi->oxcf.Height*cpi->oxcf.mr_down_sampling_factor.den
+                      + cpi->oxcf.mr_down_sampling_factor.num - 1;
 
     low_res_w = iw/cpi->oxcf.mr_down_sampling_factor.num;
+    low_res_h = ih/cpi->oxcf.mr_down_sampling_factor.num;
     cpi->mr_low_res_mb_cols = ((low_res_w + 15) >> 4);
+    cpi->mr_low_res_mb_rows = ((low_res_h + 15) >> 4);
 }
 
 #define GET_MV(x)    \
@@ -50,152 +56,325 @@ if(x->mbmi.ref_frame !=INTRA_FRAME)   \
     cnt++;  \
 }
 
-void vp8_cal_dissimilarity(VP8_COMP *cpi)
+/* Store the modes of MB row mb_row for the next resolution and mark the
+ * row as final for this encode call.
+ */
+static void store_mb_row(VP8_COMP *cpi, int mb_row)
 {
     VP8_COMMON *cm = &cpi->common;
+    LOWER_RES_FRAME_INFO *info =
+        (LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info;
+    const int level = cpi->oxcf.mr_encoder_id;
+    int mb_col;
 
     /* Note: The first row & first column in mip are outside the frame, which
      * were initialized to all 0.(ref_frame, mode, mv...)
      * Their ref_frame = 0 means they won't be counted in the following
      * calculation.
      */
-    if (cpi->oxcf.mr_total_resolutions >1
-        && cpi->oxcf.mr_encoder_id < (cpi->oxcf.mr_total_resolutions - 1))
+    MODE_INFO *tmp = cm->mi + mb_row * cm->mode_info_stride;
+    LOWER_RES_INFO* store_mode_info = info->mb_info[level]
+                                      + mb_row * cm->mb_cols;
+
+    for (mb_col = 0; mb_col < cm->mb_cols; mb_col ++)
     {
-        /* Store info for show/no-show frames for supporting alt_ref.
-         * If parent frame is alt_ref, child has one too.
-         */
-        if(cm->frame_type != KEY_FRAME)
+        int dissim = INT_MAX;
+
+        if(tmp->mbmi.ref_frame !=INTRA_FRAME)
         {
-            int mb_row;
-            int mb_col;
-            /* Point to beginning of allocated MODE_INFO arrays. */
-            MODE_INFO *tmp = cm->mip + cm->mode_info_stride;
-            LOWER_RES_INFO* store_mode_info
-                            = (LOWER_RES_INFO*)cpi->oxcf.mr_low_res_mode_info;
-
-            for (mb_row = 0; mb_row < cm->mb_rows; mb_row ++)
+            int              mvx[8];
+            int              mvy[8];
+            int              mmvx;
+            int              mmvy;
+            int              cnt=0;
+            const MODE_INFO *here = tmp;
+            const MODE_INFO *above = here - cm->mode_info_stride;
+            const MODE_INFO *left = here - 1;
+            const MODE_INFO *aboveleft = above - 1;
+            const MODE_INFO *aboveright = NULL;
+            const MODE_INFO *right = NULL;
+            const MODE_INFO *belowleft = NULL;
+            const MODE_INFO *below = NULL;
+            const MODE_INFO *belowright = NULL;
+
+            /* If alternate reference frame is used, we have to
+             * check sign of MV. */
+            if(cpi->oxcf.play_alternate)
+            {
+                /* Gather mv of neighboring MBs */
+                GET_MV_SIGN(above)
+                GET_MV_SIGN(left)
+                GET_MV_SIGN(aboveleft)
+
+                if(mb_col < (cm->mb_cols-1))
+                {
+                    right = here + 1;
+                    aboveright = above + 1;
+                    GET_MV_SIGN(right)
+                    GET_MV_SIGN(aboveright)
+                }
+
+                if(mb_row < (cm->mb_rows-1))
+                {
+                    below = here + cm->mode_info_stride;
+                    belowleft = below - 1;
+                    GET_MV_SIGN(below)
+                    GET_MV_SIGN(belowleft)
+                }
+
+                if(mb_col < (cm->mb_cols-1)
+                    && mb_row < (cm->mb_rows-1))
+                {
+                    belowright = below + 1;
+                    GET_MV_SIGN(belowright)
+                }
+            }else
             {
-                tmp++;
-                for (mb_col = 0; mb_col < cm->mb_cols; mb_col ++)
+                /* No alt_ref and gather mv of neighboring MBs */
+                GET_MV(above)
+                GET_MV(left)
+                GET_MV(aboveleft)
+
+                if(mb_col < (cm->mb_cols-1))
+                {
+                    right = here + 1;
+                    aboveright = above + 1;
+                    GET_MV(right)
+                    GET_MV(aboveright)
+                }
+
+                if(mb_row < (cm->mb_rows-1))
+                {
+                    below = here + cm->mode_info_stride;
+                    belowleft = below - 1;
+                    GET_MV(below)
+                    GET_MV(belowleft)
+                }
+
+                if(mb_col < (cm->mb_cols-1)
+                    && mb_row < (cm->mb_rows-1))
                 {
-                    int dissim = INT_MAX;
+                    belowright = below + 1;
+                    GET_MV(belowright)
+                }
+            }
+
+            if (cnt > 0)
+            {
+                int max_mvx = mvx[0];
+                int min_mvx = mvx[0];
+                int max_mvy = mvy[0];
+                int min_mvy = mvy[0];
+                int i;
 
-                    if(tmp->mbmi.ref_frame !=INTRA_FRAME)
+                if (cnt > 1)
+                {
+                    for (i=1; i< cnt; i++)
                     {
-                        int              mvx[8];
-                        int              mvy[8];
-                        int              mmvx;
-                        int              mmvy;
-                        int              cnt=0;
-                        const MODE_INFO *here = tmp;
-                        const MODE_INFO *above = here - cm->mode_info_stride;
-                        const MODE_INFO *left = here - 1;
-                        const MODE_INFO *aboveleft = above - 1;
-                        const MODE_INFO *aboveright = NULL;
-                        const MODE_INFO *right = NULL;
-                        const MODE_INFO *belowleft = NULL;
-                        const MODE_INFO *below = NULL;
-                        const MODE_INFO *belowright = NULL;
-
-                        /* If alternate reference frame is used, we have to
-                         * check sign of MV. */
-                        if(cpi->oxcf.play_alternate)
-                        {
-                            /* Gather mv of neighboring MBs */
-                            GET_MV_SIGN(above)
-                            GET_MV_SIGN(left)
-                            GET_MV_SIGN(aboveleft)
-
-                            if(mb_col < (cm->mb_cols-1))
-                            {
-                                right = here + 1;
-                                aboveright = above + 1;
-                                GET_MV_SIGN(right)
-                                GET_MV_SIGN(aboveright)
-                            }
-
-                            if(mb_row < (cm->mb_rows-1))
-                            {
-                                below = here + cm->mode_info_stride;
-                                belowleft = below - 1;
-                                GET_MV_SIGN(below)
-                                GET_MV_SIGN(belowleft)
-                            }
-
-                            if(mb_col < (cm->mb_cols-1)
-                                && mb_row < (cm->mb_rows-1))
-                            {
-                                belowright = below + 1;
-                                GET_MV_SIGN(belowright)
-                            }
-                        }else
-                        {
-                            /* No alt_ref and gather mv of neighboring MBs */
-                            GET_MV(above)
-                            GET_MV(left)
-                            GET_MV(aboveleft)
-
-                            if(mb_col < (cm->mb_cols-1))
-                            {
-                                right = here + 1;
-                                aboveright = above + 1;
-                                GET_MV(right)
-                                GET_MV(aboveright)
-                            }
-
-                            if(mb_row < (cm->mb_rows-1))
-                            {
-                                below = here + cm->mode_info_stride;
-                                belowleft = below - 1;
-                                GET_MV(below)
-                                GET_MV(belowleft)
-                            }
-
-                            if(mb_col < (cm->mb_cols-1)
-                                && mb_row < (cm->mb_rows-1))
-                            {
-                                belowright = below + 1;
-                                GET_MV(belowright)
-                            }
-                        }
-
-                        if (cnt > 0)
-                        {
-                            int max_mvx = mvx[0];
-                            int min_mvx = mvx[0];
-                            int max_mvy = mvy[0];
-                            int min_mvy = mvy[0];
-                            int i;
-
-                            if (cnt > 1)
-                            {
-                                for (i=1; i< cnt; i++)
-                                {
-                                    if (mvx[i] > max_mvx) max_mvx = mvx[i];
-                                    else if (mvx[i] < min_mvx) min_mvx = mvx[i];
-                                    if (mvy[i] > max_mvy) max_mvy = mvy[i];
-                                    else if (mvy[i] < min_mvy) min_mvy = mvy[i];
-                                }
-                            }
-
-                            mmvx = MAX(abs(min_mvx - here->mbmi.mv.as_mv.row),
-                                       abs(max_mvx - here->mbmi.mv.as_mv.row));
-                            mmvy = MAX(abs(min_mvy - here->mbmi.mv.as_mv.col),
-                                       abs(max_mvy - here->mbmi.mv.as_mv.col));
-                            dissim = MAX(mmvx, mmvy);
-                        }
+                        if (mvx[i] > max_mvx) max_mvx = mvx[i];
+                        else if (mvx[i] < min_mvx) min_mvx = mvx[i];
+                        if (mvy[i] > max_mvy) max_mvy = mvy[i];
+                        else if (mvy[i] < min_mvy) min_mvy = mvy[i];
                     }
-
-                    /* Store mode info for next resolution encoding */
-                    store_mode_info->mode = tmp->mbmi.mode;
-                    store_mode_info->ref_frame = tmp->mbmi.ref_frame;
-                    store_mode_info->mv.as_int = tmp->mbmi.mv.as_int;
-                    store_mode_info->dissim = dissim;
-                    tmp++;
-                    store_mode_info++;
                 }
+
+                mmvx = MAX(abs(min_mvx - here->mbmi.mv.as_mv.row),
+                           abs(max_mvx - here->mbmi.mv.as_mv.row));
+                mmvy = MAX(abs(min_mvy - here->mbmi.mv.as_mv.col),
+                           abs(max_mvy - here->mbmi.mv.as_mv.col));
+                dissim = MAX(mmvx, mmvy);
             }
         }
+
+        /* Store mode info for next resolution encoding */
+        store_mode_info->mode = tmp->mbmi.mode;
+        store_mode_info->ref_frame = tmp->mbmi.ref_frame;
+        store_mode_info->mv.as_int = tmp->mbmi.mv.as_int;
+        store_mode_info->skip = tmp->mbmi.mb_skip_coeff;
+        store_mode_info->dissim = dissim;
+        tmp++;
+        store_mode_info++;
+    }
+
+    vp8_atomic_store_release(&info->row_seq[level][mb_row], cpi->mr_seq);
+}
+
+static int stores_mode_info(VP8_COMP *cpi)
+{
+    return cpi->oxcf.mr_total_resolutions > 1
+           && cpi->oxcf.mr_encoder_id < (cpi->oxcf.mr_total_resolutions - 1);
+}
+
+void vp8_mr_row_coded(VP8_COMP *cpi, int mb_row)
+{
+    /* The dissimilarity of a MB looks at the row below it, so a row is
+     * final once the next one is coded. The rows above are complete by
+     * then, in the multi-threaded encoder too.
+     */
+    if (!cpi->mr_store_rows)
+        return;
+
+    if (mb_row > 0)
+        store_mb_row(cpi, mb_row - 1);
+
+    if (mb_row == cpi->common.mb_rows - 1)
+    {
+        store_mb_row(cpi, mb_row);
+
+#if CONFIG_MULTITHREAD
+        /* Other threads may still be storing the rows before; they have to
+         * be done before the frame is signalled complete.
+         */
+        if (cpi->b_multi_threaded)
+        {
+            LOWER_RES_FRAME_INFO *info =
+                (LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info;
+            const int *row_seq = info->row_seq[cpi->oxcf.mr_encoder_id];
+            int i;
+
+            for (i = 0; i < mb_row; i++)
+                while (vp8_atomic_load_acquire(&row_seq[i]) != cpi->mr_seq)
+                    thread_sleep(0);
+        }
+#endif
+    }
+}
+
+void vp8_cal_dissimilarity(VP8_COMP *cpi)
+{
+    VP8_COMMON *cm = &cpi->common;
+
+    /* Store info for show/no-show frames for supporting alt_ref.
+     * If parent frame is alt_ref, child has one too.
+     */
+    if (stores_mode_info(cpi) && cm->frame_type != KEY_FRAME
+        && !cpi->mr_store_rows)
+    {
+        int mb_row;
+
+        for (mb_row = 0; mb_row < cm->mb_rows; mb_row ++)
+            store_mb_row(cpi, mb_row);
+    }
+
+    cpi->mr_store_rows = 0;
+}
+
+void vp8_mr_frame_init(VP8_COMP *cpi)
+{
+    VP8_COMMON *cm = &cpi->common;
+
+    /* Rows can only be handed out while they are coded when this coding
+     * pass is certain to be the frame's last: no key frame decision or
+     * recode loop may send it back.
+     */
+    cpi->mr_store_rows = stores_mode_info(cpi)
+                         && cm->frame_type != KEY_FRAME
+                         && cpi->compressor_speed == 2
+                         && (cpi->sf.recode_loop == 0
+                             || (cpi->sf.recode_loop == 2
+                                 && !cm->refresh_golden_frame
+                                 && !cm->refresh_alt_ref_frame));
+}
+
+/* The lower resolution's decision for the MB co-located with (mb_row,
+ * mb_col): its reference frame (INTRA_FRAME if intra coded), mode, MV
+ * scaled to this resolution, whether it had no residual, and the
+ * dissimilarity of its neighbourhood's motion, which is small when the
+ * decision is reliable.
+ */
+void vp8_mr_get_lower_res_info(VP8_COMP *cpi, MACROBLOCKD *xd,
+                               int mb_row, int mb_col, int *dissim,
+                               int *parent_ref_frame,
+                               MB_PREDICTION_MODE *parent_mode,
+                               int_mv *parent_ref_mv, int *parent_skip)
+{
+    const LOWER_RES_FRAME_INFO *info =
+        (const LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info;
+    LOWER_RES_INFO* store_mode_info =
+        info->mb_info[cpi->oxcf.mr_encoder_id - 1];
+    unsigned int parent_mb_index;
+
+    /* Consider different down_sampling_factor.  */
+    {
+        int round = cpi->oxcf.mr_down_sampling_factor.num/2;
+        int parent_mb_row, parent_mb_col;
+
+        parent_mb_row = (mb_row*cpi->oxcf.mr_down_sampling_factor.den+round)
+                    /cpi->oxcf.mr_down_sampling_factor.num;
+        parent_mb_col = (mb_col*cpi->oxcf.mr_down_sampling_factor.den+round)
+                    /cpi->oxcf.mr_down_sampling_factor.num;
+
+        /* Rounding can step past the last row or column of the lower
+         * resolution.
+         */
+        if (parent_mb_row >= cpi->mr_low_res_mb_rows)
+            parent_mb_row = cpi->mr_low_res_mb_rows - 1;
+        if (parent_mb_col >= cpi->mr_low_res_mb_cols)
+            parent_mb_col = cpi->mr_low_res_mb_cols - 1;
+
+        parent_mb_index = parent_mb_row*cpi->mr_low_res_mb_cols + parent_mb_col;
+
+#if CONFIG_MULTITHREAD
+        /* The lower resolution may still be coding this frame. */
+        vp8_mr_wait_for_row(cpi, parent_mb_row);
+#endif
+    }
+
+    /* Read lower-resolution mode & motion result from memory.*/
+    *parent_ref_frame = store_mode_info[parent_mb_index].ref_frame;
+    *parent_mode =  store_mode_info[parent_mb_index].mode;
+    *parent_skip = store_mode_info[parent_mb_index].skip;
+    *dissim = store_mode_info[parent_mb_index].dissim;
+
+    /* For highest-resolution encoder, adjust dissim value. Lower its quality
+     * for good performance. */
+    if (cpi->oxcf.mr_encoder_id == (cpi->oxcf.mr_total_resolutions - 1))
+        *dissim>>=1;
+
+    if(*parent_ref_frame != INTRA_FRAME)
+    {
+        /* Consider different down_sampling_factor.
+         * The result can be rounded to be more precise, but it takes more time.
+         */
+        (*parent_ref_mv).as_mv.row = store_mode_info[parent_mb_index].mv.as_mv.row
+                                  *cpi->oxcf.mr_down_sampling_factor.num
+                                  /cpi->oxcf.mr_down_sampling_factor.den;
+        (*parent_ref_mv).as_mv.col = store_mode_info[parent_mb_index].mv.as_mv.col
+                                  *cpi->oxcf.mr_down_sampling_factor.num
+                                  /cpi->oxcf.mr_down_sampling_factor.den;
+
+        vp8_clamp_mv2(parent_ref_mv, xd);
+    }
+}
+
+/* Search steps to drop when starting from the lower resolution's MV: the
+ * more its neighbourhood agrees on the motion, the closer the MV is taken
+ * to be.
+ */
+int vp8_mr_step_adjust(int dissim)
+{
+    if (dissim <= 32)
+        return 3;
+    else if (dissim <= 128)
+        return 2;
+    else
+        return 1;
+}
+
+#if CONFIG_MULTITHREAD
+void vp8_mr_wait_for_row(VP8_COMP *cpi, int parent_mb_row)
+{
+    const LOWER_RES_FRAME_INFO *info =
+        (const LOWER_RES_FRAME_INFO *)cpi->oxcf.mr_low_res_mode_info;
+    const int level = cpi->oxcf.mr_encoder_id - 1;
+    const int *row_seq = info->row_seq[level];
+    const int seq = cpi->mr_seq;
+
+    while (vp8_atomic_load_acquire(&row_seq[parent_mb_row]) != seq
+           && vp8_atomic_load_acquire(&info->done_seq[level]) != seq)
+    {
+        x86_pause_hint();
+        thread_sleep(0);
     }
 }
+#endif
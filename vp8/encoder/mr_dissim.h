@@ -15,5 +15,16 @@
 
 extern void vp8_cal_low_res_mb_cols(VP8_COMP *cpi);
 extern void vp8_cal_dissimilarity(VP8_COMP *cpi);
+extern void vp8_mr_frame_init(VP8_COMP *cpi);
+extern void vp8_mr_row_coded(VP8_COMP *cpi, int mb_row);
+extern void vp8_mr_get_lower_res_info(VP8_COMP *cpi, MACROBLOCKD *xd,
+                                      int mb_row, int mb_col, int *dissim,
+                                      int *parent_ref_frame,
+                                      MB_PREDICTION_MODE *parent_mode,
+                                      int_mv *parent_ref_mv, int *parent_skip);
+extern int vp8_mr_step_adjust(int dissim);
+#if CONFIG_MULTITHREAD
+extern void vp8_mr_wait_for_row(VP8_COMP *cpi, int parent_mb_row);
+#endif
 
 #endif
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include "vpx_config.h"
+#include "onyx_int.h"
+#include "mr_scale.h"
+#include "vp8/common/extend.h"
+#include "vpx_mem/vpx_mem.h"
+
+/* Area averaging: on a grid of in * out units per dimension, source pixel
+ * i covers [i * out, (i + 1) * out) and destination pixel j covers
+ * [j * in, (j + 1) * in); each destination pixel is the average of the
+ * source pixels it covers, weighted by the overlap. This works for any
+ * down-sampling factor, and for the usual 2:1 it is a 2x2 box filter.
+ */
+
+/* One source row to out_w averages in 8.8 fixed point. */
+static void scale_row(const unsigned char *src, int in_w,
+                      unsigned int *dst, int out_w)
+{
+    unsigned int pos = 0;
+    int i = 0;
+    int j;
+
+    for (j = 0; j < out_w; j++)
+    {
+        const unsigned int end = (j + 1) * in_w;
+        unsigned int sum = 0;
+
+        while (pos < end)
+        {
+            const unsigned int next = (i + 1) * out_w;
+            const unsigned int stop = next < end ? next : end;
+
+            sum += src[i] * (stop - pos);
+            pos = stop;
+
+            if (pos == next)
+                i++;
+        }
+
+        dst[j] = ((sum << 8) + (in_w >> 1)) / in_w;
+    }
+}
+
+/* The destination is produced a row at a time: the source rows it covers
+ * are scaled horizontally into row and accumulated into acc, so besides
+ * the streamed source only two rows of out_w words are live.
+ */
+static void scale_plane(const unsigned char *src, int src_stride,
+                        int in_w, int in_h,
+                        unsigned char *dst, int dst_stride,
+                        int out_w, int out_h,
+                        unsigned int *row, unsigned int *acc)
+{
+    const unsigned int div = in_h << 8;
+    unsigned int pos = 0;
+    int row_src = -1;
+    int i = 0;
+    int x, y;
+
+    for (y = 0; y < out_h; y++)
+    {
+        const unsigned int end = (y + 1) * in_h;
+
+        vpx_memset(acc, 0, out_w * sizeof(*acc));
+
+        while (pos < end)
+        {
+            const unsigned int next = (i + 1) * out_h;
+            const unsigned int stop = next < end ? next : end;
+            const unsigned int w = stop - pos;
+
+            /* A source row straddling two destination rows is scaled
+             * once. */
+            if (row_src != i)
+            {
+                scale_row(src + i * src_stride, in_w, row, out_w);
+                row_src = i;
+            }
+
+            for (x = 0; x < out_w; x++)
+                acc[x] += row[x] * w;
+
+            pos = stop;
+
+            if (pos == next)
+                i++;
+        }
+
+        for (x = 0; x < out_w; x++)
+            dst[x] = (acc[x] + (div >> 1)) / div;
+
+        dst += dst_stride;
+    }
+}
+
+void vp8_mr_scale_frame(VP8_COMP *cpi, YV12_BUFFER_CONFIG *src,
+                        YV12_BUFFER_CONFIG *dst)
+{
+    const int width = cpi->oxcf.Width;
+    const int height = cpi->oxcf.Height;
+    const int uv_width = (width + 1) / 2;
+    const int uv_height = (height + 1) / 2;
+    unsigned int *row = cpi->mr_scale_buf;
+    unsigned int *acc = row + dst->y_width;
+
+    scale_plane(src->y_buffer, src->y_stride, src->y_width, src->y_height,
+                dst->y_buffer, dst->y_stride, width, height, row, acc);
+    scale_plane(src->u_buffer, src->uv_stride, src->uv_width, src->uv_height,
+                dst->u_buffer, dst->uv_stride, uv_width, uv_height, row, acc);
+    scale_plane(src->v_buffer, src->uv_stride, src->uv_width, src->uv_height,
+                dst->v_buffer, dst->uv_stride, uv_width, uv_height, row, acc);
+
+    vp8_extend_frame_in_place(dst, width, height);
+}
@@ -0,0 +1,24 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#ifndef __INC_MR_SCALE_H
+#define __INC_MR_SCALE_H
+#include "vpx_config.h"
+#include "vpx_scale/yv12config.h"
+
+/* Scale the highest resolution's frame src down to the size of this
+ * level into dst, and extend dst's borders. dst is the encoder's next
+ * lookahead buffer, so the frame is not copied again.
+ */
+extern void vp8_mr_scale_frame(VP8_COMP *cpi, YV12_BUFFER_CONFIG *src,
+                               YV12_BUFFER_CONFIG *dst);
+
+#endif
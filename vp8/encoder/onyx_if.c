@@ -36,6 +36,7 @@
 #endif
 #if CONFIG_MULTI_RES_ENCODING
 #include "mr_dissim.h"
+#include "mr_scale.h"
 #endif
 
 #include <math.h>
@@ -52,6 +53,8 @@ extern unsigned int vp8_get_processor_freq();
 extern void print_tree_update_probs();
 extern void vp8cx_create_encoder_threads(VP8_COMP *cpi);
 extern void vp8cx_remove_encoder_threads(VP8_COMP *cpi);
+extern void vp8cx_alloc_lpf_search_frames(VP8_COMP *cpi);
+extern void vp8cx_resize_frame_mt(VP8_COMP *cpi, YV12_BUFFER_CONFIG *src);
 #if HAVE_NEON
 extern void vp8_yv12_copy_frame_func_neon(YV12_BUFFER_CONFIG *src_ybc, YV12_BUFFER_CONFIG *dst_ybc);
 extern void vp8_yv12_copy_src_frame_func_neon(YV12_BUFFER_CONFIG *src_ybc, YV12_BUFFER_CONFIG *dst_ybc);
@@ -206,6 +209,12 @@ static const int inter_minq[QINDEX_RANGE] =
     86,86,87,88,89,90,91,92,93,94,95,96,97,98,99,100
 };
 
+// Starting slopes of the SATD rate model, from typical 640x360 content.
+static const int satd_rate_k_prior[QINDEX_RANGE >> SATD_RATE_Q_SHIFT] =
+{
+    240, 180, 130, 100, 75, 60, 50, 40
+};
+
 void vp8_initialize()
 {
     static int init_done = 0;
@@ -369,6 +378,17 @@ static void dealloc_compressor_data(VP8_COMP *cpi)
 
     vpx_free(cpi->mb.pip);
     cpi->mb.pip = 0;
+
+    vpx_free(cpi->mode_history);
+    cpi->mode_history = 0;
+
+    vp8_hme_free(&cpi->hme);
+    vp8_resize_free(&cpi->resize);
+
+#if CONFIG_MULTI_RES_ENCODING
+    vpx_free(cpi->mr_scale_buf);
+    cpi->mr_scale_buf = 0;
+#endif
 }
 
 static void enable_segmentation(VP8_COMP *cpi)
@@ -704,6 +724,10 @@ void vp8_set_speed_features(VP8_COMP *cpi)
     sf->first_step = 0;
     sf->max_step_search_steps = MAX_MVSEARCH_STEPS;
     sf->improved_mv_pred = 1;
+    sf->hierarchical_me = 0;
+    sf->mode_history = 0;
+    sf->satd_pick = 0;
+    sf->fast_coef_costing = 0;
 
     // default thresholds to 0
     for (i = 0; i < MAX_MODES; i++)
@@ -795,14 +819,18 @@ void vp8_set_speed_features(VP8_COMP *cpi)
     case 3:
         if (Speed > 0)
         {
-            /* Disable coefficient optimization above speed 0 */
-            sf->optimize_coefficients = 0;
+            /* Only the fast trellis at speed 1, none above */
+            sf->optimize_coefficients = Speed > 1 ? 0 : 2;
             sf->use_fastquant_for_pick = 1;
             sf->no_skip_block4x4_search = 0;
+            sf->mode_history = 1;
 
             sf->first_step = 1;
         }
 
+        if (Speed > 1)
+            sf->fast_coef_costing = 1;
+
         if (Speed > 2)
         {
             sf->improved_quant = 0;
@@ -820,11 +848,16 @@ void vp8_set_speed_features(VP8_COMP *cpi)
             sf->recode_loop = 0; // recode loop off
             sf->RD = 0;         // Turn rd off
 
+            // Between full RD and the plain SAD/variance picker: rank the
+            // candidates by SATD with a learnt coefficient rate
+            sf->satd_pick = 1;
+
         }
 
         if (Speed > 4)
         {
             sf->auto_filter = 0;                     // Faster selection of loop filter
+            sf->satd_pick = 0;
         }
 
         break;
@@ -843,9 +876,13 @@ void vp8_set_speed_features(VP8_COMP *cpi)
 
             sf->use_fastquant_for_pick = 1;
             sf->no_skip_block4x4_search = 0;
+            sf->mode_history = 1;
             sf->first_step = 1;
         }
 
+        if (Speed > 1)
+            sf->fast_coef_costing = 1;
+
         if (Speed > 2)
             sf->auto_filter = 0;                     // Faster selection of loop filter
 
@@ -860,6 +897,9 @@ void vp8_set_speed_features(VP8_COMP *cpi)
             sf->auto_filter = 0;                     // Faster selection of loop filter
             sf->search_method = HEX;
             sf->iterative_sub_pixel = 0;
+
+            // Seed the short hex searches with a coarse motion field
+            sf->hierarchical_me = 1;
         }
 
         if (Speed > 6)
@@ -1008,11 +1048,13 @@ void vp8_set_speed_features(VP8_COMP *cpi)
         cpi->find_fractional_mv_step = vp8_skip_fractional_mv_step;
     }
 
-    if (cpi->sf.optimize_coefficients == 1 && cpi->pass!=1)
-        cpi->mb.optimize = 1;
+    if (cpi->pass!=1)
+        cpi->mb.optimize = cpi->sf.optimize_coefficients;
     else
         cpi->mb.optimize = 0;
 
+    cpi->mb.fast_coef_costing = cpi->sf.fast_coef_costing;
+
     if (cpi->common.full_pixel)
         cpi->find_fractional_mv_step = vp8_skip_fractional_mv_step;
 
@@ -1042,30 +1084,50 @@ static void alloc_raw_frame_buffers(VP8_COMP *cpi)
                            "Failed to allocate altref buffer");
 
 #endif
+#if CONFIG_MULTI_RES_ENCODING
+    // Two rows of the down-scaler, which writes the lookahead buffers of
+    // the lower resolutions. They are as wide as the input, whatever size
+    // spatial resampling codes the frames at.
+    vpx_free(cpi->mr_scale_buf);
+    cpi->mr_scale_buf = 0;
+
+    if (cpi->oxcf.mr_encoder_id + 1 < cpi->oxcf.mr_total_resolutions)
+        CHECK_MEM_ERROR(cpi->mr_scale_buf,
+                        vpx_malloc(2 * width * sizeof(*cpi->mr_scale_buf)));
+#endif
 }
 
 static int vp8_alloc_partition_data(VP8_COMP *cpi)
 {
-        vpx_free(cpi->mb.pip);
+    vpx_arena_t *arena = &cpi->common.arena;
 
-    cpi->mb.pip = vpx_calloc((cpi->common.mb_cols + 1) *
-                                (cpi->common.mb_rows + 1),
-                                sizeof(PARTITION_INFO));
+    cpi->mb.pip = vpx_arena_calloc(arena, (cpi->common.mb_cols + 1) *
+                                   (cpi->common.mb_rows + 1),
+                                   sizeof(PARTITION_INFO));
     if(!cpi->mb.pip)
         return 1;
 
     cpi->mb.pi = cpi->mb.pip + cpi->common.mode_info_stride + 1;
 
+    cpi->mode_history = vpx_arena_calloc(arena, (cpi->common.mb_cols + 1) *
+                                         (cpi->common.mb_rows + 1),
+                                         sizeof(MB_MODE_HISTORY));
+    if(!cpi->mode_history)
+        return 1;
+
     return 0;
 }
 
 void vp8_alloc_compressor_data(VP8_COMP *cpi)
 {
     VP8_COMMON *cm = & cpi->common;
+    vpx_arena_t *arena = &cm->arena;
 
     int width = cm->Width;
     int height = cm->Height;
 
+    // The MB sized tables are allocated from cm->arena, which
+    // vp8_alloc_frame_buffers() empties.
     if (vp8_alloc_frame_buffers(cm, width, height))
         vpx_internal_error(&cpi->common.error, VPX_CODEC_MEM_ERROR,
                            "Failed to allocate frame buffers");
@@ -1087,18 +1149,22 @@ void vp8_alloc_compressor_data(VP8_COMP *cpi)
         vpx_internal_error(&cpi->common.error, VPX_CODEC_MEM_ERROR,
                            "Failed to allocate last frame buffer");
 
+#if CONFIG_MULTITHREAD
+    if (cpi->b_multi_threaded)
+        vp8cx_alloc_lpf_search_frames(cpi);
+#endif
+
     if (vp8_yv12_alloc_frame_buffer(&cpi->scaled_source,
                                     width, height, VP8BORDERINPIXELS))
         vpx_internal_error(&cpi->common.error, VPX_CODEC_MEM_ERROR,
                            "Failed to allocate scaled source buffer");
 
 
-        vpx_free(cpi->tok);
-
     {
         unsigned int tokens = cm->mb_rows * cm->mb_cols * 24 * 16;
 
-        CHECK_MEM_ERROR(cpi->tok, vpx_calloc(tokens, sizeof(*cpi->tok)));
+        CHECK_MEM_ERROR(cpi->tok, vpx_arena_calloc(arena, tokens, sizeof(*cpi->tok)));
+        cpi->tok_size = tokens;
     }
 
     // Data used for real time vc mode to see if gf needs refreshing
@@ -1108,35 +1174,35 @@ void vp8_alloc_compressor_data(VP8_COMP *cpi)
 
 
     // Structures used to minitor GF usage
-    vpx_free(cpi->gf_active_flags);
     CHECK_MEM_ERROR(cpi->gf_active_flags,
-                    vpx_calloc(1, cm->mb_rows * cm->mb_cols));
+                    vpx_arena_calloc(arena, 1, cm->mb_rows * cm->mb_cols));
     cpi->gf_active_count = cm->mb_rows * cm->mb_cols;
 
-    vpx_free(cpi->mb_activity_map);
     CHECK_MEM_ERROR(cpi->mb_activity_map,
-                    vpx_calloc(sizeof(unsigned int),
+                    vpx_arena_calloc(arena, sizeof(unsigned int),
                     cm->mb_rows * cm->mb_cols));
 
-    vpx_free(cpi->mb_norm_activity_map);
     CHECK_MEM_ERROR(cpi->mb_norm_activity_map,
-                    vpx_calloc(sizeof(unsigned int),
+                    vpx_arena_calloc(arena, sizeof(unsigned int),
                     cm->mb_rows * cm->mb_cols));
 
 #if CONFIG_MULTITHREAD
+    /* Starting sync step; adapted per frame from the measured stalls. */
     if (width < 640)
-        cpi->mt_sync_range = 1;
+        vp8_mt_sync_init(&cpi->mt_sync, cm->mb_cols, 1);
     else if (width <= 1280)
-        cpi->mt_sync_range = 4;
+        vp8_mt_sync_init(&cpi->mt_sync, cm->mb_cols, 4);
     else if (width <= 2560)
-        cpi->mt_sync_range = 8;
+        vp8_mt_sync_init(&cpi->mt_sync, cm->mb_cols, 8);
     else
-        cpi->mt_sync_range = 16;
+        vp8_mt_sync_init(&cpi->mt_sync, cm->mb_cols, 16);
 #endif
 
-    vpx_free(cpi->tplist);
+    CHECK_MEM_ERROR(cpi->tplist, vpx_arena_malloc(arena, sizeof(TOKENLIST) * cpi->common.mb_rows));
 
-    CHECK_MEM_ERROR(cpi->tplist, vpx_malloc(sizeof(TOKENLIST) * cpi->common.mb_rows));
+    if (vp8_hme_alloc(&cpi->hme, cm->mb_rows, cm->mb_cols))
+        vpx_internal_error(&cpi->common.error, VPX_CODEC_MEM_ERROR,
+                           "Failed to allocate motion pyramid");
 }
 
 
@@ -1384,6 +1450,20 @@ void update_layer_contexts (VP8_COMP *cpi)
     }
 }
 
+// The loop filter thread finishes a frame while the main thread returns it
+// and starts on the next one. Anything that reads the reconstruction, or
+// changes what the filter reads, has to wait for it first.
+static void wait_for_loopfilter(VP8_COMP *cpi)
+{
+#if CONFIG_MULTITHREAD
+    if (cpi->b_lpf_running)
+    {
+        sem_wait(&cpi->h_event_end_lpf);
+        cpi->b_lpf_running = 0;
+    }
+#endif
+}
+
 void vp8_change_config(VP8_COMP *cpi, VP8_CONFIG *oxcf)
 {
     VP8_COMMON *cm = &cpi->common;
@@ -1394,6 +1474,8 @@ void vp8_change_config(VP8_COMP *cpi, VP8_CONFIG *oxcf)
     if (!oxcf)
         return;
 
+    wait_for_loopfilter(cpi);
+
     if (cm->version != oxcf->Version)
     {
         cm->version = oxcf->Version;
@@ -1402,6 +1484,10 @@ void vp8_change_config(VP8_COMP *cpi, VP8_CONFIG *oxcf)
 
     cpi->oxcf = *oxcf;
 
+    if (oxcf->rt_deadline_percentile >= 50 &&
+        oxcf->rt_deadline_percentile <= 100)
+        cpi->speed_ctrl.percentile = oxcf->rt_deadline_percentile;
+
     switch (cpi->oxcf.Mode)
     {
 
@@ -1908,10 +1994,12 @@ struct VP8_COMP* vp8_create_compressor(VP8_CONFIG *oxcf)
     if (cpi->compressor_speed == 2)
     {
         cpi->cpu_freq            = 0; //vp8_get_processor_freq();
-        cpi->avg_encode_time      = 0;
-        cpi->avg_pick_mode_time    = 0;
     }
 
+    vp8_speed_ctrl_init(&cpi->speed_ctrl, cpi->oxcf.rt_deadline_percentile);
+
+    vpx_memcpy(cpi->satd_rate_k, satd_rate_k_prior, sizeof(satd_rate_k_prior));
+
     vp8_set_speed_features(cpi);
 
     // Set starting values of RD threshold multipliers (128 = *1)
@@ -2281,6 +2369,7 @@ void vp8_remove_compressor(VP8_COMP **ptr)
     }
 
 #if CONFIG_MULTITHREAD
+    wait_for_loopfilter(cpi);
     vp8cx_remove_encoder_threads(cpi);
 #endif
 
@@ -2464,6 +2553,7 @@ int vp8_get_reference(VP8_COMP *cpi, VP8_REFFRAME ref_frame_flag, YV12_BUFFER_CO
     else
         return -1;
 
+    wait_for_loopfilter(cpi);
     vp8_yv12_copy_frame_ptr(&cm->yv12_fb[ref_fb_idx], sd);
 
     return 0;
@@ -2483,6 +2573,7 @@ int vp8_set_reference(VP8_COMP *cpi, VP8_REFFRAME ref_frame_flag, YV12_BUFFER_CO
     else
         return -1;
 
+    wait_for_loopfilter(cpi);
     vp8_yv12_copy_frame_ptr(sd, &cm->yv12_fb[ref_fb_idx]);
 
     return 0;
@@ -2543,22 +2634,25 @@ static void scale_and_extend_source(YV12_BUFFER_CONFIG *sd, VP8_COMP *cpi)
     if (cm->horiz_scale != 0 || cm->vert_scale != 0)
     {
 #if CONFIG_SPATIAL_RESAMPLING
-        int UNINITIALIZED_IS_SAFE(hr), UNINITIALIZED_IS_SAFE(hs);
-        int UNINITIALIZED_IS_SAFE(vr), UNINITIALIZED_IS_SAFE(vs);
-        int tmp_height;
+        if (vp8_resize_init(&cpi->resize, cpi->oxcf.Width, cpi->oxcf.Height,
+                            cm->Width, cm->Height,
+                            cpi->encoding_thread_count + 1))
+            vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                               "Failed to allocate resize filters");
 
-        if (cm->vert_scale == 3)
-            tmp_height = 9;
+#if CONFIG_MULTITHREAD
+        if (cpi->b_multi_threaded)
+            vp8cx_resize_frame_mt(cpi, sd);
         else
-            tmp_height = 11;
-
-        Scale2Ratio(cm->horiz_scale, &hr, &hs);
-        Scale2Ratio(cm->vert_scale, &vr, &vs);
+#endif
+        {
+            int band;
 
-        vp8_scale_frame(sd, &cpi->scaled_source, cm->temp_scale_frame.y_buffer,
-                        tmp_height, hs, hr, vs, vr, 0);
+            for (band = 0; band < vp8_resize_bands(&cpi->resize); band++)
+                vp8_resize_band(&cpi->resize, sd, &cpi->scaled_source, band, 0);
+        }
 
-        vp8_yv12_extend_frame_borders(&cpi->scaled_source);
+        vp8_extend_frame_in_place(&cpi->scaled_source, cm->Width, cm->Height);
         cpi->Source = &cpi->scaled_source;
 #endif
     }
@@ -3068,8 +3162,31 @@ void update_reference_frames(VP8_COMMON *cm)
     }
 }
 
+// Fit the SATD rate model to the frame just packed: everything after the
+// first partition is coefficient tokens. Each band of quantizers has its
+// own slope, as the share of coefficients that quantize to zero changes.
+static void update_satd_rate_model(VP8_COMP *cpi, unsigned long size)
+{
+    VP8_COMMON *cm = &cpi->common;
+    int64_t token_bits = ((int64_t)size - cpi->partition_sz[0]) << 3;
+    int64_t satd = cpi->mb.satd_sum;
+    int *rate_k = &cpi->satd_rate_k[cm->base_qindex >> SATD_RATE_Q_SHIFT];
+    int k;
+
+    if (cm->frame_type == KEY_FRAME || satd <= 0 || token_bits <= 0)
+        return;
+
+    k = (int)((token_bits * 256 * cm->Y1dequant[cm->base_qindex][1]) / satd);
+
+    *rate_k = (3 * *rate_k + k + 2) >> 2;
+}
+
 void loopfilter_frame(VP8_COMP *cpi, VP8_COMMON *cm)
 {
+    // The main thread may move on to the next frame once filter_level is
+    // set, so take the frame type now.
+    const int frame_type = cm->frame_type;
+
     if (cm->no_lpf)
     {
         cm->filter_level = 0;
@@ -3099,7 +3216,7 @@ void loopfilter_frame(VP8_COMP *cpi, VP8_COMMON *cm)
     if (cm->filter_level > 0)
     {
         vp8cx_set_alt_lf_level(cpi, cm->filter_level);
-        vp8_loop_filter_frame(cm, &cpi->mb.e_mbd);
+        vp8_loop_filter_frame(cm, &cpi->mb.e_mbd, frame_type);
     }
 
     vp8_yv12_extend_frame_borders_ptr(cm->frame_to_show);
@@ -3704,6 +3821,10 @@ static void encode_frame_to_data_rate
             vp8_setup_key_frame(cpi);
         }
 
+#if CONFIG_MULTI_RES_ENCODING
+        vp8_mr_frame_init(cpi);
+#endif
+
         // transform / motion compensation build reconstruction frame
         vp8_encode_frame(cpi);
 
@@ -4062,6 +4183,7 @@ static void encode_frame_to_data_rate
     if (cpi->b_multi_threaded)
     {
         sem_post(&cpi->h_event_start_lpf); /* start loopfilter in separate thread */
+        cpi->b_lpf_running = 1;
     }
     else
 #endif
@@ -4085,13 +4207,13 @@ static void encode_frame_to_data_rate
     // build the bitstream
     vp8_pack_bitstream(cpi, dest, dest_end, size);
 
-#if CONFIG_MULTITHREAD
-    /* wait for loopfilter thread done */
-    if (cpi->b_multi_threaded)
-    {
-        sem_wait(&cpi->h_event_end_lpf);
-    }
-#endif
+    if (cpi->sf.satd_pick)
+        update_satd_rate_model(cpi, *size);
+
+    /* The loop filter thread is left to finish this frame while the rest
+     * of it is accounted for and the next one is read in and, for an ARF,
+     * temporally filtered. See wait_for_loopfilter().
+     */
 
     /* Move storing frame_type out of the above loop since it is also
      * needed in motion search besides loopfilter */
@@ -4569,6 +4691,35 @@ int vp8_receive_raw_frame(VP8_COMP *cpi, unsigned int frame_flags, YV12_BUFFER_C
     return res;
 }
 
+#if CONFIG_MULTI_RES_ENCODING
+/* Like vp8_receive_raw_frame(), but sd is the highest resolution's frame
+ * and is scaled down to this level straight into the lookahead buffer.
+ */
+int vp8_receive_scaled_raw_frame(VP8_COMP *cpi, unsigned int frame_flags, YV12_BUFFER_CONFIG *sd, int64_t time_stamp, int64_t end_time)
+{
+    VP8_COMMON            *cm = &cpi->common;
+    struct vpx_usec_timer  timer;
+    YV12_BUFFER_CONFIG    *dst;
+    int                    res = -1;
+
+    vpx_usec_timer_start(&timer);
+    dst = vp8_lookahead_next_buffer(cpi->lookahead);
+
+    if (dst)
+    {
+        vp8_mr_scale_frame(cpi, sd, dst);
+        res = vp8_lookahead_push(cpi->lookahead, NULL, time_stamp, end_time,
+                                 frame_flags, NULL) ? -1 : 0;
+    }
+
+    cm->clr_type = sd->clrtype;
+    vpx_usec_timer_mark(&timer);
+    cpi->time_receive_data += vpx_usec_timer_elapsed(&timer);
+
+    return res;
+}
+#endif
+
 
 static int frame_is_reference(const VP8_COMP *cpi)
 {
@@ -4584,6 +4735,56 @@ static int frame_is_reference(const VP8_COMP *cpi)
 }
 
 
+// Adds the memory the encoder instance holds to bytes, see vp8_mem_usage().
+static void mem_usage(VP8_COMP *cpi, size_t bytes[MEM_KINDS])
+{
+    VP8_COMMON *const cm = &cpi->common;
+    const size_t mbs = cm->mb_rows * cm->mb_cols;
+    const size_t bordered_mbs = (cm->mb_rows + 2) * (cm->mb_cols + 2);
+
+    vp8_mem_usage(cm, bytes);
+
+    vp8_mem_frame(bytes, MEM_FRAMES, &cpi->pick_lf_lvl_frame);
+    vp8_mem_frame(bytes, MEM_FRAMES, &cpi->scaled_source);
+#if VP8_TEMPORAL_ALT_REF
+    vp8_mem_frame(bytes, MEM_FRAMES, &cpi->alt_ref_buffer);
+#endif
+
+    if (cpi->lookahead)
+        bytes[MEM_LOOKAHEAD] += vp8_lookahead_mem(cpi->lookahead);
+
+    // The tokens come out of the arena.
+    bytes[MEM_TOKENS] += cpi->tok_size * sizeof(*cpi->tok);
+    bytes[MEM_STATE] -= cpi->tok_size * sizeof(*cpi->tok);
+
+    bytes[MEM_STATE] += sizeof(*cpi)
+                        + bordered_mbs * (sizeof(*cpi->lfmv)
+                                          + sizeof(*cpi->lf_ref_frame_sign_bias)
+                                          + sizeof(*cpi->lf_ref_frame))
+                        + 2 * mbs;   // segmentation_map, active_map
+
+    if (cpi->cyclic_refresh_map)
+        bytes[MEM_STATE] += mbs;
+
+#if CONFIG_MULTITHREAD
+
+    if (cpi->b_multi_threaded)
+    {
+        int i;
+
+        bytes[MEM_THREADS] += cpi->encoding_thread_count
+                              * (sizeof(pthread_t) + sizeof(sem_t)
+                                 + sizeof(MB_ROW_COMP)
+                                 + sizeof(ENCODETHREAD_DATA))
+                              + cm->mb_rows * sizeof(*cpi->mt_current_mb_col);
+
+        for (i = 0; i < cpi->encoding_thread_count; i++)
+            vp8_mem_frame(bytes, MEM_THREADS, &cpi->mb_row_ei[i].lpf_frame);
+    }
+
+#endif
+}
+
 int vp8_get_compressed_data(VP8_COMP *cpi, unsigned int *frame_flags, unsigned long *size, unsigned char *dest, unsigned char *dest_end, int64_t *time_stamp, int64_t *time_end, int flush)
 {
 #if HAVE_NEON
@@ -4793,6 +4994,8 @@ int vp8_get_compressed_data(VP8_COMP *cpi, unsigned int *frame_flags, unsigned l
     // Clear down mmx registers
     vp8_clear_system_state();  //__asm emms;
 
+    wait_for_loopfilter(cpi);
+
     cm->frame_type = INTER_FRAME;
     cm->frame_flags = *frame_flags;
 
@@ -4841,33 +5044,12 @@ int vp8_get_compressed_data(VP8_COMP *cpi, unsigned int *frame_flags, unsigned l
 
     if (cpi->compressor_speed == 2)
     {
-        unsigned int duration, duration2;
+        unsigned int duration;
         vpx_usec_timer_mark(&tsctimer);
         vpx_usec_timer_mark(&ticktimer);
 
         duration = vpx_usec_timer_elapsed(&ticktimer);
-        duration2 = (unsigned int)((double)duration / 2);
-
-        if (cm->frame_type != KEY_FRAME)
-        {
-            if (cpi->avg_encode_time == 0)
-                cpi->avg_encode_time = duration;
-            else
-                cpi->avg_encode_time = (7 * cpi->avg_encode_time + duration) >> 3;
-        }
-
-        if (duration2)
-        {
-            //if(*frame_flags!=1)
-            {
-
-                if (cpi->avg_pick_mode_time == 0)
-                    cpi->avg_pick_mode_time = duration2;
-                else
-                    cpi->avg_pick_mode_time = (7 * cpi->avg_pick_mode_time + duration2) >> 3;
-            }
-        }
-
+        vp8_speed_ctrl_update(cpi, (unsigned int)duration);
     }
 
     if (cm->refresh_entropy_probs == 0)
@@ -4909,6 +5091,7 @@ int vp8_get_compressed_data(VP8_COMP *cpi, unsigned int *frame_flags, unsigned l
 
     if (cpi->b_calculate_psnr && cpi->pass != 1 && cm->show_frame)
     {
+        wait_for_loopfilter(cpi);
         generate_psnr_packet(cpi);
     }
 
@@ -4916,6 +5099,8 @@ int vp8_get_compressed_data(VP8_COMP *cpi, unsigned int *frame_flags, unsigned l
 
     if (cpi->pass != 1)
     {
+        wait_for_loopfilter(cpi);
+
         cpi->bytes += *size;
 
         if (cm->show_frame)
@@ -5074,6 +5259,13 @@ int vp8_get_compressed_data(VP8_COMP *cpi, unsigned int *frame_flags, unsigned l
     }
 #endif
 
+    {
+        size_t bytes[MEM_KINDS] = {0};
+
+        mem_usage(cpi, bytes);
+        vp8_mem_update_peak(cm, bytes);
+    }
+
     cpi->common.error.setjmp = 0;
 
     return 0;
@@ -5086,6 +5278,8 @@ int vp8_get_preview_raw_frame(VP8_COMP *cpi, YV12_BUFFER_CONFIG *dest, vp8_ppfla
     else
     {
         int ret;
+
+        wait_for_loopfilter(cpi);
 #if CONFIG_POSTPROC
         ret = vp8_post_proc_frame(&cpi->common, dest, flags);
 #else
@@ -5116,6 +5310,8 @@ int vp8_set_roimap(VP8_COMP *cpi, unsigned char *map, unsigned int rows, unsigne
     if (cpi->common.mb_rows != rows || cpi->common.mb_cols != cols)
         return -1;
 
+    wait_for_loopfilter(cpi);
+
     if (!map)
     {
         disable_segmentation(cpi);
@@ -5219,3 +5415,26 @@ int vp8_get_quantizer(VP8_COMP *cpi)
 {
     return cpi->common.base_qindex;
 }
+
+void vp8_get_rt_speed_state(VP8_COMP *cpi, vp8e_rt_speed_state_t *state)
+{
+    vp8_speed_ctrl_get_state(&cpi->speed_ctrl, state);
+}
+
+void vp8_get_mem_stats(VP8_COMP *cpi, vp8_mem_stats_t *stats)
+{
+    size_t bytes[MEM_KINDS] = {0};
+
+    mem_usage(cpi, bytes);
+    vp8_fill_mem_stats(&cpi->common, bytes, stats);
+}
+
+void vp8_get_mt_sync_stats(VP8_COMP *cpi, vp8_mt_sync_stats_t *stats)
+{
+    vpx_memset(stats, 0, sizeof(*stats));
+
+#if CONFIG_MULTITHREAD
+    if (cpi->b_multi_threaded)
+        vp8_mt_sync_get_stats(&cpi->mt_sync, stats);
+#endif
+}
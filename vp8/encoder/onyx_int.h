@@ -23,11 +23,15 @@
 #include "quantize.h"
 #include "vp8/common/entropy.h"
 #include "vp8/common/threading.h"
+#include "vp8/common/mtsync.h"
 #include "vpx_ports/mem.h"
 #include "vpx/internal/vpx_codec_internal.h"
 #include "mcomp.h"
 #include "vp8/common/findnearmv.h"
 #include "lookahead.h"
+#include "hme.h"
+#include "speedctrl.h"
+#include "vp8/common/resize.h"
 
 //#define SPEEDSTATS 1
 #define MIN_GF_INTERVAL             4
@@ -186,19 +190,46 @@ typedef struct
     int thresh_mult[MAX_MODES];
     int max_step_search_steps;
     int first_step;
-    int optimize_coefficients;
+    int optimize_coefficients;  // 0 off, 1 full trellis, 2 fast trellis
 
     int use_fastquant_for_pick;
     int no_skip_block4x4_search;
     int improved_mv_pred;
+    int hierarchical_me;
+    int mode_history;
+    int satd_pick;
+    int fast_coef_costing;
 
 } SPEED_FEATURES;
 
+#define SATD_RATE_Q_SHIFT 4
+
+// Outcome of the RD mode decision of one MB over the previous frames.
+// Laid out like MODE_INFO, so mode_info_context - cm->mi indexes it.
+typedef struct
+{
+    int rd;                     // RD cost of the winning mode
+    int_mv mv;
+    unsigned char mode_index;   // winning entry of vp8_mode_order[]
+    unsigned char run;          // frames in a row it won, 0 if none yet
+} MB_MODE_HISTORY;
+
 typedef struct
 {
     MACROBLOCK  mb;
     int segment_counts[MAX_MB_SEGMENTS];
     int totalrate;
+#if CONFIG_MULTITHREAD
+    MT_SYNC_COUNTERS sync_counters;
+
+    // Loop filter level this thread scores for vp8cx_pick_filter_level()
+    YV12_BUFFER_CONFIG lpf_frame;
+    int lpf_level;
+    int lpf_err;
+
+    // Sum of the activity of the rows this thread measured
+    int64_t activity_sum;
+#endif
 } MB_ROW_COMP;
 
 typedef struct
@@ -317,6 +348,7 @@ typedef struct VP8_COMP
     YV12_BUFFER_CONFIG *Source;
     YV12_BUFFER_CONFIG *un_scaled_source;
     YV12_BUFFER_CONFIG scaled_source;
+    RESIZE_CTX resize;              // filters from un_scaled_source's size
 
     int source_alt_ref_pending; // frame in src_buffers has been identified to be encoded as an alt ref
     int source_alt_ref_active;  // an alt ref frame has been encoded and is usable
@@ -332,6 +364,7 @@ typedef struct VP8_COMP
 
     TOKENEXTRA *tok;
     unsigned int tok_count;
+    unsigned int tok_size;          // entries in tok
 
 
     unsigned int frames_since_key;
@@ -465,8 +498,7 @@ typedef struct VP8_COMP
     int decimation_count;
 
     // for real time encoding
-    int avg_encode_time;              //microsecond
-    int avg_pick_mode_time;            //microsecond
+    SPEED_CTRL speed_ctrl;
     int Speed;
     unsigned int cpu_freq;           //Mhz
     int compressor_speed;
@@ -522,8 +554,9 @@ typedef struct VP8_COMP
 
 #if CONFIG_MULTITHREAD
     // multithread data
-    int * mt_current_mb_col;
-    int mt_sync_range;
+    MT_ROW_PROGRESS *mt_current_mb_col;
+    MT_SYNC_STATE mt_sync;
+    MT_SYNC_COUNTERS mt_sync_main;
     int b_multi_threaded;
     int encoding_thread_count;
 
@@ -539,6 +572,19 @@ typedef struct VP8_COMP
     sem_t h_event_end_encoding;
     sem_t h_event_start_lpf;
     sem_t h_event_end_lpf;
+
+    // Set while the loop filter thread still works on the last frame
+    int b_lpf_running;
+
+    // Set while the encoding threads are woken to score loop filter levels,
+    // to measure the activity map or to resize the source rather than to
+    // encode. Each thread posts h_event_end_job when done.
+    int mt_lpf_search;
+    YV12_BUFFER_CONFIG *lpf_search_src;
+    int mt_activity_map;
+    int mt_resize;
+    YV12_BUFFER_CONFIG *resize_src;
+    sem_t h_event_end_job;
 #endif
 
     TOKENLIST *tplist;
@@ -647,6 +693,17 @@ typedef struct VP8_COMP
 
     int output_partition;
 
+    // Coarse motion field of the hierarchical ME pre-pass
+    HME_STATE hme;
+
+    // Per MB winners of the previous frames' RD mode decisions
+    MB_MODE_HISTORY *mode_history;
+
+    // Coefficient rate model of the SATD mode decision: a residual with
+    // SATD s at quantizer step q costs about s * k / q, in the 1/256 bit
+    // units of RDCOST, k learnt per band of q from the token partitions.
+    int satd_rate_k[QINDEX_RANGE >> SATD_RATE_Q_SHIFT];
+
     //Store last frame's MV info for next frame MV prediction
     int_mv *lfmv;
     int *lf_ref_frame_sign_bias;
@@ -677,6 +734,13 @@ typedef struct VP8_COMP
 #if CONFIG_MULTI_RES_ENCODING
     /* Number of MBs per row at lower-resolution level */
     int    mr_low_res_mb_cols;
+    int    mr_low_res_mb_rows;
+    /* Sequence number of the current encode call, shared by the levels */
+    int    mr_seq;
+    /* The coding pass can't be repeated: publish rows as they are coded */
+    int    mr_store_rows;
+    /* Row buffers of the down-scaler, 2 * aligned width */
+    unsigned int *mr_scale_buf;
 #endif
 
 } VP8_COMP;
@@ -24,6 +24,9 @@
 #include "mcomp.h"
 #include "rdopt.h"
 #include "vpx_mem/vpx_mem.h"
+#if CONFIG_MULTI_RES_ENCODING
+#include "mr_dissim.h"
+#endif
 
 extern int VP8_UVSSE(MACROBLOCK *x);
 
@@ -113,15 +116,205 @@ unsigned int vp8_get4x4sse_cs_c
     return distortion;
 }
 
-static int get_prediction_error(BLOCK *be, BLOCKD *b)
+
+#define AVG2(a, b)     (((a) + (b) + 1) >> 1)
+#define AVG3(a, b, c)  (((a) + 2 * (b) + (c) + 2) >> 2)
+
+/* Builds the 4x4 intra predictors of the first num_modes B_PREDICTION_MODEs
+ * for the block at dst from one read of its edge, and returns their SSE
+ * against the source. The predictors are packed in mode order, 16 bytes
+ * each with a stride of 4, so a SIMD version can hold a whole predictor in
+ * a register. The fast picker only needs the four non directional modes;
+ * the RD picker measures its own distortion and passes a NULL sse.
+ */
+void vp8_intra4x4_predict_all_c(unsigned char *dst, int dst_stride,
+                                const unsigned char *src, int src_stride,
+                                int num_modes, unsigned char *pred,
+                                unsigned int *sse)
 {
-    unsigned char *sptr;
-    unsigned char *dptr;
-    sptr = (*(be->base_src) + be->src);
-    dptr = b->predictor_base + b->predictor_offset;
+    /* Left column bottom up, top left, then eight above: the same order
+     * as the pp[] arrays of vp8_intra4x4_predict_c().
+     */
+    int e[13];
+    unsigned char blk[16];
+    const int *L = e + 3;   /* L[-r] is left of row r */
+    const int *A = e + 5;
+    unsigned char *p;
+    int i, r, c;
+
+    for (i = 0; i < 4; i++)
+        e[3 - i] = dst[i * dst_stride - 1];
+
+    for (i = -1; i < 8; i++)
+        e[5 + i] = dst[i - dst_stride];
+
+    /* B_DC_PRED */
+    p = pred + B_DC_PRED * 16;
+    {
+        int dc = (A[0] + A[1] + A[2] + A[3] + e[0] + e[1] + e[2] + e[3] + 4) >> 3;
+
+        for (i = 0; i < 16; i++)
+            p[i] = dc;
+    }
+
+    /* B_TM_PRED */
+    p = pred + B_TM_PRED * 16;
+
+    for (r = 0; r < 4; r++)
+        for (c = 0; c < 4; c++)
+        {
+            int v = A[c] - e[4] + L[-r];
+
+            p[r * 4 + c] = v < 0 ? 0 : v > 255 ? 255 : v;
+        }
+
+    /* B_VE_PRED */
+    p = pred + B_VE_PRED * 16;
+
+    for (c = 0; c < 4; c++)
+        p[c] = p[4 + c] = p[8 + c] = p[12 + c] = AVG3(A[c - 1], A[c], A[c + 1]);
+
+    /* B_HE_PRED */
+    p = pred + B_HE_PRED * 16;
+
+    for (r = 0; r < 4; r++)
+    {
+        int v = AVG3(L[1 - r], L[-r], L[r == 3 ? -3 : -1 - r]);
+
+        p[r * 4] = p[r * 4 + 1] = p[r * 4 + 2] = p[r * 4 + 3] = v;
+    }
+
+    if (num_modes > B_HE_PRED + 1)
+    {
+        /* B_LD_PRED */
+        p = pred + B_LD_PRED * 16;
+
+        for (r = 0; r < 4; r++)
+            for (c = 0; c < 4; c++)
+            {
+                int k = r + c;
 
-    return vp8_get4x4sse_cs(sptr, be->src_stride, dptr, 16);
+                p[r * 4 + c] = AVG3(A[k], A[k + 1], A[k == 6 ? 7 : k + 2]);
+            }
+
+        /* B_RD_PRED */
+        p = pred + B_RD_PRED * 16;
+
+        for (r = 0; r < 4; r++)
+            for (c = 0; c < 4; c++)
+            {
+                int k = 3 - r + c;
+
+                p[r * 4 + c] = AVG3(e[k], e[k + 1], e[k + 2]);
+            }
+
+        /* B_VR_PRED */
+        p = pred + B_VR_PRED * 16;
+        p[12] = AVG3(e[1], e[2], e[3]);
+        p[8] = AVG3(e[2], e[3], e[4]);
+        p[13] = p[4] = AVG3(e[3], e[4], e[5]);
+        p[9] = p[0] = AVG2(e[4], e[5]);
+        p[14] = p[5] = AVG3(e[4], e[5], e[6]);
+        p[10] = p[1] = AVG2(e[5], e[6]);
+        p[15] = p[6] = AVG3(e[5], e[6], e[7]);
+        p[11] = p[2] = AVG2(e[6], e[7]);
+        p[7] = AVG3(e[6], e[7], e[8]);
+        p[3] = AVG2(e[7], e[8]);
+
+        /* B_VL_PRED */
+        p = pred + B_VL_PRED * 16;
+        p[0] = AVG2(A[0], A[1]);
+        p[4] = AVG3(A[0], A[1], A[2]);
+        p[8] = p[1] = AVG2(A[1], A[2]);
+        p[5] = p[12] = AVG3(A[1], A[2], A[3]);
+        p[9] = p[2] = AVG2(A[2], A[3]);
+        p[13] = p[6] = AVG3(A[2], A[3], A[4]);
+        p[3] = p[10] = AVG2(A[3], A[4]);
+        p[7] = p[14] = AVG3(A[3], A[4], A[5]);
+        p[11] = AVG3(A[4], A[5], A[6]);
+        p[15] = AVG3(A[5], A[6], A[7]);
+
+        /* B_HD_PRED */
+        p = pred + B_HD_PRED * 16;
+        p[12] = AVG2(e[0], e[1]);
+        p[13] = AVG3(e[0], e[1], e[2]);
+        p[8] = p[14] = AVG2(e[1], e[2]);
+        p[9] = p[15] = AVG3(e[1], e[2], e[3]);
+        p[10] = p[4] = AVG2(e[2], e[3]);
+        p[11] = p[5] = AVG3(e[2], e[3], e[4]);
+        p[6] = p[0] = AVG2(e[3], e[4]);
+        p[7] = p[1] = AVG3(e[3], e[4], e[5]);
+        p[2] = AVG3(e[4], e[5], e[6]);
+        p[3] = AVG3(e[5], e[6], e[7]);
+
+        /* B_HU_PRED */
+        p = pred + B_HU_PRED * 16;
+        p[0] = AVG2(e[3], e[2]);
+        p[1] = AVG3(e[3], e[2], e[1]);
+        p[2] = p[4] = AVG2(e[2], e[1]);
+        p[3] = p[5] = AVG3(e[2], e[1], e[0]);
+        p[6] = p[8] = AVG2(e[1], e[0]);
+        p[7] = p[9] = AVG3(e[1], e[0], e[0]);
+        p[10] = p[11] = p[12] = p[13] = p[14] = p[15] = e[0];
+    }
+
+    if (!sse)
+        return;
+
+    for (r = 0; r < 4; r++)
+        for (c = 0; c < 4; c++)
+            blk[r * 4 + c] = src[r * src_stride + c];
+
+    for (i = 0; i < num_modes; i++)
+    {
+        unsigned int err = 0;
+
+        p = pred + i * 16;
+
+        for (c = 0; c < 16; c++)
+        {
+            int diff = blk[c] - p[c];
 
+            err += diff * diff;
+        }
+
+        sse[i] = err;
+    }
+}
+
+#undef AVG2
+#undef AVG3
+
+/* SATD of the 16x16 inter prediction at mv, built only when it is sub-pel */
+static unsigned int get_inter_mbpred_satd(MACROBLOCK *mb, int_mv this_mv)
+{
+    BLOCK *b = &mb->block[0];
+    BLOCKD *d = &mb->e_mbd.block[0];
+    unsigned char *in_what = *(d->base_pre) + d->pre;
+    int in_what_stride = d->pre_stride;
+
+    in_what += (this_mv.as_mv.row >> 3) * d->pre_stride + (this_mv.as_mv.col >> 3);
+
+    if ((this_mv.as_mv.row | this_mv.as_mv.col) & 7)
+    {
+        mb->e_mbd.subpixel_predict16x16(in_what, in_what_stride,
+                                        this_mv.as_mv.col & 7,
+                                        this_mv.as_mv.row & 7,
+                                        mb->e_mbd.predictor, 16);
+        in_what = mb->e_mbd.predictor;
+        in_what_stride = 16;
+    }
+
+    return vp8_satd16x16(*(b->base_src) + b->src, b->src_stride,
+                         in_what, in_what_stride);
+}
+
+/* Estimated cost of the residual's coefficients, from its SATD */
+static int satd_rate(VP8_COMP *cpi, MACROBLOCK *mb, unsigned int satd)
+{
+    return (int)(((int64_t)satd *
+                  cpi->satd_rate_k[mb->q_index >> SATD_RATE_Q_SHIFT]) /
+                 cpi->common.Y1dequant[mb->q_index][1]);
 }
 
 static int pick_intra4x4block(
@@ -140,16 +333,19 @@ static int pick_intra4x4block(
     int best_rd = INT_MAX;       // 1<<30
     int rate;
     int distortion;
+    DECLARE_ALIGNED_ARRAY(16, unsigned char, pred, 16 * VP8_BINTRAMODES);
+    unsigned int sse[VP8_BINTRAMODES];
+
+    vp8_intra4x4_predict_all(*(b->base_dst) + b->dst, b->dst_stride,
+                             *(be->base_src) + be->src, be->src_stride,
+                             B_HE_PRED + 1, pred, sse);
 
     for (mode = B_DC_PRED; mode <= B_HE_PRED /*B_HU_PRED*/; mode++)
     {
         int this_rd;
 
         rate = mode_costs[mode];
-        vp8_intra4x4_predict
-                     (*(b->base_dst) + b->dst, b->dst_stride,
-                      mode, b->predictor_base + b->predictor_offset, 16);
-        distortion = get_prediction_error(be, b);
+        distortion = sse[mode];
         this_rd = RDCOST(x->rdmult, x->rddiv, rate, distortion);
 
         if (this_rd < best_rd)
@@ -392,63 +588,6 @@ static void update_mvcount(VP8_COMP *cpi, MACROBLOCKD *xd, int_mv *best_ref_mv)
 }
 
 
-#if CONFIG_MULTI_RES_ENCODING
-static
-void get_lower_res_motion_info(VP8_COMP *cpi, MACROBLOCKD *xd, int *dissim,
-                               int *parent_ref_frame,
-                               MB_PREDICTION_MODE *parent_mode,
-                               int_mv *parent_ref_mv, int mb_row, int mb_col)
-{
-    LOWER_RES_INFO* store_mode_info
-                          = (LOWER_RES_INFO*)cpi->oxcf.mr_low_res_mode_info;
-    unsigned int parent_mb_index;
-    //unsigned int parent_mb_index = map_640x480_to_320x240[mb_row][mb_col];
-
-    /* Consider different down_sampling_factor.  */
-    {
-        /* TODO: Removed the loop that supports special down_sampling_factor
-         * such as 2, 4, 8. Will revisit it if needed.
-         * Should also try using a look-up table to see if it helps
-         * performance. */
-        int round = cpi->oxcf.mr_down_sampling_factor.num/2;
-        int parent_mb_row, parent_mb_col;
-
-        parent_mb_row = (mb_row*cpi->oxcf.mr_down_sampling_factor.den+round)
-                    /cpi->oxcf.mr_down_sampling_factor.num;
-        parent_mb_col = (mb_col*cpi->oxcf.mr_down_sampling_factor.den+round)
-                    /cpi->oxcf.mr_down_sampling_factor.num;
-        parent_mb_index = parent_mb_row*cpi->mr_low_res_mb_cols + parent_mb_col;
-    }
-
-    /* Read lower-resolution mode & motion result from memory.*/
-    *parent_ref_frame = store_mode_info[parent_mb_index].ref_frame;
-    *parent_mode =  store_mode_info[parent_mb_index].mode;
-    *dissim = store_mode_info[parent_mb_index].dissim;
-
-    /* For highest-resolution encoder, adjust dissim value. Lower its quality
-     * for good performance. */
-    if (cpi->oxcf.mr_encoder_id == (cpi->oxcf.mr_total_resolutions - 1))
-        *dissim>>=1;
-
-    if(*parent_ref_frame != INTRA_FRAME)
-    {
-        /* Consider different down_sampling_factor.
-         * The result can be rounded to be more precise, but it takes more time.
-         */
-        //int round = cpi->oxcf.mr_down_sampling_factor.den/2;
-        (*parent_ref_mv).as_mv.row = store_mode_info[parent_mb_index].mv.as_mv.row
-                                  *cpi->oxcf.mr_down_sampling_factor.num
-                                  /cpi->oxcf.mr_down_sampling_factor.den;
-        (*parent_ref_mv).as_mv.col = store_mode_info[parent_mb_index].mv.as_mv.col
-                                  *cpi->oxcf.mr_down_sampling_factor.num
-                                  /cpi->oxcf.mr_down_sampling_factor.den;
-
-        vp8_clamp_mv2(parent_ref_mv, xd);
-    }
-}
-#endif
-
-
 void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                          int recon_uvoffset, int *returnrate,
                          int *returndistortion, int *returnintra, int mb_row,
@@ -475,6 +614,7 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
     int bestsme = INT_MAX;
     int best_mode_index = 0;
     unsigned int sse = INT_MAX, best_sse = INT_MAX;
+    unsigned int satd, best_satd = 0;
 
     int_mv mvp;
 
@@ -495,9 +635,12 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
     int_mv parent_ref_mv;
     MB_PREDICTION_MODE parent_mode = 0;
 
+    int parent_skip = 0;
+
     if (cpi->oxcf.mr_encoder_id)
-        get_lower_res_motion_info(cpi, xd, &dissim, &parent_ref_frame,
-                                  &parent_mode, &parent_ref_mv, mb_row, mb_col);
+        vp8_mr_get_lower_res_info(cpi, xd, mb_row, mb_col, &dissim,
+                                  &parent_ref_frame, &parent_mode,
+                                  &parent_ref_mv, &parent_skip);
 #endif
 
     mode_mv = mode_mv_sb[sign_bias];
@@ -630,6 +773,7 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
 
         rate2 = 0;
         distortion2 = 0;
+        satd = 0;
 
         this_mode = vp8_mode_order[mode_index];
 
@@ -668,6 +812,14 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                 distortion2 = vp8_variance16x16(
                                     *(b->base_src), b->src_stride,
                                     x->e_mbd.predictor, 16, &sse);
+
+                if (cpi->sf.satd_pick)
+                {
+                    satd = vp8_satd16x16(*(b->base_src), b->src_stride,
+                                         x->e_mbd.predictor, 16);
+                    rate2 += satd_rate(cpi, x, satd);
+                }
+
                 this_rd = RDCOST(x->rdmult, x->rddiv, rate2, distortion2);
 
                 if (this_rd < best_intra_rd)
@@ -694,6 +846,14 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                                           (*(b->base_src), b->src_stride,
                                           x->e_mbd.predictor, 16, &sse);
             rate2 += x->mbmode_cost[x->e_mbd.frame_type][x->e_mbd.mode_info_context->mbmi.mode];
+
+            if (cpi->sf.satd_pick)
+            {
+                satd = vp8_satd16x16(*(b->base_src), b->src_stride,
+                                     x->e_mbd.predictor, 16);
+                rate2 += satd_rate(cpi, x, satd);
+            }
+
             this_rd = RDCOST(x->rdmult, x->rddiv, rate2, distortion2);
 
             if (this_rd < best_intra_rd)
@@ -737,9 +897,7 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                 mvp_full.as_mv.col = parent_ref_mv.as_mv.col>>3;
                 mvp_full.as_mv.row = parent_ref_mv.as_mv.row>>3;
 
-                if(dissim <=32) step_param += 3;
-                else if(dissim <=128) step_param += 2;
-                else step_param += 1;
+                step_param += vp8_mr_step_adjust(dissim);
             }else
 #endif
             {
@@ -798,6 +956,8 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                 if (x->mv_row_max > row_max )
                     x->mv_row_max = row_max;
 
+                vp8_hme_seed(cpi, x, &best_ref_mv, &mvp_full, &step_param);
+
                 further_steps = (cpi->Speed >= 8)?
                            0: (cpi->sf.max_step_search_steps - 1 - step_param);
 
@@ -920,6 +1080,12 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                                                      &cpi->fn_ptr[BLOCK_16X16],
                                                      &sse, mode_mv[this_mode]);
 
+            if (cpi->sf.satd_pick)
+            {
+                satd = get_inter_mbpred_satd(x, mode_mv[this_mode]);
+                rate2 += satd_rate(cpi, x, satd);
+            }
+
             this_rd = RDCOST(x->rdmult, x->rddiv, rate2, distortion2);
 
             if (sse < x->encode_breakout)
@@ -948,6 +1114,7 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
             *returnrate = rate2;
             *returndistortion = distortion2;
             best_sse = sse;
+            best_satd = satd;
             best_rd = this_rd;
             vpx_memcpy(&best_mbmode, &x->e_mbd.mode_info_context->mbmi,
                        sizeof(MB_MODE_INFO));
@@ -982,6 +1149,8 @@ void vp8_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
             break;
     }
 
+    x->satd_sum += best_satd;
+
     // Reduce the activation RD thresholds for the best choice mode
     if ((cpi->rd_baseline_thresh[best_mode_index] > 0) && (cpi->rd_baseline_thresh[best_mode_index] < (INT_MAX >> 2)))
     {
@@ -22,6 +22,11 @@
 #endif
 
 extern int vp8_calc_ss_err(YV12_BUFFER_CONFIG *source, YV12_BUFFER_CONFIG *dest);
+#if CONFIG_MULTITHREAD
+extern void vp8cx_calc_lpf_levels_err_mt(VP8_COMP *cpi,
+                                         YV12_BUFFER_CONFIG *sd,
+                                         const int *levels, int *errs, int n);
+#endif
 
 void vp8_yv12_copy_partial_frame_c(YV12_BUFFER_CONFIG *src_ybc,
                                    YV12_BUFFER_CONFIG *dst_ybc)
@@ -258,6 +263,66 @@ void vp8cx_set_alt_lf_level(VP8_COMP *cpi, int filt_val)
     mbd->segment_feature_data[MB_LVL_ALT_LF][3] = cpi->segment_feature_data[MB_LVL_ALT_LF][3];
 }
 
+/* Error against the source sd of the unfiltered frame (cm->frame_to_show)
+ * filtered at filt_lvl, using dst as the scratch copy.
+ */
+int vp8cx_calc_lpf_level_err(VP8_COMP *cpi, YV12_BUFFER_CONFIG *sd,
+                             YV12_BUFFER_CONFIG *dst, int filt_lvl)
+{
+    VP8_COMMON *cm = &cpi->common;
+
+    vp8_yv12_copy_y_ptr(cm->frame_to_show, dst);
+    vp8_loop_filter_yonly_buffer(cm, &cpi->mb.e_mbd, filt_lvl, dst);
+
+    return vp8_calc_ss_err(sd, dst);
+}
+
+/* Scores the levels among levels[] not scored in ss_err[] yet, side by
+ * side on the encoding threads when there are any.
+ */
+static void calc_levels_err(VP8_COMP *cpi, YV12_BUFFER_CONFIG *sd,
+                            const int *levels, int n, int *ss_err)
+{
+    int todo[3];
+    int err[3];
+    int count = 0;
+    int i, j;
+
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < count && todo[j] != levels[i]; j++);
+
+        if (!ss_err[levels[i]] && j == count)
+            todo[count++] = levels[i];
+    }
+
+    for (i = 0; i < count; )
+    {
+        int batch = count - i;
+
+#if CONFIG_MULTITHREAD
+        if (cpi->b_multi_threaded)
+        {
+            if (batch > cpi->encoding_thread_count + 1)
+                batch = cpi->encoding_thread_count + 1;
+
+            vp8cx_calc_lpf_levels_err_mt(cpi, sd, todo + i, err + i, batch);
+        }
+        else
+#endif
+        {
+            batch = 1;
+            err[i] = vp8cx_calc_lpf_level_err(cpi, sd, &cpi->pick_lf_lvl_frame,
+                                              todo[i]);
+        }
+
+        for (j = i; j < i + batch; j++)
+            ss_err[todo[j]] = err[j];
+
+        i += batch;
+    }
+}
+
 void vp8cx_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP8_COMP *cpi)
 {
     VP8_COMMON *cm = &cpi->common;
@@ -273,23 +338,26 @@ void vp8cx_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP8_COMP *cpi)
     int filt_low = 0;
     int filt_best;
     int filt_direction = 0;
+    int n;
 
     int Bias = 0;                       // Bias against raising loop filter and in favor of lowering it
 
     int ss_err[MAX_LOOP_FILTER + 1];
-
-    YV12_BUFFER_CONFIG * saved_frame = cm->frame_to_show;
+    int levels[3];
 
     vpx_memset(ss_err, 0, sizeof(ss_err));
 
-    /* Replace unfiltered frame buffer with a new one */
-    cm->frame_to_show = &cpi->pick_lf_lvl_frame;
-
     if (cm->frame_type == KEY_FRAME)
         cm->sharpness_level = 0;
     else
         cm->sharpness_level = cpi->oxcf.Sharpness;
 
+    if (cm->sharpness_level != cm->last_sharpness_level)
+    {
+        vp8_loop_filter_update_sharpness(&cm->lf_info, cm->sharpness_level);
+        cm->last_sharpness_level = cm->sharpness_level;
+    }
+
     // Start the search at the previous frame filter level unless it is now out of range.
     filt_mid = cm->filter_level;
 
@@ -301,17 +369,18 @@ void vp8cx_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP8_COMP *cpi)
     // Define the initial step size
     filter_step = (filt_mid < 16) ? 4 : filt_mid / 4;
 
-    // Get baseline error score
-
-    /* Copy the unfiltered / processed recon buffer to the new buffer */
-    vp8_yv12_copy_y_ptr(saved_frame, cm->frame_to_show);
-
     vp8cx_set_alt_lf_level(cpi, filt_mid);
-    vp8_loop_filter_frame_yonly(cm, &cpi->mb.e_mbd, filt_mid);
 
-    best_err = vp8_calc_ss_err(sd, cm->frame_to_show);
+    // Get baseline error score, along with those of the first step's
+    // levels, which are always needed
+    levels[0] = filt_mid;
+    levels[1] = (filt_mid - filter_step < min_filter_level) ?
+                min_filter_level : filt_mid - filter_step;
+    levels[2] = (filt_mid + filter_step > max_filter_level) ?
+                max_filter_level : filt_mid + filter_step;
+    calc_levels_err(cpi, sd, levels, 3, ss_err);
 
-    ss_err[filt_mid] = best_err;
+    best_err = ss_err[filt_mid];
 
     filt_best = filt_mid;
 
@@ -326,20 +395,20 @@ void vp8cx_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP8_COMP *cpi)
         filt_high = ((filt_mid + filter_step) > max_filter_level) ? max_filter_level : (filt_mid + filter_step);
         filt_low = ((filt_mid - filter_step) < min_filter_level) ? min_filter_level : (filt_mid - filter_step);
 
+        // Score the low and high filter levels that are looked at below
+        n = 0;
+
         if ((filt_direction <= 0) && (filt_low != filt_mid))
-        {
-            if(ss_err[filt_low] == 0)
-            {
-                // Get Low filter error score
-                vp8_yv12_copy_y_ptr(saved_frame, cm->frame_to_show);
-                vp8cx_set_alt_lf_level(cpi, filt_low);
-                vp8_loop_filter_frame_yonly(cm, &cpi->mb.e_mbd, filt_low);
+            levels[n++] = filt_low;
 
-                filt_err = vp8_calc_ss_err(sd, cm->frame_to_show);
-                ss_err[filt_low] = filt_err;
-            }
-            else
-                filt_err = ss_err[filt_low];
+        if ((filt_direction >= 0) && (filt_high != filt_mid))
+            levels[n++] = filt_high;
+
+        calc_levels_err(cpi, sd, levels, n, ss_err);
+
+        if ((filt_direction <= 0) && (filt_low != filt_mid))
+        {
+            filt_err = ss_err[filt_low];
 
             // If value is close to the best so far then bias towards a lower loop filter value.
             if ((filt_err - Bias) < best_err)
@@ -355,17 +424,7 @@ void vp8cx_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP8_COMP *cpi)
         // Now look at filt_high
         if ((filt_direction >= 0) && (filt_high != filt_mid))
         {
-            if(ss_err[filt_high] == 0)
-            {
-                vp8_yv12_copy_y_ptr(saved_frame, cm->frame_to_show);
-                vp8cx_set_alt_lf_level(cpi, filt_high);
-                vp8_loop_filter_frame_yonly(cm, &cpi->mb.e_mbd, filt_high);
-
-                filt_err = vp8_calc_ss_err(sd, cm->frame_to_show);
-                ss_err[filt_high] = filt_err;
-            }
-            else
-                filt_err = ss_err[filt_high];
+            filt_err = ss_err[filt_high];
 
             // Was it better than the previous best?
             if (filt_err < (best_err - Bias))
@@ -389,7 +448,4 @@ void vp8cx_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP8_COMP *cpi)
     }
 
     cm->filter_level = filt_best;
-
-    /* restore unfiltered frame pointer */
-    cm->frame_to_show = saved_frame;
 }
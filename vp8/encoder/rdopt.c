@@ -10,6 +10,7 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <limits.h>
 #include <assert.h>
@@ -33,31 +34,18 @@
 #include "rdopt.h"
 #include "vpx_mem/vpx_mem.h"
 #include "vp8/common/systemdependent.h"
+#if CONFIG_MULTI_RES_ENCODING
+#include "mr_dissim.h"
+#endif
 
 extern void vp8_update_zbin_extra(VP8_COMP *cpi, MACROBLOCK *x);
 
 #define MAXF(a,b)            (((a) > (b)) ? (a) : (b))
 
-static const int auto_speed_thresh[17] =
-{
-    1000,
-    200,
-    150,
-    130,
-    150,
-    125,
-    120,
-    115,
-    115,
-    115,
-    115,
-    115,
-    115,
-    115,
-    115,
-    115,
-    105
-};
+// Early exit on the previous frames' winner once it won this many frames
+// in a row; every MB still gets the full search every 8th frame.
+#define MODE_HISTORY_MIN_RUN    4
+#define MODE_HISTORY_REFRESH    8
 
 const MB_PREDICTION_MODE vp8_mode_order[MAX_MODES] =
 {
@@ -142,6 +130,70 @@ static void fill_token_costs(
 
 }
 
+/* Tables of the approximate coefficient costing, see cost_coeffs_est().
+ * The token costs are averaged over the previous token contexts, and a
+ * level is charged its cost over that of a zero token in the same band,
+ * so the zero run up to the EOB can be accounted for with the EOB.
+ */
+static void fill_est_costs(MACROBLOCK *mb)
+{
+    int i, c, k, v;
+
+    for (i = 0; i < BLOCK_TYPES; i++)
+    {
+        unsigned int (*tc)[PREV_COEF_CONTEXTS][MAX_ENTROPY_TOKENS] =
+            mb->token_costs[i];
+        const int first = !i;
+        int zero_cost[16];
+
+        for (c = 0; c < 16; c++)
+        {
+            const int band = vp8_coef_bands[c];
+            short *level_cost = mb->est_level_costs[i][vp8_default_zig_zag1d[c]];
+
+            zero_cost[c] = (tc[band][0][ZERO_TOKEN] + tc[band][1][ZERO_TOKEN] +
+                            tc[band][2][ZERO_TOKEN] + 1) / 3;
+
+            level_cost[0] = 0;
+
+            for (v = 1; v <= EST_LEVEL_MAX; v++)
+            {
+                const int t = vp8_dct_value_tokens_ptr[v].Token;
+                int cost = (tc[band][0][t] + tc[band][1][t] + tc[band][2][t] + 1) / 3;
+
+                cost += (vp8_dct_value_cost_ptr[v] +
+                         vp8_dct_value_cost_ptr[-v] + 1) >> 1;
+                level_cost[v] = c < first ? 0 : cost - zero_cost[c];
+            }
+        }
+
+        for (k = 0; k < PREV_COEF_CONTEXTS; k++)
+        {
+            int run = 0;
+
+            for (c = 0; c <= 16; c++)
+            {
+                int cost;
+
+                if (c <= first)
+                    cost = tc[vp8_coef_bands[first]][k][DCT_EOB_TOKEN];
+                else
+                {
+                    /* An EOB follows a nonzero coefficient. */
+                    run += zero_cost[c - 1];
+                    cost = run;
+
+                    if (c < 16)
+                        cost += (tc[vp8_coef_bands[c]][1][DCT_EOB_TOKEN] +
+                                 tc[vp8_coef_bands[c]][2][DCT_EOB_TOKEN] + 1) >> 1;
+                }
+
+                mb->est_eob_costs[i][k][c] = cost;
+            }
+        }
+    }
+}
+
 static int rd_iifactor [ 32 ] =  {    4,   4,   3,   2,   1,   0,   0,   0,
                                       0,   0,   0,   0,   0,   0,   0,   0,
                                       0,   0,   0,   0,   0,   0,   0,   0,
@@ -292,6 +344,9 @@ void vp8_initialize_rd_consts(VP8_COMP *cpi, int Qvalue)
           cpi->mb.token_costs,
           (const vp8_prob( *)[8][3][11]) l->coef_probs
       );
+
+      if (cpi->mb.fast_coef_costing)
+          fill_est_costs(&cpi->mb);
       /*
       fill_token_costs(
           cpi->mb.token_costs,
@@ -309,81 +364,6 @@ void vp8_initialize_rd_consts(VP8_COMP *cpi, int Qvalue)
 
 }
 
-void vp8_auto_select_speed(VP8_COMP *cpi)
-{
-    int milliseconds_for_compress = (int)(1000000 / cpi->frame_rate);
-
-    milliseconds_for_compress = milliseconds_for_compress * (16 - cpi->oxcf.cpu_used) / 16;
-
-#if 0
-
-    if (0)
-    {
-        FILE *f;
-
-        f = fopen("speed.stt", "a");
-        fprintf(f, " %8ld %10ld %10ld %10ld\n",
-                cpi->common.current_video_frame, cpi->Speed, milliseconds_for_compress, cpi->avg_pick_mode_time);
-        fclose(f);
-    }
-
-#endif
-
-    /*
-    // this is done during parameter valid check
-    if( cpi->oxcf.cpu_used > 16)
-        cpi->oxcf.cpu_used = 16;
-    if( cpi->oxcf.cpu_used < -16)
-        cpi->oxcf.cpu_used = -16;
-    */
-
-    if (cpi->avg_pick_mode_time < milliseconds_for_compress && (cpi->avg_encode_time - cpi->avg_pick_mode_time) < milliseconds_for_compress)
-    {
-        if (cpi->avg_pick_mode_time == 0)
-        {
-            cpi->Speed = 4;
-        }
-        else
-        {
-            if (milliseconds_for_compress * 100 < cpi->avg_encode_time * 95)
-            {
-                cpi->Speed          += 2;
-                cpi->avg_pick_mode_time = 0;
-                cpi->avg_encode_time = 0;
-
-                if (cpi->Speed > 16)
-                {
-                    cpi->Speed = 16;
-                }
-            }
-
-            if (milliseconds_for_compress * 100 > cpi->avg_encode_time * auto_speed_thresh[cpi->Speed])
-            {
-                cpi->Speed          -= 1;
-                cpi->avg_pick_mode_time = 0;
-                cpi->avg_encode_time = 0;
-
-                // In real-time mode, cpi->speed is in [4, 16].
-                if (cpi->Speed < 4)        //if ( cpi->Speed < 0 )
-                {
-                    cpi->Speed = 4;        //cpi->Speed = 0;
-                }
-            }
-        }
-    }
-    else
-    {
-        cpi->Speed += 4;
-
-        if (cpi->Speed > 16)
-            cpi->Speed = 16;
-
-
-        cpi->avg_pick_mode_time = 0;
-        cpi->avg_encode_time = 0;
-    }
-}
-
 int vp8_block_error_c(short *coeff, short *dqcoeff)
 {
     int i;
@@ -500,6 +480,36 @@ int VP8_UVSSE(MACROBLOCK *x)
 
 }
 
+/* Approximate rate of a block: the eob and block context give the cost
+ * of the EOB and of the zero run before it, and each nonzero level adds
+ * a context free cost by position. No zig-zag walk and no token lookups,
+ * the sum runs over the 16 coefficients in raster order.
+ */
+static int cost_coeffs_est(MACROBLOCK *mb, BLOCKD *b, int type, ENTROPY_CONTEXT *a, ENTROPY_CONTEXT *l)
+{
+    const short *qcoeff_ptr = b->qcoeff_base + b->qcoeff_offset;
+    short (*level_cost)[EST_LEVEL_MAX + 1] = mb->est_level_costs[type];
+    int eob = (int)(*b->eob);
+    int pt;
+    int cost;
+    int i;
+
+    VP8_COMBINEENTROPYCONTEXTS(pt, *a, *l);
+
+    cost = mb->est_eob_costs[type][pt][eob];
+
+    for (i = 0; i < 16; i++)
+    {
+        int v = abs(qcoeff_ptr[i]);
+
+        cost += level_cost[i][v > EST_LEVEL_MAX ? EST_LEVEL_MAX : v];
+    }
+
+    *a = *l = (eob > !type);
+
+    return cost;
+}
+
 static int cost_coeffs(MACROBLOCK *mb, BLOCKD *b, int type, ENTROPY_CONTEXT *a, ENTROPY_CONTEXT *l)
 {
     int c = !type;              /* start at coef 0, unless Y with Y2 */
@@ -508,6 +518,9 @@ static int cost_coeffs(MACROBLOCK *mb, BLOCKD *b, int type, ENTROPY_CONTEXT *a,
     int cost = 0;
     short *qcoeff_ptr = b->qcoeff_base + b->qcoeff_offset;;
 
+    if (mb->fast_coef_costing && eob > EST_MIN_EOB)
+        return cost_coeffs_est(mb, b, type, a, l);
+
     VP8_COMBINEENTROPYCONTEXTS(pt, *a, *l);
 
 # define QC( I)  ( qcoeff_ptr [vp8_default_zig_zag1d[I]] )
@@ -639,17 +652,28 @@ static int rd_pick_intra4x4block(
      * */
     DECLARE_ALIGNED_ARRAY(16, unsigned char,  best_predictor, 16*4);
     DECLARE_ALIGNED_ARRAY(16, short, best_dqcoeff, 16);
+    DECLARE_ALIGNED_ARRAY(16, unsigned char, pred, 16 * VP8_BINTRAMODES);
+
+    /* Only the predictors: the distortion below is measured after
+     * quantization, so the SSE of the prediction is not needed.
+     */
+    vp8_intra4x4_predict_all(*(b->base_dst) + b->dst, b->dst_stride,
+                             *(be->base_src) + be->src, be->src_stride,
+                             VP8_BINTRAMODES, pred, NULL);
 
     for (mode = B_DC_PRED; mode <= B_HU_PRED; mode++)
     {
         int this_rd;
         int ratey;
+        unsigned int *p = (unsigned int *)(pred + mode * 16);
+        unsigned int *d = (unsigned int *)(b->predictor_base + b->predictor_offset);
 
         rate = bmode_costs[mode];
 
-        vp8_intra4x4_predict
-                     (*(b->base_dst) + b->dst, b->dst_stride,
-                      mode, b->predictor_base + b->predictor_offset, 16);
+        d[0] = p[0];
+        d[4] = p[1];
+        d[8] = p[2];
+        d[12] = p[3];
         vp8_subtract_b(be, b, 16);
         x->short_fdct4x4(be->src_diff, be->coeff, 32);
         x->quantize_b(be, b);
@@ -1711,9 +1735,17 @@ static void rd_update_mvcount(VP8_COMP *cpi, MACROBLOCK *x, int_mv *best_ref_mv)
 }
 
 
+// Within a pel, as a sub-pel search of steady motion may wander.
+static int history_mv_close(const int_mv *a, const int_mv *b)
+{
+    return abs(a->as_mv.row - b->as_mv.row) <= 8 &&
+           abs(a->as_mv.col - b->as_mv.col) <= 8;
+}
+
 void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                             int recon_uvoffset, int *returnrate,
-                            int *returndistortion, int *returnintra)
+                            int *returndistortion, int *returnintra,
+                            int mb_row, int mb_col)
 {
     BLOCK *b = &x->block[0];
     BLOCKD *d = &x->e_mbd.block[0];
@@ -1752,6 +1784,25 @@ void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
     int ref_frame_map[4];
     int sign_bias = 0;
 
+    MB_MODE_HISTORY *history = NULL;
+    int mode_order[MAX_MODES];
+    int try_index;
+
+#if CONFIG_MULTI_RES_ENCODING
+    int dissim = INT_MAX;
+    int parent_ref_frame = 0;
+    int_mv parent_ref_mv;
+    MB_PREDICTION_MODE parent_mode = 0;
+    int parent_skip = 0;
+
+    parent_ref_mv.as_int = 0;
+
+    if (cpi->oxcf.mr_encoder_id)
+        vp8_mr_get_lower_res_info(cpi, xd, mb_row, mb_col, &dissim,
+                                  &parent_ref_frame, &parent_mode,
+                                  &parent_ref_mv, &parent_skip);
+#endif
+
     mode_mv = mode_mv_sb[sign_bias];
     best_ref_mv.as_int = 0;
     vpx_memset(mode_mv_sb, 0, sizeof(mode_mv_sb));
@@ -1789,12 +1840,34 @@ void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
     rd_pick_intra_mbuv_mode(cpi, x, &uv_intra_rate, &uv_intra_rate_tokenonly, &uv_intra_distortion);
     uv_intra_mode = x->e_mbd.mode_info_context->mbmi.uv_mode;
 
-    for (mode_index = 0; mode_index < MAX_MODES; mode_index++)
+    for (i = 0; i < MAX_MODES; i++)
+        mode_order[i] = i;
+
+    // Try the mode this MB settled on in the previous frames first, so the
+    // rd_threshes checks can drop most of the others early.
+    if (cpi->sf.mode_history)
+    {
+        history = cpi->mode_history +
+                  (x->e_mbd.mode_info_context - cpi->common.mi);
+
+        if (history->run)
+        {
+            for (i = history->mode_index; i > 0; i--)
+                mode_order[i] = i - 1;
+
+            mode_order[0] = history->mode_index;
+        }
+    }
+
+    for (try_index = 0; try_index < MAX_MODES; try_index++)
     {
         int this_rd = INT_MAX;
         int disable_skip = 0;
         int other_cost = 0;
-        int this_ref_frame = ref_frame_map[vp8_ref_frame_order[mode_index]];
+        int this_ref_frame;
+
+        mode_index = mode_order[try_index];
+        this_ref_frame = ref_frame_map[vp8_ref_frame_order[mode_index]];
 
         // Test best rd so far against threshold for trying this mode.
         if (best_rd <= cpi->rd_threshes[mode_index])
@@ -1813,6 +1886,26 @@ void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
         x->e_mbd.mode_info_context->mbmi.uv_mode = DC_PRED;
         x->e_mbd.mode_info_context->mbmi.ref_frame = this_ref_frame;
 
+#if CONFIG_MULTI_RES_ENCODING
+        if (cpi->oxcf.mr_encoder_id)
+        {
+            /* If the parent MB is inter coded and its neighbourhood moves
+             * alike, it most likely covers a single object: only its
+             * reference frame is tried, and no 4x4 intra prediction.
+             */
+            if (parent_ref_frame && dissim < 8
+                && ((this_ref_frame && this_ref_frame != parent_ref_frame)
+                    || this_mode == B_PRED))
+                continue;
+
+            /* A parent coded without residual leaves nothing for a split
+             * to improve on.
+             */
+            if (parent_ref_frame && parent_skip && this_mode == SPLITMV)
+                continue;
+        }
+#endif
+
         // Only consider ZEROMV/ALTREF_FRAME for alt ref frame,
         // unless ARNR filtering is enabled in which case we want
         // an unfiltered alternative
@@ -1835,6 +1928,16 @@ void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
                 mode_mv = mode_mv_sb[sign_bias];
                 best_ref_mv.as_int = best_ref_mv_sb[sign_bias].as_int;
             }
+
+#if CONFIG_MULTI_RES_ENCODING
+            /* Nor is a new MV likely to beat a zero one where the parent
+             * stood still without residual.
+             */
+            if (cpi->oxcf.mr_encoder_id && this_mode == NEWMV
+                && parent_mode == ZEROMV && parent_skip && dissim == 0
+                && best_ref_mv.as_int == 0)
+                continue;
+#endif
         }
 
         // Check to see if the testing frequency for this mode is at its max
@@ -1977,14 +2080,35 @@ void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
             int tmp_row_min = x->mv_row_min;
             int tmp_row_max = x->mv_row_max;
 
-            if(!saddone)
+#if CONFIG_MULTI_RES_ENCODING
+            /* The parent's MV is only meaningful for its own reference
+             * frame. */
+            int use_parent_mv = cpi->oxcf.mr_encoder_id
+                                && parent_ref_frame == this_ref_frame;
+
+            if (use_parent_mv)
             {
-                vp8_cal_sad(cpi,xd,x, recon_yoffset ,&near_sadidx[0] );
-                saddone = 1;
+                // Start from the parent's MV, searching the less far the
+                // more its neighbourhood agrees on it.
+                mvp.as_int = parent_ref_mv.as_int;
+                step_param += vp8_mr_step_adjust(dissim);
             }
+            else
+#endif
+            {
+                if(!saddone)
+                {
+                    vp8_cal_sad(cpi,xd,x, recon_yoffset ,&near_sadidx[0] );
+                    saddone = 1;
+                }
 
-            vp8_mv_pred(cpi, &x->e_mbd, x->e_mbd.mode_info_context, &mvp,
-                        x->e_mbd.mode_info_context->mbmi.ref_frame, cpi->common.ref_frame_sign_bias, &sr, &near_sadidx[0]);
+                vp8_mv_pred(cpi, &x->e_mbd, x->e_mbd.mode_info_context, &mvp,
+                            x->e_mbd.mode_info_context->mbmi.ref_frame, cpi->common.ref_frame_sign_bias, &sr, &near_sadidx[0]);
+
+                //adjust search range according to sr from mv prediction
+                if(sr > step_param)
+                    step_param = sr;
+            }
 
             mvp_full.as_mv.col = mvp.as_mv.col>>3;
             mvp_full.as_mv.row = mvp.as_mv.row>>3;
@@ -1999,10 +2123,24 @@ void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
             if (x->mv_row_max > row_max )
                 x->mv_row_max = row_max;
 
-            //adjust search range according to sr from mv prediction
-            if(sr > step_param)
-                step_param = sr;
+            vp8_hme_seed(cpi, x, &best_ref_mv, &mvp_full, &step_param);
 
+#if CONFIG_MULTI_RES_ENCODING
+            if (use_parent_mv && dissim <= 2)
+            {
+                // Motion agreed on all around the parent: a local
+                // refinement of its MV replaces the step search.
+                vp8_clamp_mv(&mvp_full, x->mv_col_min, x->mv_col_max,
+                             x->mv_row_min, x->mv_row_max);
+                d->bmi.mv.as_int = mvp_full.as_int;
+                bestsme = cpi->refining_search_sad(x, b, d, &d->bmi.mv, sadpb,
+                                       2, &cpi->fn_ptr[BLOCK_16X16],
+                                       x->mvcost, &best_ref_mv);
+                mode_mv[NEWMV].as_int = d->bmi.mv.as_int;
+                do_refine = 0;
+            }
+            else
+#endif
             // Initial step/diamond search
             {
                 bestsme = cpi->diamond_search_sad(x, b, d, &mvp_full, &d->bmi.mv,
@@ -2297,6 +2435,34 @@ void vp8_rd_pick_inter_mode(VP8_COMP *cpi, MACROBLOCK *x, int recon_yoffset,
         if (x->skip)
             break;
 
+        // Stop after the first mode when it kept winning with about the
+        // same motion and costs no more than it did last frame. Bounding
+        // the RD cost by the previous one limits what the skipped modes
+        // could have gained to what they did not gain last time, and the
+        // periodic full search keeps a stale choice from sticking.
+        if (try_index == 0 && history &&
+            history->run >= MODE_HISTORY_MIN_RUN &&
+            best_mode_index == mode_index &&
+            history_mv_close(&best_mbmode.mv, &history->mv) &&
+            best_rd <= history->rd &&
+            (cpi->common.current_video_frame + (history - cpi->mode_history))
+                % MODE_HISTORY_REFRESH)
+            break;
+    }
+
+    if (history && best_rd == INT_MAX)
+        history->run = 0;
+    else if (history)
+    {
+        if (history->run && history->mode_index == best_mode_index &&
+            history_mv_close(&best_mbmode.mv, &history->mv))
+            history->run += (history->run < 255);
+        else
+            history->run = 1;
+
+        history->mode_index = best_mode_index;
+        history->mv.as_int = best_mbmode.mv.as_int;
+        history->rd = best_rd;
     }
 
     // Reduce the activation RD thresholds for the best choice mode
@@ -400,3 +400,95 @@ void vp8_copy32xn_c(
 
     }
 }
+
+
+/* Sum of absolute transformed differences: the residual is put through
+ * the 4x4 Walsh-Hadamard transform, so the result follows what the
+ * residual costs to code much more closely than SAD does. Larger blocks
+ * are tiled with 4x4 transforms like the codec's own.
+ */
+static unsigned int satd4x4(const unsigned char *src_ptr, int src_stride,
+                            const unsigned char *ref_ptr, int ref_stride)
+{
+    int d[16];
+    int i;
+    unsigned int satd = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        int a0 = src_ptr[0] - ref_ptr[0];
+        int a1 = src_ptr[1] - ref_ptr[1];
+        int a2 = src_ptr[2] - ref_ptr[2];
+        int a3 = src_ptr[3] - ref_ptr[3];
+        int b0 = a0 + a1;
+        int b1 = a0 - a1;
+        int b2 = a2 + a3;
+        int b3 = a2 - a3;
+
+        d[i * 4 + 0] = b0 + b2;
+        d[i * 4 + 1] = b1 + b3;
+        d[i * 4 + 2] = b0 - b2;
+        d[i * 4 + 3] = b1 - b3;
+
+        src_ptr += src_stride;
+        ref_ptr += ref_stride;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        int b0 = d[i] + d[4 + i];
+        int b1 = d[i] - d[4 + i];
+        int b2 = d[8 + i] + d[12 + i];
+        int b3 = d[8 + i] - d[12 + i];
+
+        satd += abs(b0 + b2) + abs(b1 + b3) + abs(b0 - b2) + abs(b1 - b3);
+    }
+
+    return (satd + 1) >> 1;
+}
+
+static unsigned int satd_mx_n(const unsigned char *src_ptr, int src_stride,
+                              const unsigned char *ref_ptr, int ref_stride,
+                              int m, int n)
+{
+    int r, c;
+    unsigned int satd = 0;
+
+    for (r = 0; r < n; r += 4)
+    {
+        for (c = 0; c < m; c += 4)
+            satd += satd4x4(src_ptr + c, src_stride, ref_ptr + c, ref_stride);
+
+        src_ptr += 4 * src_stride;
+        ref_ptr += 4 * ref_stride;
+    }
+
+    return satd;
+}
+
+unsigned int vp8_satd4x4_c(
+    const unsigned char *src_ptr,
+    int  src_stride,
+    const unsigned char *ref_ptr,
+    int  ref_stride)
+{
+    return satd4x4(src_ptr, src_stride, ref_ptr, ref_stride);
+}
+
+unsigned int vp8_satd8x8_c(
+    const unsigned char *src_ptr,
+    int  src_stride,
+    const unsigned char *ref_ptr,
+    int  ref_stride)
+{
+    return satd_mx_n(src_ptr, src_stride, ref_ptr, ref_stride, 8, 8);
+}
+
+unsigned int vp8_satd16x16_c(
+    const unsigned char *src_ptr,
+    int  src_stride,
+    const unsigned char *ref_ptr,
+    int  ref_stride)
+{
+    return satd_mx_n(src_ptr, src_stride, ref_ptr, ref_stride, 16, 16);
+}
@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include "onyx_int.h"
+#include "speedctrl.h"
+#include "vpx_mem/vpx_mem.h"
+
+/* Starting estimate of the relative cost of an inter frame at each real
+ * time speed, 256 being speed 4, following what vp8_set_speed_features()
+ * turns off at each step: the hex search without iterative sub-pel at 5,
+ * thresh_mult pruning and the plain MV predictor from 7, the shortened
+ * full pel search at 8, quarter pel at 9, more mode skipping up to 12,
+ * the simple loop filter at 14 and half pel at 15. The correction learnt
+ * when the controller moves between levels refines these on the host.
+ */
+static const int prior_cost[SPEED_CTRL_MAX_SPEED + 1] =
+{
+    256, 256, 256, 256,
+    256, 176, 168, 144, 128, 112, 104, 96, 88, 84, 72, 60, 56
+};
+
+void vp8_speed_ctrl_init(SPEED_CTRL *sc, int percentile)
+{
+    int i;
+
+    vpx_memset(sc, 0, sizeof(*sc));
+
+    for (i = 0; i <= SPEED_CTRL_MAX_SPEED; i++)
+        sc->correction[i] = 256;
+
+    sc->percentile = (percentile < 50 || percentile > 100) ? 99 : percentile;
+    sc->speed = SPEED_CTRL_MIN_SPEED;
+}
+
+static unsigned int predict(const SPEED_CTRL *sc, int speed, int mbs)
+{
+    return (unsigned int)((sc->load * mbs * prior_cost[speed] *
+                           sc->correction[speed]) >> 32);
+}
+
+/* The requested percentile of the recent measured / predicted ratios,
+ * i.e. how much slower than modelled a frame may turn out.
+ */
+static unsigned int percentile_ratio(const SPEED_CTRL *sc)
+{
+    unsigned short sorted[SPEED_CTRL_HISTORY];
+    int i, j, n = sc->ratio_count;
+
+    if (!n)
+        return 256;
+
+    for (i = 0; i < n; i++)
+    {
+        unsigned short r = sc->ratio[i];
+
+        for (j = i; j > 0 && sorted[j - 1] > r; j--)
+            sorted[j] = sorted[j - 1];
+
+        sorted[j] = r;
+    }
+
+    i = (n * sc->percentile + 99) / 100 - 1;
+    return sorted[i < 0 ? 0 : i];
+}
+
+void vp8_speed_ctrl_select(VP8_COMP *cpi)
+{
+    SPEED_CTRL *sc = &cpi->speed_ctrl;
+    const int mbs = cpi->common.MBs;
+    unsigned int budget = (unsigned int)(1000000 / cpi->frame_rate);
+    unsigned int slack = percentile_ratio(sc);
+    int speed;
+
+    budget = budget * (16 - cpi->oxcf.cpu_used) / 16;
+    sc->budget_usec = budget;
+
+    /* Nothing measured yet: stay at the starting level. */
+    if (!sc->load)
+    {
+        cpi->Speed = sc->speed;
+        return;
+    }
+
+    for (speed = SPEED_CTRL_MIN_SPEED; speed < SPEED_CTRL_MAX_SPEED; speed++)
+    {
+        uint64_t t = (uint64_t)predict(sc, speed, mbs) * slack >> 8;
+
+        /* Give speed back one level at a time and only with some headroom
+         * left, so one quick frame does not start an oscillation.
+         */
+        if (speed < sc->speed &&
+            (speed < sc->speed - 1 || t * 16 > (uint64_t)budget * 15))
+            continue;
+
+        if (t <= budget)
+            break;
+    }
+
+    sc->speed = speed;
+    sc->frame_predicted_usec = predict(sc, speed, mbs);
+    sc->predicted_usec = (unsigned int)
+                         ((uint64_t)sc->frame_predicted_usec * slack >> 8);
+    cpi->Speed = speed;
+}
+
+void vp8_speed_ctrl_update(VP8_COMP *cpi, unsigned int frame_usec)
+{
+    SPEED_CTRL *sc = &cpi->speed_ctrl;
+    const int mbs = cpi->common.MBs;
+    int speed = cpi->Speed;
+    int64_t unit, sample;
+
+    sc->last_usec = frame_usec;
+
+    /* Key frames hardly depend on the speed features. */
+    if (cpi->oxcf.cpu_used < 0 || cpi->common.frame_type == KEY_FRAME ||
+        !frame_usec || speed < SPEED_CTRL_MIN_SPEED ||
+        speed > SPEED_CTRL_MAX_SPEED)
+        return;
+
+    sc->frames++;
+
+    if (frame_usec > sc->budget_usec)
+        sc->missed++;
+
+    if (sc->load && sc->frame_predicted_usec)
+    {
+        unsigned int ratio = (unsigned int)
+                             (((uint64_t)frame_usec << 8) / sc->frame_predicted_usec);
+
+        if (ratio > 0xffff)
+            ratio = 0xffff;
+
+        sc->ratio[sc->ratio_idx] = ratio;
+        sc->ratio_idx = (sc->ratio_idx + 1) % SPEED_CTRL_HISTORY;
+
+        if (sc->ratio_count < SPEED_CTRL_HISTORY)
+            sc->ratio_count++;
+
+        /* A level's first frame is predicted from the load measured at
+         * the previous level, so its error is the level's relative cost.
+         */
+        if (speed != sc->last_speed)
+        {
+            int c = (sc->correction[speed] +
+                     (int)(((int64_t)sc->correction[speed] * ratio) >> 8)) / 2;
+
+            sc->correction[speed] = c < 64 ? 64 : c > 1024 ? 1024 : c;
+        }
+    }
+
+    sc->last_speed = speed;
+
+    unit = (int64_t)mbs * prior_cost[speed] * sc->correction[speed];
+    sample = ((int64_t)frame_usec << 32) / unit;
+    sc->load = sc->load ? (3 * sc->load + sample) / 4 : sample;
+}
+
+void vp8_speed_ctrl_get_state(const SPEED_CTRL *sc,
+                              vp8e_rt_speed_state_t *state)
+{
+    state->speed = sc->speed;
+    state->percentile = sc->percentile;
+    state->budget_usec = sc->budget_usec;
+    state->predicted_usec = sc->predicted_usec;
+    state->last_usec = sc->last_usec;
+    state->frames = sc->frames;
+    state->missed = sc->missed;
+}
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#ifndef __INC_SPEEDCTRL_H
+#define __INC_SPEEDCTRL_H
+
+#include "vpx/vpx_integer.h"
+#include "vpx/vp8cx.h"
+
+/* Real time speed controller: picks the speed level, and with it the
+ * SPEED_FEATURES set, of each frame so that a percentile of the frame
+ * encode times stays within the frame budget.
+ */
+#define SPEED_CTRL_MIN_SPEED    4
+#define SPEED_CTRL_MAX_SPEED    16
+#define SPEED_CTRL_HISTORY      64
+
+typedef struct
+{
+    int percentile;
+
+    /* Cost model: a frame at speed s takes about
+     * load * MBs * prior[s] * correction[s] microseconds.
+     */
+    int64_t load;                           /* usec per MB, Q16 */
+    int correction[SPEED_CTRL_MAX_SPEED + 1];  /* learned, Q8 */
+
+    /* Measured / predicted time of recent frames, Q8. */
+    unsigned short ratio[SPEED_CTRL_HISTORY];
+    int ratio_count;
+    int ratio_idx;
+
+    int speed;
+    int last_speed;                         /* of the last measured frame */
+    unsigned int budget_usec;
+    unsigned int predicted_usec;            /* at speed, percentile applied */
+    unsigned int frame_predicted_usec;      /* at speed, raw model */
+    unsigned int last_usec;
+    unsigned int frames;
+    unsigned int missed;
+} SPEED_CTRL;
+
+struct VP8_COMP;
+
+void vp8_speed_ctrl_init(SPEED_CTRL *sc, int percentile);
+void vp8_speed_ctrl_select(struct VP8_COMP *cpi);
+void vp8_speed_ctrl_update(struct VP8_COMP *cpi, unsigned int frame_usec);
+void vp8_speed_ctrl_get_state(const SPEED_CTRL *sc,
+                              vp8e_rt_speed_state_t *state);
+
+#endif
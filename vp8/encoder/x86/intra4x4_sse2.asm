@@ -0,0 +1,348 @@
+;
+;  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+;
+;  Use of this source code is governed by a BSD-style license
+;  that can be found in the LICENSE file in the root of the source
+;  tree. An additional intellectual property rights grant can be found
+;  in the file PATENTS.  All contributing project authors may
+;  be found in the AUTHORS file in the root of the source tree.
+;
+
+
+%include "vpx_ports/x86_abi_support.asm"
+
+; The edges are kept on the stack as two 16 byte rows:
+;   E: L3 L2 L1 L0 TL A0 .. A7 A7 A7 A7   (e[] of the C version)
+;   R: TL L0 L1 L2 L3 L3 .. L3            (the left column top down)
+; with the 3-tap (F) and 2-tap (G) averages of both next to them.
+%define e_row rsp
+%define r_row rsp + 16
+%define f_row rsp + 32
+%define g_row rsp + 48
+%define fr_row rsp + 64
+%define gr_row rsp + 80
+
+; %1 = AVG3(x[k], x[k + 1], x[k + 2]) of the bytes of %3, using %2.
+; (a + 2b + c + 2) >> 2 is pavgb(b, (a + c) >> 1), where the truncating
+; average is the rounding one less the carry of a ^ c.
+%macro AVG3_BYTES 3
+        movdqa          %1,         %3
+        psrldq          %1,         2               ; c
+        movdqa          %2,         %3
+        pxor            %2,         %1
+        pand            %2,         [GLOBAL(t1)]
+        pavgb           %1,         %3
+        psubb           %1,         %2              ; (a + c) >> 1
+        movdqa          %2,         %3
+        psrldq          %2,         1               ; b
+        pavgb           %1,         %2
+%endmacro
+
+; %1 = AVG2(x[k], x[k + 1]) of the bytes of %2.
+%macro AVG2_BYTES 2
+        movdqa          %1,         %2
+        psrldq          %1,         1
+        pavgb           %1,         %2
+%endmacro
+
+; Packs the first dword of each of %1..%4 into %1 as rows 0..3; clobbers %3.
+%macro ROWS 4
+        punpckldq       %1,         %2
+        punpckldq       %3,         %4
+        punpcklqdq      %1,         %3
+%endmacro
+
+; %1 = (%1 & ~mask) | (%2 & mask), the bytes of %2 where mask %3 is set.
+%macro MERGE 4
+        movdqa          %4,         [GLOBAL(%3)]
+        pand            %2,         %4
+        pandn           %4,         %1
+        por             %2,         %4
+        movdqa          %1,         %2
+%endmacro
+
+
+;void vp8_intra4x4_predict_all_sse2(
+;    unsigned char *dst,
+;    int dst_stride,
+;    const unsigned char *src,
+;    int src_stride,
+;    int num_modes,
+;    unsigned char *pred,
+;    unsigned int *sse)                  may be NULL
+global sym(vp8_intra4x4_predict_all_sse2)
+sym(vp8_intra4x4_predict_all_sse2):
+    push        rbp
+    mov         rbp, rsp
+    SHADOW_ARGS_TO_STACK 7
+    SAVE_XMM 7
+    GET_GOT     rbx
+    push        rsi
+    push        rdi
+    ALIGN_STACK 16, rax
+    sub         rsp, 16*6
+    ; end prolog
+
+        mov             rsi,        arg(0)          ; dst
+        movsxd          rax,        dword ptr arg(1) ; dst_stride
+        mov             rdi,        rsi
+        sub             rdi,        rax             ; above row
+        lea             rdx,        [rax + rax*2]
+
+        movq            xmm0,       [rdi]           ; A0 .. A7
+        movq            [e_row + 5], xmm0
+        movzx           ecx,        byte [rdi + 7]
+        mov             [e_row + 13], cl
+        mov             [e_row + 14], cl
+        mov             [e_row + 15], cl
+        movzx           ecx,        byte [rdi - 1]  ; TL
+        mov             [e_row + 4], cl
+        mov             [r_row], cl
+        movzx           ecx,        byte [rsi - 1]  ; L0
+        mov             [e_row + 3], cl
+        mov             [r_row + 1], cl
+        movzx           ecx,        byte [rsi + rax - 1] ; L1
+        mov             [e_row + 2], cl
+        mov             [r_row + 2], cl
+        movzx           ecx,        byte [rsi + rax*2 - 1] ; L2
+        mov             [e_row + 1], cl
+        mov             [r_row + 3], cl
+        movzx           ecx,        byte [rsi + rdx - 1] ; L3
+        mov             [e_row], cl
+        imul            ecx,        ecx,        0x01010101
+        mov             [r_row + 4], ecx
+        mov             [r_row + 8], ecx
+        mov             [r_row + 12], ecx
+
+        movdqa          xmm0,       [e_row]
+        movdqa          xmm1,       [r_row]
+        AVG3_BYTES      xmm2,       xmm3,       xmm0
+        movdqa          [f_row], xmm2
+        AVG2_BYTES      xmm2,       xmm0
+        movdqa          [g_row], xmm2
+        AVG3_BYTES      xmm2,       xmm3,       xmm1
+        movdqa          [fr_row], xmm2
+        AVG2_BYTES      xmm2,       xmm1
+        movdqa          [gr_row], xmm2
+
+        mov             rdi,        arg(5)          ; pred
+        pxor            xmm7,       xmm7
+
+        ; B_DC_PRED: (A0 + .. + A3 + L0 + .. + L3 + 4) >> 3
+        movdqa          xmm0,       [e_row]
+        pand            xmm0,       [GLOBAL(dc_mask)]
+        psadbw          xmm0,       xmm7
+        movdqa          xmm1,       xmm0
+        psrldq          xmm1,       8
+        paddw           xmm0,       xmm1
+        paddw           xmm0,       [GLOBAL(t4)]
+        psrlw           xmm0,       3
+        punpcklbw       xmm0,       xmm0
+        pshuflw         xmm0,       xmm0,       0
+        pshufd          xmm0,       xmm0,       0
+        movdqu          [rdi],      xmm0
+
+        ; B_TM_PRED: A[c] - TL + L[r], clamped by the pack
+        movdqa          xmm0,       [r_row]
+        psrldq          xmm0,       1
+        punpcklbw       xmm0,       xmm0
+        punpcklwd       xmm0,       xmm0            ; L0 x4 .. L3 x4
+        movdqa          xmm1,       xmm0
+        punpcklbw       xmm0,       xmm7            ; rows 0 and 1
+        punpckhbw       xmm1,       xmm7            ; rows 2 and 3
+        movdqa          xmm2,       [e_row]
+        psrldq          xmm2,       5
+        punpcklbw       xmm2,       xmm7
+        punpcklqdq      xmm2,       xmm2            ; A0 .. A3 twice
+        movdqa          xmm3,       [e_row]
+        psrldq          xmm3,       4
+        punpcklbw       xmm3,       xmm7
+        pshuflw         xmm3,       xmm3,       0
+        punpcklqdq      xmm3,       xmm3            ; TL
+        psubw           xmm2,       xmm3
+        paddw           xmm0,       xmm2
+        paddw           xmm1,       xmm2
+        packuswb        xmm0,       xmm1
+        movdqu          [rdi + 16], xmm0
+
+        ; B_VE_PRED: F4 .. F7 in every row
+        movdqa          xmm0,       [f_row]
+        psrldq          xmm0,       4
+        pshufd          xmm0,       xmm0,       0
+        movdqu          [rdi + 32], xmm0
+
+        ; B_HE_PRED: FR[r] across row r
+        movdqa          xmm0,       [fr_row]
+        punpcklbw       xmm0,       xmm0
+        punpcklwd       xmm0,       xmm0
+        movdqu          [rdi + 48], xmm0
+
+        cmp             dword ptr arg(4), 4     ; num_modes > B_HE_PRED + 1
+        jle             .sse
+
+        ; B_LD_PRED: row r is F5+r .. F8+r
+        movdqa          xmm0,       [f_row]
+        psrldq          xmm0,       5
+        movdqa          xmm1,       xmm0
+        psrldq          xmm1,       1
+        movdqa          xmm2,       xmm0
+        psrldq          xmm2,       2
+        movdqa          xmm3,       xmm0
+        psrldq          xmm3,       3
+        ROWS            xmm0,       xmm1,       xmm2,       xmm3
+        movdqu          [rdi + 64], xmm0
+
+        ; B_RD_PRED: row r is F3-r .. F6-r
+        movdqa          xmm3,       [f_row]
+        movdqa          xmm2,       xmm3
+        psrldq          xmm2,       1
+        movdqa          xmm1,       xmm3
+        psrldq          xmm1,       2
+        movdqa          xmm0,       xmm3
+        psrldq          xmm0,       3
+        ROWS            xmm0,       xmm1,       xmm2,       xmm3
+        movdqu          [rdi + 80], xmm0
+
+        ; B_VR_PRED: G4.., F3.., F2 G4 G5 G6, F1 F3 F4 F5
+        movdqa          xmm4,       [f_row]
+        movdqa          xmm5,       [g_row]
+        movdqa          xmm0,       xmm5
+        psrldq          xmm0,       4
+        movdqa          xmm1,       xmm4
+        psrldq          xmm1,       3
+        movdqa          xmm2,       xmm5
+        psrldq          xmm2,       3
+        movdqa          xmm3,       xmm4
+        psrldq          xmm3,       2
+        ROWS            xmm0,       xmm1,       xmm2,       xmm3
+        movdqa          xmm2,       xmm4
+        psrldq          xmm2,       2
+        movdqa          xmm3,       xmm4
+        psrldq          xmm3,       1
+        punpckldq       xmm2,       xmm3
+        pslldq          xmm2,       8               ; F2 in row 2, F1 in row 3
+        MERGE           xmm0,       xmm2,       vr_mask,    xmm6
+        movdqu          [rdi + 96], xmm0
+
+        ; B_VL_PRED: G5.., F5.., G6 G7 G8 F9, F6 F7 F8 F10
+        movdqa          xmm0,       xmm5
+        psrldq          xmm0,       5
+        movdqa          xmm1,       xmm4
+        psrldq          xmm1,       5
+        movdqa          xmm2,       xmm5
+        psrldq          xmm2,       6
+        movdqa          xmm3,       xmm4
+        psrldq          xmm3,       6
+        ROWS            xmm0,       xmm1,       xmm2,       xmm3
+        movdqa          xmm2,       xmm4
+        psrldq          xmm2,       6
+        movdqa          xmm3,       xmm4
+        psrldq          xmm3,       7
+        punpckldq       xmm2,       xmm3
+        pslldq          xmm2,       8               ; F9 in row 2, F10 in row 3
+        MERGE           xmm0,       xmm2,       vl_mask,    xmm6
+        movdqu          [rdi + 112], xmm0
+
+        ; B_HD_PRED: G3 F3 F4 F5, then G and F interleaved going down
+        movdqa          xmm3,       xmm5
+        punpcklbw       xmm3,       xmm4            ; G0 F0 G1 F1 ..
+        movdqa          xmm0,       xmm3
+        psrldq          xmm0,       6
+        movdqa          xmm1,       xmm3
+        psrldq          xmm1,       4
+        movdqa          xmm2,       xmm3
+        psrldq          xmm2,       2
+        ROWS            xmm0,       xmm1,       xmm2,       xmm3
+        psrldq          xmm4,       2               ; F4 F5 in bytes 2 and 3
+        MERGE           xmm0,       xmm4,       hd_mask,    xmm6
+        movdqu          [rdi + 128], xmm0
+
+        ; B_HU_PRED: GR and FR interleaved going up the left column
+        movdqa          xmm3,       [gr_row]
+        punpcklbw       xmm3,       [fr_row]
+        psrldq          xmm3,       2
+        movdqa          xmm0,       xmm3
+        movdqa          xmm1,       xmm3
+        psrldq          xmm1,       2
+        movdqa          xmm2,       xmm3
+        psrldq          xmm2,       4
+        psrldq          xmm3,       6
+        ROWS            xmm0,       xmm1,       xmm2,       xmm3
+        movdqu          [rdi + 144], xmm0
+
+.sse:
+        mov             rdx,        arg(6)          ; sse
+        test            rdx,        rdx
+        jz              .done
+
+        mov             rsi,        arg(2)          ; src
+        movsxd          rax,        dword ptr arg(3) ; src_stride
+        movd            xmm0,       [rsi]
+        movd            xmm1,       [rsi + rax]
+        lea             rsi,        [rsi + rax*2]
+        movd            xmm2,       [rsi]
+        movd            xmm3,       [rsi + rax]
+        punpckldq       xmm0,       xmm1
+        punpckldq       xmm2,       xmm3
+        punpcklqdq      xmm0,       xmm2
+        movdqa          xmm5,       xmm0
+        punpcklbw       xmm5,       xmm7            ; rows 0 and 1
+        punpckhbw       xmm0,       xmm7
+        movdqa          xmm6,       xmm0            ; rows 2 and 3
+
+        movsxd          rcx,        dword ptr arg(4) ; num_modes
+
+.sse_loop:
+        movdqu          xmm0,       [rdi]
+        movdqa          xmm1,       xmm0
+        punpcklbw       xmm0,       xmm7
+        punpckhbw       xmm1,       xmm7
+        psubw           xmm0,       xmm5
+        psubw           xmm1,       xmm6
+        pmaddwd         xmm0,       xmm0
+        pmaddwd         xmm1,       xmm1
+        paddd           xmm0,       xmm1
+        pshufd          xmm1,       xmm0,       0x0e
+        paddd           xmm0,       xmm1
+        pshufd          xmm1,       xmm0,       0x01
+        paddd           xmm0,       xmm1
+        movd            [rdx],      xmm0
+
+        add             rdi,        16
+        add             rdx,        4
+        dec             rcx
+        jg              .sse_loop
+
+.done:
+    ; begin epilog
+    add         rsp, 16*6
+    pop         rsp
+    pop         rdi
+    pop         rsi
+    RESTORE_GOT
+    RESTORE_XMM
+    UNSHADOW_ARGS
+    pop         rbp
+    ret
+
+
+SECTION_RODATA
+align 16
+t1:
+    times 16 db 1
+align 16
+t4:
+    times 8 dw 4
+align 16
+dc_mask:
+    db 0xff, 0xff, 0xff, 0xff, 0, 0xff, 0xff, 0xff
+    db 0xff, 0, 0, 0, 0, 0, 0, 0
+align 16
+vr_mask:
+    db 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0, 0, 0, 0xff, 0, 0, 0
+align 16
+vl_mask:
+    db 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0, 0, 0, 0xff
+align 16
+hd_mask:
+    db 0, 0, 0xff, 0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
@@ -0,0 +1,210 @@
+;
+;  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+;
+;  Use of this source code is governed by a BSD-style license
+;  that can be found in the LICENSE file in the root of the source
+;  tree. An additional intellectual property rights grant can be found
+;  in the file PATENTS.  All contributing project authors may
+;  be found in the AUTHORS file in the root of the source tree.
+;
+
+
+%include "vpx_ports/x86_abi_support.asm"
+
+; Adds the SATD of the two 4x4 blocks at column %2 of the 4 rows at
+; rsi/rdi to xmm6, each halved and rounded like satd4x4() does. %1 is the
+; load: movq for two blocks, movd for one (the other one is all zero).
+; rax/rdx are the strides, rbx/rcx three times the strides, xmm7 is zero.
+%macro SATD_8X4 2
+        %1              xmm0,       [rsi + %2]
+        %1              xmm4,       [rdi + %2]
+        %1              xmm1,       [rsi + rax + %2]
+        %1              xmm5,       [rdi + rdx + %2]
+        punpcklbw       xmm0,       xmm7
+        punpcklbw       xmm4,       xmm7
+        punpcklbw       xmm1,       xmm7
+        punpcklbw       xmm5,       xmm7
+        psubw           xmm0,       xmm4            ; row 0
+        psubw           xmm1,       xmm5            ; row 1
+
+        %1              xmm2,       [rsi + rax*2 + %2]
+        %1              xmm4,       [rdi + rdx*2 + %2]
+        %1              xmm3,       [rsi + rbx + %2]
+        %1              xmm5,       [rdi + rcx + %2]
+        punpcklbw       xmm2,       xmm7
+        punpcklbw       xmm4,       xmm7
+        punpcklbw       xmm3,       xmm7
+        punpcklbw       xmm5,       xmm7
+        psubw           xmm2,       xmm4            ; row 2
+        psubw           xmm3,       xmm5            ; row 3
+
+        ; vertical transform; the order of the rows does not matter
+        movdqa          xmm4,       xmm0
+        paddw           xmm0,       xmm1
+        psubw           xmm4,       xmm1
+        movdqa          xmm5,       xmm2
+        paddw           xmm2,       xmm3
+        psubw           xmm5,       xmm3
+        movdqa          xmm1,       xmm0
+        paddw           xmm0,       xmm2
+        psubw           xmm1,       xmm2
+        movdqa          xmm3,       xmm4
+        paddw           xmm4,       xmm5
+        psubw           xmm3,       xmm5
+
+        ; transpose the two 4x4 blocks to one column per register, the
+        ; left block in the low half
+        movdqa          xmm2,       xmm0
+        punpcklwd       xmm0,       xmm4
+        punpckhwd       xmm2,       xmm4
+        movdqa          xmm5,       xmm1
+        punpcklwd       xmm1,       xmm3
+        punpckhwd       xmm5,       xmm3
+        movdqa          xmm4,       xmm0
+        punpckldq       xmm0,       xmm1
+        punpckhdq       xmm4,       xmm1
+        movdqa          xmm3,       xmm2
+        punpckldq       xmm2,       xmm5
+        punpckhdq       xmm3,       xmm5
+        movdqa          xmm1,       xmm0
+        punpcklqdq      xmm0,       xmm2            ; column 0
+        punpckhqdq      xmm1,       xmm2            ; column 1
+        movdqa          xmm5,       xmm4
+        punpcklqdq      xmm4,       xmm3            ; column 2
+        punpckhqdq      xmm5,       xmm3            ; column 3
+
+        ; horizontal transform
+        movdqa          xmm2,       xmm0
+        paddw           xmm0,       xmm1
+        psubw           xmm2,       xmm1
+        movdqa          xmm3,       xmm4
+        paddw           xmm4,       xmm5
+        psubw           xmm3,       xmm5
+        movdqa          xmm1,       xmm0
+        paddw           xmm0,       xmm4
+        psubw           xmm1,       xmm4
+        movdqa          xmm5,       xmm2
+        paddw           xmm2,       xmm3
+        psubw           xmm5,       xmm3
+
+        ; absolute values, at most 16 * 255 each
+        pxor            xmm3,       xmm3
+        psubw           xmm3,       xmm0
+        pmaxsw          xmm0,       xmm3
+        pxor            xmm4,       xmm4
+        psubw           xmm4,       xmm1
+        pmaxsw          xmm1,       xmm4
+        pxor            xmm3,       xmm3
+        psubw           xmm3,       xmm2
+        pmaxsw          xmm2,       xmm3
+        pxor            xmm4,       xmm4
+        psubw           xmm4,       xmm5
+        pmaxsw          xmm5,       xmm4
+
+        paddw           xmm0,       xmm1
+        paddw           xmm2,       xmm5
+        paddw           xmm0,       xmm2
+
+        ; one sum per block in dwords 0 and 2 (and again in 1 and 3)
+        pcmpeqw         xmm1,       xmm1
+        psrlw           xmm1,       15
+        pmaddwd         xmm0,       xmm1
+        pshufd          xmm1,       xmm0,       0xb1
+        paddd           xmm0,       xmm1
+
+        ; (satd + 1) >> 1
+        pcmpeqd         xmm1,       xmm1
+        psubd           xmm0,       xmm1
+        psrld           xmm0,       1
+        paddd           xmm6,       xmm0
+%endmacro
+
+; Prolog shared by the three sizes: loads the arguments, sets up the
+; strides and clears xmm6/xmm7.
+%macro SATD_PROLOG 0
+    push        rbp
+    mov         rbp, rsp
+    SHADOW_ARGS_TO_STACK 4
+    SAVE_XMM 7
+    push        rsi
+    push        rdi
+    push        rbx
+    ; end prolog
+
+        mov             rsi,        arg(0)          ;src_ptr
+        mov             rdi,        arg(2)          ;ref_ptr
+        movsxd          rax,        dword ptr arg(1) ;src_stride
+        movsxd          rdx,        dword ptr arg(3) ;ref_stride
+        lea             rbx,        [rax + rax*2]
+        lea             rcx,        [rdx + rdx*2]
+        pxor            xmm6,       xmm6
+        pxor            xmm7,       xmm7
+%endmacro
+
+; Returns the sum of the two per block sums in xmm6.
+%macro SATD_EPILOG 0
+        pshufd          xmm0,       xmm6,       0x02
+        paddd           xmm0,       xmm6
+        movq            rax,        xmm0
+
+    ; begin epilog
+    pop         rbx
+    pop         rdi
+    pop         rsi
+    RESTORE_XMM
+    UNSHADOW_ARGS
+    pop         rbp
+    ret
+%endmacro
+
+
+;unsigned int vp8_satd4x4_sse2(
+;    const unsigned char *src_ptr,
+;    int  src_stride,
+;    const unsigned char *ref_ptr,
+;    int  ref_stride)
+global sym(vp8_satd4x4_sse2)
+sym(vp8_satd4x4_sse2):
+    SATD_PROLOG
+        SATD_8X4        movd,       0
+    SATD_EPILOG
+
+
+;unsigned int vp8_satd8x8_sse2(
+;    const unsigned char *src_ptr,
+;    int  src_stride,
+;    const unsigned char *ref_ptr,
+;    int  ref_stride)
+global sym(vp8_satd8x8_sse2)
+sym(vp8_satd8x8_sse2):
+    SATD_PROLOG
+        SATD_8X4        movq,       0
+        lea             rsi,        [rsi + rax*4]
+        lea             rdi,        [rdi + rdx*4]
+        SATD_8X4        movq,       0
+    SATD_EPILOG
+
+
+;unsigned int vp8_satd16x16_sse2(
+;    const unsigned char *src_ptr,
+;    int  src_stride,
+;    const unsigned char *ref_ptr,
+;    int  ref_stride)
+global sym(vp8_satd16x16_sse2)
+sym(vp8_satd16x16_sse2):
+    SATD_PROLOG
+        SATD_8X4        movq,       0
+        SATD_8X4        movq,       8
+        lea             rsi,        [rsi + rax*4]
+        lea             rdi,        [rdi + rdx*4]
+        SATD_8X4        movq,       0
+        SATD_8X4        movq,       8
+        lea             rsi,        [rsi + rax*4]
+        lea             rdi,        [rdi + rdx*4]
+        SATD_8X4        movq,       0
+        SATD_8X4        movq,       8
+        lea             rsi,        [rsi + rax*4]
+        lea             rdi,        [rdi + rdx*4]
+        SATD_8X4        movq,       0
+        SATD_8X4        movq,       8
+    SATD_EPILOG
@@ -40,6 +40,7 @@ struct vp8_extracfg
     vp8e_tuning                 tuning;
     unsigned int                cq_level;         /* constrained quality level */
     unsigned int                rc_max_intra_bitrate_pct;
+    unsigned int                rt_deadline_percentile;
 
 };
 
@@ -73,6 +74,7 @@ static const struct extraconfig_map extracfg_map[] =
             0,                          /* tuning*/
             10,                         /* cq_level */
             0,                          /* rc_max_intra_bitrate_pct */
+            99,                         /* rt_deadline_percentile */
         }
     }
 };
@@ -92,6 +94,24 @@ struct vpx_codec_alg_priv
     vpx_codec_pkt_list_decl(64) pkt_list;              // changed to accomendate the maximum number of lagged frames allowed
     int                         deprecated_mode;
     unsigned int                fixed_kf_cntr;
+#if CONFIG_MULTI_RES_ENCODING
+    int                         mr_seq;
+    int                         mr_registered;  /* counted in info->users */
+#if CONFIG_MULTITHREAD
+    /* The lower resolutions of a multi-resolution encoder code their frame
+     * on a thread of their own, concurrently with the levels above.
+     */
+    pthread_t                   mr_thread;
+    sem_t                       mr_start;
+    int                         mr_thread_running;
+    int                         mr_quit;
+    const vpx_image_t          *mr_img;
+    vpx_codec_pts_t             mr_pts;
+    unsigned long               mr_duration;
+    vpx_enc_frame_flags_t       mr_flags;
+    unsigned long               mr_deadline;
+#endif
+#endif
 };
 
 
@@ -194,6 +214,7 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t      *ctx,
     RANGE_CHECK_HI(vp8_cfg, arnr_strength,   6);
     RANGE_CHECK(vp8_cfg, arnr_type,       1, 3);
     RANGE_CHECK(vp8_cfg, cq_level, 0, 63);
+    RANGE_CHECK(vp8_cfg, rt_deadline_percentile, 50, 100);
     if(finalize && cfg->rc_end_usage == VPX_CQ)
         RANGE_CHECK(vp8_cfg, cq_level,
                     cfg->rc_min_quantizer, cfg->rc_max_quantizer);
@@ -245,6 +266,21 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t      *ctx,
 }
 
 
+/* Whether this level is given the highest resolution's image and scales
+ * it down itself.
+ */
+static int mr_scales_input(vpx_codec_alg_priv_t *ctx)
+{
+#if CONFIG_MULTI_RES_ENCODING
+    return (ctx->base.init_flags & VPX_CODEC_USE_MULTI_RES_SCALING)
+           && ctx->oxcf.mr_total_resolutions > 1
+           && ctx->oxcf.mr_encoder_id < ctx->oxcf.mr_total_resolutions - 1;
+#else
+    return 0;
+#endif
+}
+
+
 static vpx_codec_err_t validate_img(vpx_codec_alg_priv_t *ctx,
                                     const vpx_image_t    *img)
 {
@@ -259,7 +295,12 @@ static vpx_codec_err_t validate_img(vpx_codec_alg_priv_t *ctx,
         ERROR("Invalid image format. Only YV12 and I420 images are supported");
     }
 
-    if ((img->d_w != ctx->cfg.g_w) || (img->d_h != ctx->cfg.g_h))
+    if (mr_scales_input(ctx))
+    {
+        if ((img->d_w < ctx->cfg.g_w) || (img->d_h < ctx->cfg.g_h))
+            ERROR("Image must not be smaller than the encoder's configured size");
+    }
+    else if ((img->d_w != ctx->cfg.g_w) || (img->d_h != ctx->cfg.g_h))
         ERROR("Image size must match encoder init configuration size");
 
     return VPX_CODEC_OK;
@@ -326,6 +367,7 @@ static vpx_codec_err_t set_vp8e_config(VP8_CONFIG *oxcf,
 
     oxcf->target_bandwidth         = cfg.rc_target_bitrate;
     oxcf->rc_max_intra_bitrate_pct = vp8_cfg.rc_max_intra_bitrate_pct;
+    oxcf->rt_deadline_percentile   = vp8_cfg.rt_deadline_percentile;
 
     oxcf->best_allowed_q           = cfg.rc_min_quantizer;
     oxcf->worst_allowed_q          = cfg.rc_max_quantizer;
@@ -514,6 +556,7 @@ static vpx_codec_err_t set_param(vpx_codec_alg_priv_t *ctx,
         MAP(VP8E_SET_TUNING,                xcfg.tuning);
         MAP(VP8E_SET_CQ_LEVEL,              xcfg.cq_level);
         MAP(VP8E_SET_MAX_INTRA_BITRATE_PCT, xcfg.rc_max_intra_bitrate_pct);
+        MAP(VP8E_SET_RT_DEADLINE_PERCENTILE, xcfg.rt_deadline_percentile);
 
     }
 
@@ -536,10 +579,8 @@ static vpx_codec_err_t vp8e_mr_alloc_mem(const vpx_codec_enc_cfg_t *cfg,
     vpx_codec_err_t res = 0;
 
 #if CONFIG_MULTI_RES_ENCODING
-    int mb_rows = ((cfg->g_w + 15) >>4);
-    int mb_cols = ((cfg->g_h + 15) >>4);
-
-    *mem_loc = calloc(mb_rows*mb_cols, sizeof(LOWER_RES_INFO));
+    /* Each level adds its own mode info buffer in vp8e_init(). */
+    *mem_loc = calloc(1, sizeof(LOWER_RES_FRAME_INFO));
     if(!(*mem_loc))
     {
         free(*mem_loc);
@@ -552,6 +593,163 @@ static vpx_codec_err_t vp8e_mr_alloc_mem(const vpx_codec_enc_cfg_t *cfg,
     return res;
 }
 
+#if CONFIG_MULTI_RES_ENCODING
+static vpx_codec_err_t vp8e_encode_frame(vpx_codec_alg_priv_t  *ctx,
+                                         const vpx_image_t     *img,
+                                         vpx_codec_pts_t        pts,
+                                         unsigned long          duration,
+                                         vpx_enc_frame_flags_t  flags,
+                                         unsigned long          deadline);
+
+static void mr_encode_done(vpx_codec_alg_priv_t *ctx, vpx_codec_err_t res)
+{
+    LOWER_RES_FRAME_INFO *info =
+        (LOWER_RES_FRAME_INFO *)ctx->oxcf.mr_low_res_mode_info;
+
+    info->res[ctx->oxcf.mr_encoder_id] = res;
+    vp8_atomic_store_release(&info->done_seq[ctx->oxcf.mr_encoder_id],
+                             ctx->mr_seq);
+}
+
+/* vpx_codec_encode() stops at the first level that fails. Mark the levels
+ * above this one as through with the call, with the same error, so their
+ * stamps agree with the sequence number instead of being left stale.
+ */
+static void mr_skip_higher_levels(vpx_codec_alg_priv_t *ctx,
+                                  vpx_codec_err_t res)
+{
+    LOWER_RES_FRAME_INFO *info =
+        (LOWER_RES_FRAME_INFO *)ctx->oxcf.mr_low_res_mode_info;
+    unsigned int i;
+
+    for (i = ctx->oxcf.mr_encoder_id + 1;
+         i < ctx->oxcf.mr_total_resolutions; i++)
+    {
+        info->res[i] = res;
+        vp8_atomic_store_release(&info->done_seq[i], ctx->mr_seq);
+    }
+}
+
+#if CONFIG_MULTITHREAD
+static THREAD_FUNCTION mr_encode_thread(void *p_data)
+{
+    vpx_codec_alg_priv_t *ctx = (vpx_codec_alg_priv_t *)p_data;
+
+    while (1)
+    {
+        sem_wait(&ctx->mr_start);
+
+        if (ctx->mr_quit)
+            break;
+
+        mr_encode_done(ctx, vp8e_encode_frame(ctx, ctx->mr_img, ctx->mr_pts,
+                                              ctx->mr_duration, ctx->mr_flags,
+                                              ctx->mr_deadline));
+    }
+
+    return 0;
+}
+#endif
+
+static vpx_codec_err_t mr_init(vpx_codec_alg_priv_t *ctx)
+{
+    LOWER_RES_FRAME_INFO *info =
+        (LOWER_RES_FRAME_INFO *)ctx->oxcf.mr_low_res_mode_info;
+    const int id = ctx->oxcf.mr_encoder_id;
+    VP8_COMMON *cm = &ctx->cpi->common;
+
+    info->users++;
+    ctx->mr_registered = 1;
+
+    /* The highest resolution only reads. */
+    if (id == ctx->oxcf.mr_total_resolutions - 1)
+        return VPX_CODEC_OK;
+
+    info->mb_info[id] = calloc(cm->mb_rows * cm->mb_cols,
+                               sizeof(LOWER_RES_INFO));
+    info->row_seq[id] = calloc(cm->mb_rows, sizeof(int));
+
+    if (!info->mb_info[id] || !info->row_seq[id])
+        return VPX_CODEC_MEM_ERROR;
+
+#if CONFIG_MULTITHREAD
+    sem_init(&ctx->mr_start, 0, 0);
+
+    if (pthread_create(&ctx->mr_thread, 0, mr_encode_thread, ctx))
+    {
+        sem_destroy(&ctx->mr_start);
+        return VPX_CODEC_MEM_ERROR;
+    }
+
+    ctx->mr_thread_running = 1;
+#endif
+
+    return VPX_CODEC_OK;
+}
+
+static void mr_remove(vpx_codec_alg_priv_t *ctx)
+{
+    LOWER_RES_FRAME_INFO *info =
+        (LOWER_RES_FRAME_INFO *)ctx->oxcf.mr_low_res_mode_info;
+    const int id = ctx->oxcf.mr_encoder_id;
+
+#if CONFIG_MULTITHREAD
+    if (ctx->mr_thread_running)
+    {
+        ctx->mr_quit = 1;
+        sem_post(&ctx->mr_start);
+        pthread_join(ctx->mr_thread, 0);
+        sem_destroy(&ctx->mr_start);
+        ctx->mr_thread_running = 0;
+    }
+#endif
+
+    /* A level whose init failed before mr_init() holds no share of the
+     * info; the levels that did may still be using it.
+     */
+    if (!info || !ctx->mr_registered)
+        return;
+
+    ctx->mr_registered = 0;
+
+    if (id < ctx->oxcf.mr_total_resolutions - 1)
+    {
+        free(info->mb_info[id]);
+        free(info->row_seq[id]);
+        info->mb_info[id] = NULL;
+        info->row_seq[id] = NULL;
+    }
+
+    /* Free multi-encoder shared memory with its last user */
+    if (--info->users <= 0)
+        free(info);
+}
+
+/* Wait for the levels below this one to be through with the encode call
+ * and pick up the first error any of them had.
+ */
+static vpx_codec_err_t mr_join_lower_levels(vpx_codec_alg_priv_t *ctx,
+                                            vpx_codec_err_t res)
+{
+    LOWER_RES_FRAME_INFO *info =
+        (LOWER_RES_FRAME_INFO *)ctx->oxcf.mr_low_res_mode_info;
+    unsigned int i;
+
+    for (i = 0; i < ctx->oxcf.mr_encoder_id; i++)
+    {
+#if CONFIG_MULTITHREAD
+        while (vp8_atomic_load_acquire(&info->done_seq[i]) != ctx->mr_seq)
+            thread_sleep(0);
+#endif
+
+        if (!res)
+            res = (vpx_codec_err_t)info->res[i];
+    }
+
+    return res;
+}
+#endif
+
 static vpx_codec_err_t vp8e_init(vpx_codec_ctx_t *ctx,
                                  vpx_codec_priv_enc_mr_cfg_t *mr_cfg)
 {
@@ -635,6 +833,11 @@ static vpx_codec_err_t vp8e_init(vpx_codec_ctx_t *ctx,
             else
                 ctx->priv->alg_priv->cpi = optr;
         }
+
+#if CONFIG_MULTI_RES_ENCODING
+        if (!res && mr_cfg)
+            res = mr_init(priv);
+#endif
     }
 
     return res;
@@ -643,9 +846,8 @@ static vpx_codec_err_t vp8e_init(vpx_codec_ctx_t *ctx,
 static vpx_codec_err_t vp8e_destroy(vpx_codec_alg_priv_t *ctx)
 {
 #if CONFIG_MULTI_RES_ENCODING
-    /* Free multi-encoder shared memory */
-    if (ctx->oxcf.mr_total_resolutions > 0 && (ctx->oxcf.mr_encoder_id == ctx->oxcf.mr_total_resolutions-1))
-        free(ctx->oxcf.mr_low_res_mode_info);
+    if (ctx->oxcf.mr_total_resolutions > 0)
+        mr_remove(ctx);
 #endif
 
     free(ctx->cx_data);
@@ -732,12 +934,12 @@ static void pick_quickcompress_mode(vpx_codec_alg_priv_t  *ctx,
 }
 
 
-static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t  *ctx,
-                                   const vpx_image_t     *img,
-                                   vpx_codec_pts_t        pts,
-                                   unsigned long          duration,
-                                   vpx_enc_frame_flags_t  flags,
-                                   unsigned long          deadline)
+static vpx_codec_err_t vp8e_encode_frame(vpx_codec_alg_priv_t  *ctx,
+                                         const vpx_image_t     *img,
+                                         vpx_codec_pts_t        pts,
+                                         unsigned long          duration,
+                                         vpx_enc_frame_flags_t  flags,
+                                         unsigned long          deadline)
 {
     vpx_codec_err_t res = VPX_CODEC_OK;
 
@@ -838,6 +1040,20 @@ static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t  *ctx,
         {
             res = image2yuvconfig(img, &sd);
 
+#if CONFIG_MULTI_RES_ENCODING
+            if (mr_scales_input(ctx))
+            {
+                if (vp8_receive_scaled_raw_frame(ctx->cpi,
+                                                 ctx->next_frame_flag | lib_flags,
+                                                 &sd, dst_time_stamp,
+                                                 dst_end_time_stamp))
+                {
+                    VP8_COMP *cpi = (VP8_COMP *)ctx->cpi;
+                    res = update_error_state(ctx, &cpi->common.error);
+                }
+            }
+            else
+#endif
             if (vp8_receive_raw_frame(ctx->cpi, ctx->next_frame_flag | lib_flags,
                                       &sd, dst_time_stamp, dst_end_time_stamp))
             {
@@ -948,6 +1164,67 @@ static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t  *ctx,
 }
 
 
+static vpx_codec_err_t vp8e_encode(vpx_codec_alg_priv_t  *ctx,
+                                   const vpx_image_t     *img,
+                                   vpx_codec_pts_t        pts,
+                                   unsigned long          duration,
+                                   vpx_enc_frame_flags_t  flags,
+                                   unsigned long          deadline)
+{
+#if CONFIG_MULTI_RES_ENCODING
+    if (ctx->oxcf.mr_total_resolutions > 1)
+    {
+        LOWER_RES_FRAME_INFO *info =
+            (LOWER_RES_FRAME_INFO *)ctx->oxcf.mr_low_res_mode_info;
+        vpx_codec_err_t res;
+
+        /* vpx_codec_encode() calls the levels from the lowest resolution
+         * up. The levels below the top one hand their frame to their
+         * thread and return; each higher resolution reads the modes of
+         * the level below row by row as they are stored, and the top
+         * level, coded here, waits for all of them before returning.
+         * Frames that can come out of the lookahead more than one per
+         * call are coded level after level as before.
+         */
+        if (ctx->oxcf.mr_encoder_id == 0)
+            info->seq++;
+
+        ctx->mr_seq = info->seq;
+        ctx->cpi->mr_seq = ctx->mr_seq;
+
+#if CONFIG_MULTITHREAD
+        if (ctx->mr_thread_running && img && !ctx->cfg.g_lag_in_frames)
+        {
+            ctx->mr_img = img;
+            ctx->mr_pts = pts;
+            ctx->mr_duration = duration;
+            ctx->mr_flags = flags;
+            ctx->mr_deadline = deadline;
+            sem_post(&ctx->mr_start);
+            return VPX_CODEC_OK;
+        }
+#endif
+
+        res = vp8e_encode_frame(ctx, img, pts, duration, flags, deadline);
+        mr_encode_done(ctx, res);
+
+        /* Whatever the outcome, the lower levels handed to their threads
+         * are joined before returning, so the caller may release the
+         * image. On an error the levels above are not called at all.
+         */
+        res = mr_join_lower_levels(ctx, res);
+
+        if (res)
+            mr_skip_higher_levels(ctx, res);
+
+        return res;
+    }
+#endif
+
+    return vp8e_encode_frame(ctx, img, pts, duration, flags, deadline);
+}
+
+
 static const vpx_codec_cx_pkt_t *vp8e_get_cxdata(vpx_codec_alg_priv_t  *ctx,
         vpx_codec_iter_t      *iter)
 {
@@ -1167,6 +1444,54 @@ static vpx_codec_err_t vp8e_set_scalemode(vpx_codec_alg_priv_t *ctx,
 }
 
 
+static vpx_codec_err_t vp8e_get_mt_sync_stats(vpx_codec_alg_priv_t *ctx,
+        int ctr_id,
+        va_list args)
+{
+    vp8_mt_sync_stats_t *data = va_arg(args, vp8_mt_sync_stats_t *);
+
+    if (data)
+    {
+        vp8_get_mt_sync_stats(ctx->cpi, data);
+        return VPX_CODEC_OK;
+    }
+    else
+        return VPX_CODEC_INVALID_PARAM;
+}
+
+
+static vpx_codec_err_t vp8e_get_mem_stats(vpx_codec_alg_priv_t *ctx,
+        int ctr_id,
+        va_list args)
+{
+    vp8_mem_stats_t *data = va_arg(args, vp8_mem_stats_t *);
+
+    if (data)
+    {
+        vp8_get_mem_stats(ctx->cpi, data);
+        return VPX_CODEC_OK;
+    }
+    else
+        return VPX_CODEC_INVALID_PARAM;
+}
+
+
+static vpx_codec_err_t vp8e_get_rt_speed_state(vpx_codec_alg_priv_t *ctx,
+        int ctr_id,
+        va_list args)
+{
+    vp8e_rt_speed_state_t *data = va_arg(args, vp8e_rt_speed_state_t *);
+
+    if (data)
+    {
+        vp8_get_rt_speed_state(ctx->cpi, data);
+        return VPX_CODEC_OK;
+    }
+    else
+        return VPX_CODEC_INVALID_PARAM;
+}
+
+
 static vpx_codec_ctrl_fn_map_t vp8e_ctf_maps[] =
 {
     {VP8_SET_REFERENCE,                 vp8e_set_reference},
@@ -1193,6 +1518,10 @@ static vpx_codec_ctrl_fn_map_t vp8e_ctf_maps[] =
     {VP8E_SET_TUNING,                   set_param},
     {VP8E_SET_CQ_LEVEL,                 set_param},
     {VP8E_SET_MAX_INTRA_BITRATE_PCT,    set_param},
+    {VP8E_GET_MT_SYNC_STATS,            vp8e_get_mt_sync_stats},
+    {VP8E_SET_RT_DEADLINE_PERCENTILE,   set_param},
+    {VP8E_GET_RT_SPEED_STATE,           vp8e_get_rt_speed_state},
+    {VP8E_GET_MEM_STATS,                vp8e_get_mem_stats},
     { -1, NULL},
 };
 
@@ -1266,7 +1595,11 @@ CODEC_INTERFACE(vpx_codec_vp8_cx) =
     "WebM Project VP8 Encoder" VERSION_STRING,
     VPX_CODEC_INTERNAL_ABI_VERSION,
     VPX_CODEC_CAP_ENCODER | VPX_CODEC_CAP_PSNR |
-    VPX_CODEC_CAP_OUTPUT_PARTITION,
+    VPX_CODEC_CAP_OUTPUT_PARTITION
+#if CONFIG_MULTI_RES_ENCODING
+    | VPX_CODEC_CAP_MULTI_RES_SCALING
+#endif
+    ,
     /* vpx_codec_caps_t          caps; */
     vp8e_init,          /* vpx_codec_init_fn_t       init; */
     vp8e_destroy,       /* vpx_codec_destroy_fn_t    destroy; */
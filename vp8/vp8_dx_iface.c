@@ -64,6 +64,9 @@ struct vpx_codec_alg_priv
     struct VP8D_COMP       *pbi;
     int                     postproc_cfg_set;
     vp8_postproc_cfg_t      postproc_cfg;
+    vp8_frame_buffer_functions_t fb_functions;
+    int                     unbordered_refs;
+    int                     frame_mem_id;
 #if CONFIG_POSTPROC_VISUALIZER
     unsigned int            dbg_postproc_flag;
     int                     dbg_color_ref_frame_flag;
@@ -415,6 +418,8 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t  *ctx,
                     (ctx->base.init_flags & VPX_CODEC_USE_ERROR_CONCEALMENT);
             oxcf.input_fragments =
                     (ctx->base.init_flags & VPX_CODEC_USE_INPUT_FRAGMENTS);
+            oxcf.unbordered_refs = ctx->unbordered_refs;
+            oxcf.frame_mem_id = ctx->frame_mem_id;
 
             optr = vp8dx_create_decompressor(&oxcf);
 
@@ -433,7 +438,12 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t  *ctx,
             if (!optr)
                 res = VPX_CODEC_ERROR;
             else
+            {
                 ctx->pbi = optr;
+
+                if (ctx->fb_functions.get_fb)
+                    vp8dx_set_frame_buffer_functions(optr, &ctx->fb_functions);
+            }
         }
 
         ctx->decoder_init = 1;
@@ -466,6 +476,8 @@ static vpx_codec_err_t vp8_decode(vpx_codec_alg_priv_t  *ctx,
 #endif
         }
 
+        vp8dx_set_postproc_flags(ctx->pbi, &flags);
+
         if (vp8dx_receive_compressed_data(ctx->pbi, data_sz, data, deadline))
         {
             VP8D_COMP *pbi = (VP8D_COMP *)ctx->pbi;
@@ -754,6 +766,119 @@ static vpx_codec_err_t vp8_get_frame_corrupted(vpx_codec_alg_priv_t *ctx,
 
 }
 
+static vpx_codec_err_t vp8_get_mt_sync_stats(vpx_codec_alg_priv_t *ctx,
+                                             int ctrl_id,
+                                             va_list args)
+{
+
+    vp8_mt_sync_stats_t *stats = va_arg(args, vp8_mt_sync_stats_t *);
+
+    if (stats)
+    {
+        memset(stats, 0, sizeof(*stats));
+#if CONFIG_MULTITHREAD
+        if (ctx->pbi && ctx->pbi->b_multithreaded_rd)
+            vp8_mt_sync_get_stats(&ctx->pbi->mt_sync, stats);
+#endif
+
+        return VPX_CODEC_OK;
+    }
+    else
+        return VPX_CODEC_INVALID_PARAM;
+
+}
+
+static vpx_codec_err_t vp8_get_mem_stats(vpx_codec_alg_priv_t *ctx,
+                                         int ctrl_id,
+                                         va_list args)
+{
+    vp8_mem_stats_t *stats = va_arg(args, vp8_mem_stats_t *);
+
+    if (!stats)
+        return VPX_CODEC_INVALID_PARAM;
+
+    memset(stats, 0, sizeof(*stats));
+
+    if (ctx->pbi)
+        vp8dx_get_mem_stats(ctx->pbi, stats);
+
+    return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t vp8_set_frame_buffer_functions(vpx_codec_alg_priv_t *ctx,
+                                                      int ctrl_id,
+                                                      va_list args)
+{
+    vp8_frame_buffer_functions_t *functions =
+        va_arg(args, vp8_frame_buffer_functions_t *);
+
+    if (!functions || (functions->get_fb && !functions->release_fb))
+        return VPX_CODEC_INVALID_PARAM;
+
+    /* The decoder instance is created with the first frame. */
+    if (ctx->pbi)
+        return VPX_CODEC_ERROR;
+
+    ctx->fb_functions = *functions;
+    return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t vp8_get_frame_buffer(vpx_codec_alg_priv_t *ctx,
+                                            int ctrl_id,
+                                            va_list args)
+{
+    vp8_frame_buffer_t *fb = va_arg(args, vp8_frame_buffer_t *);
+
+    if (fb)
+    {
+        memset(fb, 0, sizeof(*fb));
+
+        /* data stays NULL for an image in decoder owned memory. */
+        if (ctx->pbi && ctx->img_avail)
+            vp8dx_get_frame_buffer(ctx->pbi, ctx->img.planes[VPX_PLANE_Y], fb);
+
+        return VPX_CODEC_OK;
+    }
+    else
+        return VPX_CODEC_INVALID_PARAM;
+}
+
+static vpx_codec_err_t vp8_set_unbordered_refs(vpx_codec_alg_priv_t *ctx,
+                                               int ctrl_id,
+                                               va_list args)
+{
+    /* The decoder instance is created with the first frame. */
+    if (ctx->pbi)
+        return VPX_CODEC_ERROR;
+
+    ctx->unbordered_refs = va_arg(args, int) != 0;
+    return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t vp8_set_frame_placement(vpx_codec_alg_priv_t *ctx,
+                                               int ctrl_id,
+                                               va_list args)
+{
+    int flags = va_arg(args, int);
+
+    if (flags & ~(VP8D_FRAME_HUGEPAGES | VP8D_FRAME_NUMA_LOCAL))
+        return VPX_CODEC_INVALID_PARAM;
+
+    if (ctx->pbi)
+        return VPX_CODEC_ERROR;
+
+    ctx->frame_mem_id = 0;
+
+    if (flags & VP8D_FRAME_HUGEPAGES)
+        ctx->frame_mem_id |= VPX_MEM_HUGEPAGES;
+
+    if (flags & VP8D_FRAME_NUMA_LOCAL)
+        ctx->frame_mem_id |= VPX_MEM_NUMA_LOCAL;
+
+    return VPX_CODEC_OK;
+}
+
+
 vpx_codec_ctrl_fn_map_t vp8_ctf_maps[] =
 {
     {VP8_SET_REFERENCE,             vp8_set_reference},
@@ -766,6 +891,12 @@ vpx_codec_ctrl_fn_map_t vp8_ctf_maps[] =
     {VP8D_GET_LAST_REF_UPDATES,     vp8_get_last_ref_updates},
     {VP8D_GET_FRAME_CORRUPTED,      vp8_get_frame_corrupted},
     {VP8D_GET_LAST_REF_USED,        vp8_get_last_ref_frame},
+    {VP8D_GET_MT_SYNC_STATS,        vp8_get_mt_sync_stats},
+    {VP8D_SET_FRAME_BUFFER_FUNCTIONS, vp8_set_frame_buffer_functions},
+    {VP8D_GET_FRAME_BUFFER,         vp8_get_frame_buffer},
+    {VP8D_SET_UNBORDERED_REFS,      vp8_set_unbordered_refs},
+    {VP8D_SET_FRAME_PLACEMENT,      vp8_set_frame_placement},
+    {VP8D_GET_MEM_STATS,            vp8_get_mem_stats},
     { -1, NULL},
 };
 
@@ -10,9 +10,9 @@
 
 /*
  * This is an example demonstrating multi-resolution encoding in VP8.
- * High-resolution input video is down-sampled to lower-resolutions. The
- * encoder then encodes the video and outputs multiple bitstreams with
- * different resolutions.
+ * High-resolution input video is down-sampled to lower-resolutions by the
+ * encoder (VPX_CODEC_USE_MULTI_RES_SCALING), which then encodes the video
+ * and outputs multiple bitstreams with different resolutions.
  */
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,11 +39,6 @@
  */
 #define NUM_ENCODERS 3
 
-/* This example uses the scaler function in libyuv. */
-#include "third_party/libyuv/include/libyuv/basic_types.h"
-#include "third_party/libyuv/include/libyuv/scale.h"
-#include "third_party/libyuv/include/libyuv/cpu_id.h"
-
 static double vp8_mse2psnr(double Samples, double Peak, double Mse)
 {
     double psnr;
@@ -190,7 +185,7 @@ int main(int argc, char **argv)
     vpx_codec_ctx_t      codec[NUM_ENCODERS];
     vpx_codec_enc_cfg_t  cfg[NUM_ENCODERS];
     vpx_codec_pts_t      frame_cnt = 0;
-    vpx_image_t          raw[NUM_ENCODERS];
+    vpx_image_t          raw;
     vpx_codec_err_t      res[NUM_ENCODERS];
 
     int                  i;
@@ -311,12 +306,12 @@ int main(int argc, char **argv)
         if((cfg[i].g_h)%2)cfg[i].g_h++;
     }
 
-    /* Allocate image for each encoder */
-    for (i=0; i< NUM_ENCODERS; i++)
-        if(!vpx_img_alloc(&raw[i], VPX_IMG_FMT_I420, cfg[i].g_w, cfg[i].g_h, 32))
-            die("Failed to allocate image", cfg[i].g_w, cfg[i].g_h);
+    /* Allocate image for the highest resolution; the encoder scales it
+     * down for the others. */
+    if(!vpx_img_alloc(&raw, VPX_IMG_FMT_I420, cfg[0].g_w, cfg[0].g_h, 32))
+        die("Failed to allocate image", cfg[0].g_w, cfg[0].g_h);
 
-    if (raw[0].stride[VPX_PLANE_Y] == raw[0].d_w)
+    if (raw.stride[VPX_PLANE_Y] == raw.d_w)
         read_frame_p = read_frame;
     else
         read_frame_p = read_frame_by_row;
@@ -326,6 +321,7 @@ int main(int argc, char **argv)
 
     /* Initialize multi-encoder */
     if(vpx_codec_enc_init_multi(&codec[0], interface, &cfg[0], NUM_ENCODERS,
+                                VPX_CODEC_USE_MULTI_RES_SCALING |
                                 (show_psnr ? VPX_CODEC_USE_PSNR : 0), &dsf[0]))
         die_codec(&codec[0], "Failed to initialize encoder");
 
@@ -361,27 +357,10 @@ int main(int argc, char **argv)
         const vpx_codec_cx_pkt_t *pkt[NUM_ENCODERS];
 
         flags = 0;
-        frame_avail = read_frame_p(infile, &raw[0]);
-
-        if(frame_avail)
-        {
-            for ( i=1; i<NUM_ENCODERS; i++)
-            {
-                /*Scale the image down a number of times by downsampling factor*/
-                /* FilterMode 1 or 2 give better psnr than FilterMode 0. */
-                I420Scale(raw[i-1].planes[VPX_PLANE_Y], raw[i-1].stride[VPX_PLANE_Y],
-                          raw[i-1].planes[VPX_PLANE_U], raw[i-1].stride[VPX_PLANE_U],
-                          raw[i-1].planes[VPX_PLANE_V], raw[i-1].stride[VPX_PLANE_V],
-                          raw[i-1].d_w, raw[i-1].d_h,
-                          raw[i].planes[VPX_PLANE_Y], raw[i].stride[VPX_PLANE_Y],
-                          raw[i].planes[VPX_PLANE_U], raw[i].stride[VPX_PLANE_U],
-                          raw[i].planes[VPX_PLANE_V], raw[i].stride[VPX_PLANE_V],
-                          raw[i].d_w, raw[i].d_h, 1);
-            }
-        }
+        frame_avail = read_frame_p(infile, &raw);
 
         /* Encode each frame at multi-levels */
-        if(vpx_codec_encode(&codec[0], frame_avail? &raw[0] : NULL,
+        if(vpx_codec_encode(&codec[0], frame_avail? &raw : NULL,
             frame_cnt, 1, flags, arg_deadline))
             die_codec(&codec[0], "Failed to encode frame");
 
@@ -455,9 +434,9 @@ int main(int argc, char **argv)
         if(!fseek(outfile[i], 0, SEEK_SET))
             write_ivf_file_header(outfile[i], &cfg[i], frame_cnt-1);
         fclose(outfile[i]);
-
-        vpx_img_free(&raw[i]);
     }
 
+    vpx_img_free(&raw);
+
     return EXIT_SUCCESS;
 }
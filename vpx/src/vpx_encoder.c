@@ -44,6 +44,9 @@ vpx_codec_err_t vpx_codec_enc_init_ver(vpx_codec_ctx_t      *ctx,
     else if ((flags & VPX_CODEC_USE_OUTPUT_PARTITION)
              && !(iface->caps & VPX_CODEC_CAP_OUTPUT_PARTITION))
         res = VPX_CODEC_INCAPABLE;
+    else if ((flags & VPX_CODEC_USE_MULTI_RES_SCALING)
+             && !(iface->caps & VPX_CODEC_CAP_MULTI_RES_SCALING))
+        res = VPX_CODEC_INCAPABLE;
     else
     {
         ctx->iface = iface;
@@ -92,6 +95,9 @@ vpx_codec_err_t vpx_codec_enc_init_multi_ver(vpx_codec_ctx_t      *ctx,
     else if ((flags & VPX_CODEC_USE_OUTPUT_PARTITION)
              && !(iface->caps & VPX_CODEC_CAP_OUTPUT_PARTITION))
         res = VPX_CODEC_INCAPABLE;
+    else if ((flags & VPX_CODEC_USE_MULTI_RES_SCALING)
+             && !(iface->caps & VPX_CODEC_CAP_MULTI_RES_SCALING))
+        res = VPX_CODEC_INCAPABLE;
     else
     {
         int i;
@@ -140,6 +146,7 @@ vpx_codec_err_t vpx_codec_enc_init_multi_ver(vpx_codec_ctx_t      *ctx,
                 cfg++;
                 dsf++;
             }
+            ctx -= i;
         }
     }
 
@@ -228,11 +235,17 @@ vpx_codec_err_t  vpx_codec_encode(vpx_codec_ctx_t            *ctx,
              * Encode multi-levels in reverse order. For example,
              * if mr_total_resolutions = 3, first encode level 2,
              * then encode level 1, and finally encode level 0.
+             * The codec may return from the lower levels before they are
+             * done, as long as the call for level 0 waits for them.
+             * With VPX_CODEC_USE_MULTI_RES_SCALING every level is given
+             * the level 0 image and scales it down itself.
              */
             int i;
+            int step = (ctx->init_flags & VPX_CODEC_USE_MULTI_RES_SCALING)
+                       ? 0 : 1;
 
             ctx += num_enc - 1;
-            if (img) img += num_enc - 1;
+            if (img) img += (num_enc - 1) * step;
 
             for (i = num_enc-1; i >= 0; i--)
             {
@@ -241,7 +254,7 @@ vpx_codec_err_t  vpx_codec_encode(vpx_codec_ctx_t            *ctx,
                     break;
 
                 ctx--;
-                if (img) img--;
+                if (img) img -= step;
             }
             ctx++;
         }
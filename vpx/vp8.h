@@ -64,6 +64,7 @@ enum vp8_postproc_level
     VP8_DEBUG_TXT_DC_DIFF       = 1<<5, /**< print dc diff for each macro block */
     VP8_DEBUG_TXT_RATE_INFO     = 1<<6, /**< print video rate info (encoder only) */
     VP8_MFQE                    = 1<<10,
+    VP8_MB_ADAPTIVE             = 1<<11, /**< deblock each macroblock as coded, keeping static ones */
 };
 
 /*!\brief post process flags
@@ -80,6 +81,40 @@ typedef struct vp8_postproc_cfg
     int noise_level;            /**< the strength of additive noise, valid range [0, 16] */
 } vp8_postproc_cfg_t;
 
+/*!\brief multithreaded wavefront statistics
+ *
+ * Describes how the MB row threads synchronized while coding the last frame.
+ * All fields are zero when the codec is running single threaded.
+ */
+typedef struct vp8_mt_sync_stats
+{
+    int          sync_range;    /**< MB columns between progress checks, as chosen for the next frame */
+    int          threads;       /**< number of threads working on the last frame */
+    unsigned int sync_points;   /**< progress checks made on the last frame */
+    unsigned int stalls;        /**< checks that had to wait for the row above */
+    unsigned int stall_usec;    /**< time spent waiting, summed over all threads */
+    unsigned int frame_usec;    /**< wall time of the last frame's MB row loop */
+} vp8_mt_sync_stats_t;
+
+/*!\brief memory statistics
+ *
+ * Bytes of memory a codec instance holds, by what holds them. They cover
+ * the allocations that grow with the frame size, the threads and the lag;
+ * small fixed ones are left out. Frame buffers supplied by the
+ * application don't count. The peak is sampled after each frame.
+ */
+typedef struct vp8_mem_stats
+{
+    size_t frame_buffers;   /**< reference, working and postprocessed frames */
+    size_t thread_buffers;  /**< per-thread state and row buffers */
+    size_t token_buffers;   /**< encoder token buffer */
+    size_t lookahead;       /**< encoder source frame queue */
+    size_t opencl;          /**< OpenCL device mirrors of the frames */
+    size_t other;           /**< mode info and the rest of the instance */
+    size_t total;           /**< sum of the above */
+    size_t peak;            /**< largest total so far */
+} vp8_mem_stats_t;
+
 /*!\brief reference frame type
  *
  * The set of macros define the type of VP8 reference frames
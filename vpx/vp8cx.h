@@ -178,6 +178,25 @@ enum vp8e_enc_control_id
      *
      */
     VP8E_SET_MAX_INTRA_BITRATE_PCT,
+
+    VP8E_GET_MT_SYNC_STATS,          /**< return the multithreaded wavefront
+                                          statistics of the last frame */
+
+    /*!\brief Deadline percentile of the real time speed controller
+     *
+     * With a positive cpu_used in real time mode the encoder picks its
+     * speed features per frame so that this percentile of the frame
+     * encode times stays within the per frame budget.
+     *
+     * \note Valid range: 50..100, default 99
+     */
+    VP8E_SET_RT_DEADLINE_PERCENTILE,
+
+    VP8E_GET_RT_SPEED_STATE,         /**< return the state of the real time
+                                          speed controller */
+
+    VP8E_GET_MEM_STATS,              /**< return the memory the encoder holds,
+                                          see #vp8_mem_stats_t */
 };
 
 /*!\brief vpx 1-D scaling mode
@@ -234,6 +253,22 @@ typedef struct vpx_scaling_mode
     VPX_SCALING_MODE    v_scaling_mode;  /**< vertical scaling mode   */
 } vpx_scaling_mode_t;
 
+/*!\brief real time speed controller state
+ *
+ * Returned by #VP8E_GET_RT_SPEED_STATE. All times are in microseconds.
+ */
+typedef struct vp8e_rt_speed_state
+{
+    int          speed;          /**< speed level picked for the next frame */
+    int          percentile;     /**< deadline percentile being met */
+    unsigned int budget_usec;    /**< per frame encode time budget */
+    unsigned int predicted_usec; /**< modelled time of the next frame at
+                                      that percentile */
+    unsigned int last_usec;      /**< measured time of the last frame */
+    unsigned int frames;         /**< inter frames measured */
+    unsigned int missed;         /**< of those, frames over the budget */
+} vp8e_rt_speed_state_t;
+
 /*!\brief VP8 encoding mode
  *
  * This defines VP8 encoding mode
@@ -311,6 +346,12 @@ VPX_CTRL_USE_TYPE(VP8E_GET_LAST_QUANTIZER_64,  int *)
 
 VPX_CTRL_USE_TYPE(VP8E_SET_MAX_INTRA_BITRATE_PCT, unsigned int)
 
+VPX_CTRL_USE_TYPE(VP8E_GET_MT_SYNC_STATS,      vp8_mt_sync_stats_t *)
+
+VPX_CTRL_USE_TYPE(VP8E_SET_RT_DEADLINE_PERCENTILE, unsigned int)
+VPX_CTRL_USE_TYPE(VP8E_GET_RT_SPEED_STATE,     vp8e_rt_speed_state_t *)
+VPX_CTRL_USE_TYPE(VP8E_GET_MEM_STATS,          vp8_mem_stats_t *)
+
 
 /*! @} - end defgroup vp8_encoder */
 #include "vpx_codec_impl_bottom.h"
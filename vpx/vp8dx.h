@@ -60,10 +60,104 @@ enum vp8_dec_control_id
      */
     VP8D_GET_LAST_REF_USED,
 
+    /** control function to get the multithreaded wavefront statistics of
+     *  the last decode
+     */
+    VP8D_GET_MT_SYNC_STATS,
+
+    /** control function to decode into frame buffers supplied by the
+     *  application. Must be set before the first frame is decoded.
+     */
+    VP8D_SET_FRAME_BUFFER_FUNCTIONS,
+
+    /** control function to get the application frame buffer holding the
+     *  image last returned by vpx_codec_get_frame()
+     */
+    VP8D_GET_FRAME_BUFFER,
+
+    /** control function to stop extending the borders of the decoded
+     *  frames. Motion compensation replicates the picture edges itself for
+     *  the few blocks that reach past them, which saves writing the borders
+     *  of every frame. Takes an int, non-zero to enable. Must be set before
+     *  the first frame is decoded.
+     */
+    VP8D_SET_UNBORDERED_REFS,
+
+    /** control function to choose where the memory of the decoded frames
+     *  goes, to cut the TLB misses and remote memory reads of motion
+     *  compensation on large frames. Takes an int of #vp8d_frame_placement
+     *  flags. They are hints: frames go to ordinary memory when the system
+     *  can't place them as asked. Must be set before the first frame is
+     *  decoded, and has no effect on application frame buffers.
+     */
+    VP8D_SET_FRAME_PLACEMENT,
+
+    /** control function to get the memory the decoder holds, see
+     *  #vp8_mem_stats_t. All zero before the first frame.
+     */
+    VP8D_GET_MEM_STATS,
+
     VP8_DECODER_CTRL_ID_MAX
 } ;
 
 
+/*!\brief Flags for #VP8D_SET_FRAME_PLACEMENT */
+enum vp8d_frame_placement
+{
+    VP8D_FRAME_HUGEPAGES    = 1 << 0, /**< back frames with huge pages */
+    VP8D_FRAME_NUMA_LOCAL   = 1 << 1  /**< place frames on the NUMA node of
+                                           the thread that decodes */
+};
+
+
+/*!\brief Frame buffer supplied by the application
+ *
+ * The decoder writes a whole frame, borders included unless
+ * #VP8D_SET_UNBORDERED_REFS is set, to \ref data. The buffer must be at
+ * least the requested size and 32 byte aligned.
+ */
+typedef struct vp8_frame_buffer
+{
+    unsigned char *data;    /**< start of the buffer */
+    size_t         size;    /**< size of the buffer in bytes */
+    void          *priv;    /**< application data identifying the buffer */
+} vp8_frame_buffer_t;
+
+/*!\brief Get a frame buffer of at least min_size bytes
+ *
+ * Returns 0 on success and fills in fb. The buffer belongs to the decoder
+ * until it is handed back through the matching release call.
+ */
+typedef int (*vp8_get_frame_buffer_fn_t)(void *cb_priv, size_t min_size,
+                                         vp8_frame_buffer_t *fb);
+
+/*!\brief Release a frame buffer obtained from the get call
+ *
+ * The decoder releases a buffer once it is neither a reference frame nor
+ * the frame last made available by vpx_codec_get_frame(). Returns 0 on
+ * success.
+ */
+typedef int (*vp8_release_frame_buffer_fn_t)(void *cb_priv,
+                                             vp8_frame_buffer_t *fb);
+
+/*!\brief Application frame buffer allocator
+ *
+ * Decoded frames live in buffers drawn from the application, so they can be
+ * held by later stages without a copy: an application that keeps a frame
+ * past the next vpx_codec_decode() call takes its own reference on the
+ * buffer returned by #VP8D_GET_FRAME_BUFFER, and does not hand that buffer
+ * out again until both its own and the decoder's references are dropped.
+ * The same allocator may serve several decoder instances. Postprocessed
+ * frames are returned from decoder owned memory.
+ */
+typedef struct vp8_frame_buffer_functions
+{
+    vp8_get_frame_buffer_fn_t     get_fb;     /**< NULL selects internal allocation */
+    vp8_release_frame_buffer_fn_t release_fb;
+    void                         *cb_priv;    /**< passed to both callbacks */
+} vp8_frame_buffer_functions_t;
+
+
 /*!\brief VP8 decoder control function parameter type
  *
  * Defines the data types that VP8D control functions take. Note that
@@ -75,6 +169,12 @@ enum vp8_dec_control_id
 VPX_CTRL_USE_TYPE(VP8D_GET_LAST_REF_UPDATES,   int *)
 VPX_CTRL_USE_TYPE(VP8D_GET_FRAME_CORRUPTED,    int *)
 VPX_CTRL_USE_TYPE(VP8D_GET_LAST_REF_USED,      int *)
+VPX_CTRL_USE_TYPE(VP8D_GET_MT_SYNC_STATS,      vp8_mt_sync_stats_t *)
+VPX_CTRL_USE_TYPE(VP8D_SET_FRAME_BUFFER_FUNCTIONS, vp8_frame_buffer_functions_t *)
+VPX_CTRL_USE_TYPE(VP8D_GET_FRAME_BUFFER,       vp8_frame_buffer_t *)
+VPX_CTRL_USE_TYPE(VP8D_SET_UNBORDERED_REFS,    int)
+VPX_CTRL_USE_TYPE(VP8D_SET_FRAME_PLACEMENT,    int)
+VPX_CTRL_USE_TYPE(VP8D_GET_MEM_STATS,          vp8_mem_stats_t *)
 
 /*! @} - end defgroup vp8_decoder */
 
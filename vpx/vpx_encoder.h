@@ -64,6 +64,11 @@ extern "C" {
      */
 #define VPX_CODEC_CAP_OUTPUT_PARTITION  0x20000
 
+    /*! Can scale the highest resolution's input down to the lower
+     *  resolutions of a multi-resolution encoder itself.
+     */
+#define VPX_CODEC_CAP_MULTI_RES_SCALING  0x40000
+
 
     /*! \brief Initialization-time Feature Enabling
      *
@@ -75,6 +80,10 @@ extern "C" {
 #define VPX_CODEC_USE_PSNR  0x10000 /**< Calculate PSNR on each frame */
 #define VPX_CODEC_USE_OUTPUT_PARTITION  0x20000 /**< Make the encoder output one
                                                      partition at a time. */
+#define VPX_CODEC_USE_MULTI_RES_SCALING  0x40000 /**< Make a multi-resolution
+                                                      encoder scale the input
+                                                      of the lower resolutions
+                                                      itself. */
 
 
     /*!\brief Generic fixed size buffer structure
@@ -800,6 +809,10 @@ extern "C" {
      * any held buffers. Encoding is complete when vpx_codec_encode() is called
      * and vpx_codec_get_cx_data() returns no data.
      *
+     * A multi-resolution encoder takes an array of images, one per
+     * resolution, or a single image of the highest resolution if it was
+     * initialized with #VPX_CODEC_USE_MULTI_RES_SCALING.
+     *
      * \param[in]    ctx       Pointer to this instance's context
      * \param[in]    img       Image data to encode, NULL to flush.
      * \param[in]    pts       Presentation time stamp, in timebase units.
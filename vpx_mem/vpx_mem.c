@@ -17,6 +17,26 @@
 #include <string.h>
 #include "include/vpx_mem_intrnl.h"
 
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+#if HAVE_SYS_MMAN_H && defined(MAP_ANONYMOUS)
+#define MAP_PAGES 1
+#else
+#define MAP_PAGES 0
+#endif
+
+/* What a block's address slot holds when there is no heap address to free
+ * there, see vpx_arena_memalign() and vpx_mem_alloc().
+ */
+#define ARENA_BLOCK  0
+#define MAPPED_BLOCK 1
+
 #if CONFIG_MEM_TRACKER
 #ifndef VPX_NO_GLOBALS
 static unsigned long g_alloc_count = 0;
@@ -207,6 +227,19 @@ void vpx_free(void *memblk)
     if (memblk)
     {
         void *addr = (void *)(((size_t *)memblk)[-1]);
+
+        /* Arena blocks have no address of their own to free. */
+        if ((size_t)addr == ARENA_BLOCK)
+            return;
+
+#if MAP_PAGES
+        if ((size_t)addr == MAPPED_BLOCK)
+        {
+            munmap((void *)((size_t *)memblk)[-2], ((size_t *)memblk)[-3]);
+            return;
+        }
+#endif
+
 #if CONFIG_MEM_MANAGER
         hmm_free(&hmm_d, addr);
 #else
@@ -215,6 +248,277 @@ void vpx_free(void *memblk)
     }
 }
 
+struct vpx_arena_chunk
+{
+    struct vpx_arena_chunk *next;
+    size_t size;
+    size_t used;
+};
+
+void *vpx_arena_memalign(vpx_arena_t *arena, size_t align, size_t size)
+{
+    struct vpx_arena_chunk *c = arena->chunks;
+    unsigned char *base;
+    unsigned char *x;
+    size_t need;
+
+    /* The slot before each block is zeroed for vpx_free(), keep it aligned. */
+    if (align < ADDRESS_STORAGE_SIZE)
+        align = ADDRESS_STORAGE_SIZE;
+
+    need = size + align - 1 + ADDRESS_STORAGE_SIZE;
+
+    if (!c || c->size - c->used < need)
+    {
+        size_t chunk_size = arena->chunk_size ? arena->chunk_size
+                                              : VPX_ARENA_CHUNK_SIZE;
+
+        if (chunk_size < arena->reserve)
+            chunk_size = arena->reserve;
+
+        if (chunk_size < need)
+            chunk_size = need;
+
+        c = vpx_memalign(sizeof(size_t), sizeof(*c) + chunk_size);
+
+        if (!c)
+            return NULL;
+
+        c->next = arena->chunks;
+        c->size = chunk_size;
+        c->used = 0;
+        arena->chunks = c;
+        arena->reserve = 0;
+    }
+
+    base = (unsigned char *)(c + 1);
+    x = align_addr(base + c->used + ADDRESS_STORAGE_SIZE, (int)align);
+    ((size_t *)x)[-1] = ARENA_BLOCK;
+    c->used = x + size - base;
+
+    return x;
+}
+
+void *vpx_arena_malloc(vpx_arena_t *arena, size_t size)
+{
+    return vpx_arena_memalign(arena, DEFAULT_ALIGNMENT, size);
+}
+
+void *vpx_arena_calloc(vpx_arena_t *arena, size_t num, size_t size)
+{
+    void *x = vpx_arena_memalign(arena, DEFAULT_ALIGNMENT, num * size);
+
+    if (x)
+        VPX_MEMSET_L(x, 0, num * size);
+
+    return x;
+}
+
+void vpx_arena_reset(vpx_arena_t *arena)
+{
+    struct vpx_arena_chunk *c = arena->chunks;
+    size_t total = 0;
+
+    if (c && !c->next)
+    {
+        c->used = 0;
+        return;
+    }
+
+    while (c)
+    {
+        struct vpx_arena_chunk *next = c->next;
+
+        total += c->size;
+        vpx_free(c);
+        c = next;
+    }
+
+    arena->chunks = NULL;
+    arena->reserve = total;
+}
+
+size_t vpx_arena_size(const vpx_arena_t *arena)
+{
+    const struct vpx_arena_chunk *c;
+    size_t total = 0;
+
+    for (c = arena->chunks; c; c = c->next)
+        total += sizeof(*c) + c->size;
+
+    return total;
+}
+
+size_t vpx_arena_used(const vpx_arena_t *arena)
+{
+    const struct vpx_arena_chunk *c;
+    size_t total = 0;
+
+    for (c = arena->chunks; c; c = c->next)
+        total += c->used;
+
+    return total;
+}
+
+void vpx_arena_free(vpx_arena_t *arena)
+{
+    vpx_arena_reset(arena);
+    vpx_free(arena->chunks);
+    arena->chunks = NULL;
+    arena->reserve = 0;
+}
+
+#if MAP_PAGES
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+#define SMALL_PAGE_SIZE 4096
+
+/* MAP_HUGETLB alone maps pages of the system's default huge page size,
+ * which need not be the 2MB everything here is rounded to; ask for 2MB
+ * pages explicitly, or do without reserved huge pages.
+ */
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_2MB) && defined(MAP_HUGE_SHIFT)
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+
+static void *map_pages(size_t len, int huge)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    unsigned char *addr;
+    unsigned char *base;
+    size_t lead;
+
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_2MB)
+
+    if (huge)
+    {
+        addr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                    flags | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+
+        if (addr != MAP_FAILED)
+            return addr;
+    }
+
+#endif
+
+    if (!huge)
+    {
+        addr = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+        return addr != MAP_FAILED ? addr : NULL;
+    }
+
+    /* No huge pages reserved: map a huge page more than needed and trim it
+     * to a huge page boundary, so transparent huge pages can back it all.
+     */
+    addr = mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, flags,
+                -1, 0);
+
+    if (addr == MAP_FAILED)
+        return NULL;
+
+    base = align_addr(addr, (int)HUGE_PAGE_SIZE);
+    lead = base - addr;
+
+    if (lead)
+        munmap(addr, lead);
+
+    munmap(base + len, HUGE_PAGE_SIZE - lead);
+#if defined(MADV_HUGEPAGE)
+    madvise(base, len, MADV_HUGEPAGE);
+#endif
+    return base;
+}
+
+/* Prefers the NUMA node of the calling thread for the pages of [addr, len),
+ * before they are touched. The kernel falls back to other nodes when that
+ * one is full.
+ */
+static void bind_local(void *addr, size_t len)
+{
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_getcpu)
+    unsigned long mask[4];
+    const unsigned int bits = sizeof(mask[0]) * 8;
+    unsigned int cpu, node;
+
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) || node >= 4 * bits)
+        return;
+
+    memset(mask, 0, sizeof(mask));
+    mask[node / bits] = 1UL << (node % bits);
+    syscall(SYS_mbind, addr, len, 1 /* MPOL_PREFERRED */, mask, 4 * bits + 1,
+            0);
+#else
+    (void)addr;
+    (void)len;
+#endif
+}
+#endif
+
+/* Maps the pages for vpx_mem_alloc(), or returns NULL to have the block
+ * come from the heap.
+ */
+static void *map_block(int id, size_t size, size_t align)
+{
+#if MAP_PAGES
+    const int huge = (id & VPX_MEM_HUGEPAGES) && size >= HUGE_PAGE_SIZE / 2;
+
+    /* Blocks too small for a huge page of their own stay on the heap,
+     * unless placing them on a node was asked for.
+     */
+    if ((huge || (id & VPX_MEM_NUMA_LOCAL)) && align <= SMALL_PAGE_SIZE)
+    {
+        const size_t page = huge ? HUGE_PAGE_SIZE : SMALL_PAGE_SIZE;
+        const size_t head = align > 4 * ADDRESS_STORAGE_SIZE
+                            ? align : 4 * ADDRESS_STORAGE_SIZE;
+        const size_t len = (head + size + page - 1) & ~(page - 1);
+        unsigned char *base = map_pages(len, huge);
+
+        if (base)
+        {
+            size_t *x = (size_t *)(base + head);
+
+            if (id & VPX_MEM_NUMA_LOCAL)
+                bind_local(base, len);
+
+            x[-1] = MAPPED_BLOCK;
+            x[-2] = (size_t)base;
+            x[-3] = len;
+            return x;
+        }
+    }
+
+#else
+    (void)id;
+    (void)size;
+    (void)align;
+#endif
+    return NULL;
+}
+
+void *vpx_mem_alloc(int id, size_t size, size_t align)
+{
+    void *x = map_block(id, size, align);
+
+    return x ? x : vpx_memalign(align, size);
+}
+
+size_t vpx_mem_footprint(const void *mem, size_t size)
+{
+#if MAP_PAGES
+
+    if (mem && ((const size_t *)mem)[-1] == MAPPED_BLOCK)
+        return ((const size_t *)mem)[-3];
+
+#endif
+    return size;
+}
+
+void vpx_mem_free(int id, void *mem, size_t size)
+{
+    (void)id;
+    (void)size;
+    vpx_free(mem);
+}
+
 #if CONFIG_MEM_TRACKER
 void *xvpx_memalign(size_t align, size_t size, char *file, int line)
 {
@@ -395,6 +699,13 @@ void xvpx_free(void *p_address, char *file, int line)
         vpx_memory_tracker_check_integrity(file, line);
 #endif
 
+        /* Arena and mapped blocks aren't tracked. */
+        if (((size_t *)p_address)[-1] <= MAPPED_BLOCK)
+        {
+            vpx_free(p_address);
+            return;
+        }
+
         /* if the addr isn't found in the list, assume it was allocated via
          * vpx_ calls not xvpx_, therefore it does not contain any padding
          */
@@ -419,6 +730,20 @@ void xvpx_free(void *p_address, char *file, int line)
     }
 }
 
+void *xvpx_mem_alloc(int id, size_t size, size_t align, char *file, int line)
+{
+    void *x = map_block(id, size, align);
+
+    return x ? x : xvpx_memalign(align, size, file, line);
+}
+
+void xvpx_mem_free(int id, void *mem, size_t size, char *file, int line)
+{
+    (void)id;
+    (void)size;
+    xvpx_free(mem, file, line);
+}
+
 #endif /*CONFIG_MEM_TRACKER*/
 
 #if CONFIG_MEM_CHECKS
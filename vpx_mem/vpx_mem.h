@@ -70,14 +70,85 @@ extern "C" {
     void *vpx_realloc(void *memblk, size_t size);
     void vpx_free(void *memblk);
 
+    /*
+        vpx_arena_t
+        Bump allocator for memory that is allocated and released as a group,
+        such as the per-resolution state of a codec instance. Blocks are
+        carved out of large chunks and are only released all at once, by
+        vpx_arena_reset() or vpx_arena_free(). vpx_free() ignores them, so
+        code that releases its blocks one by one works unchanged whether
+        they came from an arena or the heap. They must not be passed to
+        vpx_realloc().
+        A zeroed vpx_arena_t is an empty arena using chunks of
+        VPX_ARENA_CHUNK_SIZE bytes; chunk_size may be set to change that.
+    */
+#define VPX_ARENA_CHUNK_SIZE 65536
+
+    typedef struct vpx_arena
+    {
+        struct vpx_arena_chunk *chunks;  /* newest first */
+        size_t chunk_size;
+        size_t reserve;                  /* size for the first chunk after a
+                                            reset, see vpx_arena_reset() */
+    } vpx_arena_t;
+
+    void *vpx_arena_memalign(vpx_arena_t *arena, size_t align, size_t size);
+    void *vpx_arena_malloc(vpx_arena_t *arena, size_t size);
+    void *vpx_arena_calloc(vpx_arena_t *arena, size_t num, size_t size);
+
+    /*
+        vpx_arena_reset(vpx_arena_t *arena)
+        Releases every block of the arena at once. A single chunk is kept
+        for reuse; several are returned to the heap and replaced by one chunk
+        as large as all of them on the next allocation, so allocating the
+        same blocks again takes a single malloc at most.
+    */
+    void vpx_arena_reset(vpx_arena_t *arena);
+
+    /*
+        vpx_arena_size(const vpx_arena_t *arena)
+        Returns the heap memory the arena holds. vpx_arena_used() returns
+        the part of it handed out as blocks since the last reset, so the
+        difference of two calls gives what the blocks in between took.
+    */
+    size_t vpx_arena_size(const vpx_arena_t *arena);
+    size_t vpx_arena_used(const vpx_arena_t *arena);
+
+    /*
+        vpx_arena_free(vpx_arena_t *arena)
+        Releases every block and returns all the memory to the heap.
+    */
+    void vpx_arena_free(vpx_arena_t *arena);
+
     void *vpx_memcpy(void *dest, const void *src, size_t length);
     void *vpx_memset(void *dest, int val, size_t length);
     void *vpx_memmove(void *dest, const void *src, size_t count);
 
-    /* special memory functions */
+    /*
+        vpx_mem_alloc(int id, size_t size, size_t align)
+        Allocates size bytes aligned to align, placed as the VPX_MEM_* flags
+        in id ask, for large buffers such as frames that are read all over
+        by many threads. Placement is only a hint: when the system can't
+        provide it, or doesn't support it, the memory comes from
+        vpx_memalign(). Either way, the block may be released with
+        vpx_free() or vpx_mem_free().
+    */
+#define VPX_MEM_HUGEPAGES   0x1  /* back with huge pages, for fewer TLB
+                                    misses */
+#define VPX_MEM_NUMA_LOCAL  0x2  /* prefer the NUMA node the allocating
+                                    thread runs on */
+
     void *vpx_mem_alloc(int id, size_t size, size_t align);
     void vpx_mem_free(int id, void *mem, size_t size);
 
+    /*
+        vpx_mem_footprint(const void *mem, size_t size)
+        Returns the memory the size byte block mem takes up: all of its
+        pages if vpx_mem_alloc() mapped it, which may round it up to a huge
+        page, size otherwise.
+    */
+    size_t vpx_mem_footprint(const void *mem, size_t size);
+
     /* Wrappers to standard library functions. */
     typedef void*(* g_malloc_func)(size_t);
     typedef void*(* g_calloc_func)(size_t, size_t);
@@ -9,32 +9,46 @@
  */
 
 
+
 #include <float.h>
 #include <math.h>
 #include <stdio.h>
+#include "vpx_config.h"
 #include "vpx_mem/vpx_mem.h"
 #include "vpxscale_arbitrary.h"
 
 #define FIXED_POINT
 
-#define MAX_IN_WIDTH        800
-#define MAX_IN_HEIGHT       600
-#define MAX_OUT_WIDTH       800
-#define MAX_OUT_HEIGHT      600
-#define MAX_OUT_DIMENSION   ((MAX_OUT_WIDTH > MAX_OUT_HEIGHT) ? \
-                             MAX_OUT_WIDTH : MAX_OUT_HEIGHT)
-
-BICUBIC_SCALER_STRUCT g_b_scaler;
-static int g_first_time = 1;
+// Number of coefficient tables kept once no scaler uses them.
+#define CACHE_SIZE          8
 
-#pragma DATA_SECTION(g_hbuf, "VP6_HEAP")
-#pragma DATA_ALIGN (g_hbuf, 32);
-unsigned char g_hbuf[MAX_OUT_DIMENSION];
-
-#pragma DATA_SECTION(g_hbuf_uv, "VP6_HEAP")
-#pragma DATA_ALIGN (g_hbuf_uv, 32);
-unsigned char g_hbuf_uv[MAX_OUT_DIMENSION];
+// The coefficient tables are shared by every scaler with the same
+//  in/out sizes.  They are read only once built, so scaling needs no
+//  lock; only finding and releasing a table goes through the cache lock.
+#if CONFIG_MULTITHREAD && defined(_WIN32)
+#include <windows.h>
+static LONG cache_lock_word;
+static void cache_lock(void)
+{
+    while (InterlockedExchange(&cache_lock_word, 1))
+        Sleep(0);
+}
+static void cache_unlock(void)
+{
+    InterlockedExchange(&cache_lock_word, 0);
+}
+#elif CONFIG_MULTITHREAD
+#include <pthread.h>
+static pthread_mutex_t cache_lock_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define cache_lock()    pthread_mutex_lock(&cache_lock_mutex)
+#define cache_unlock()  pthread_mutex_unlock(&cache_lock_mutex)
+#else
+#define cache_lock()
+#define cache_unlock()
+#endif
 
+static BICUBIC_COEFFS *g_cache[CACHE_SIZE];
+static unsigned int g_cache_clock;
 
 #ifdef FIXED_POINT
 static int a_i = 0.6 * 65536;
@@ -261,30 +275,15 @@ int gcd(int a, int b)
     return b;
 }
 
-void bicubic_coefficient_init()
+static void free_coeffs(BICUBIC_COEFFS *c)
 {
-    vpx_memset(&g_b_scaler, 0, sizeof(BICUBIC_SCALER_STRUCT));
-    g_first_time = 0;
-}
-
-void bicubic_coefficient_destroy()
-{
-    if (!g_first_time)
-    {
-        vpx_free(g_b_scaler.l_w);
-
-        vpx_free(g_b_scaler.l_h);
-
-        vpx_free(g_b_scaler.l_h_uv);
-
-        vpx_free(g_b_scaler.c_w);
-
-        vpx_free(g_b_scaler.c_h);
-
-        vpx_free(g_b_scaler.c_h_uv);
-
-        vpx_memset(&g_b_scaler, 0, sizeof(BICUBIC_SCALER_STRUCT));
-    }
+    vpx_free(c->l_w);
+    vpx_free(c->l_h);
+    vpx_free(c->l_h_uv);
+    vpx_free(c->c_w);
+    vpx_free(c->c_h);
+    vpx_free(c->c_h_uv);
+    vpx_free(c);
 }
 
 // Create the coeffients that will be used for the cubic interpolation.
@@ -292,8 +291,10 @@ void bicubic_coefficient_destroy()
 //  regimes the phase offsets will be different.  There are 4 coefficents
 //  for each point, two on each side.  The layout is that there are the
 //  4 coefficents for each phase in the array and then the next phase.
-int bicubic_coefficient_setup(int in_width, int in_height, int out_width, int out_height)
+static BICUBIC_COEFFS *build_coeffs(int in_width, int in_height,
+                                    int out_width, int out_height)
 {
+    BICUBIC_COEFFS *c;
     int i;
 #ifdef FIXED_POINT
     int phase_offset_int;
@@ -304,157 +305,138 @@ int bicubic_coefficient_setup(int in_width, int in_height, int out_width, int ou
 #endif
     int gcd_w, gcd_h, gcd_h_uv, d_w, d_h, d_h_uv;
 
-    if (g_first_time)
-        bicubic_coefficient_init();
-
+    c = (BICUBIC_COEFFS *)vpx_calloc(1, sizeof(*c));
 
-    // check to see if the coefficents have already been set up correctly
-    if ((in_width == g_b_scaler.in_width) && (in_height == g_b_scaler.in_height)
-        && (out_width == g_b_scaler.out_width) && (out_height == g_b_scaler.out_height))
+    if (!c)
         return 0;
 
-    g_b_scaler.in_width = in_width;
-    g_b_scaler.in_height = in_height;
-    g_b_scaler.out_width = out_width;
-    g_b_scaler.out_height = out_height;
-
-    // Don't want to allow crazy scaling, just try and prevent a catastrophic
-    //  failure here.  Want to fail after setting the member functions so if
-    //  if the scaler is called the member functions will not scale.
-    if (out_width <= 0 || out_height <= 0)
-        return -1;
+    c->in_width = in_width;
+    c->in_height = in_height;
+    c->out_width = out_width;
+    c->out_height = out_height;
 
     // reduce in/out width and height ratios using the gcd
     gcd_w = gcd(out_width, in_width);
     gcd_h = gcd(out_height, in_height);
     gcd_h_uv = gcd(out_height, in_height / 2);
 
-    // the numerator width and height are to be saved in
-    //  globals so they can be used during the scaling process
-    //  without having to be recalculated.
-    g_b_scaler.nw = out_width / gcd_w;
+    // the numerator width and height are kept with the tables so they
+    //  can be used during the scaling process without having to be
+    //  recalculated.
+    c->nw = out_width / gcd_w;
     d_w = in_width / gcd_w;
 
-    g_b_scaler.nh = out_height / gcd_h;
+    c->nh = out_height / gcd_h;
     d_h = in_height / gcd_h;
 
-    g_b_scaler.nh_uv = out_height / gcd_h_uv;
+    c->nh_uv = out_height / gcd_h_uv;
     d_h_uv = (in_height / 2) / gcd_h_uv;
 
     // allocate memory for the coefficents
-    vpx_free(g_b_scaler.l_w);
-
-    vpx_free(g_b_scaler.l_h);
-
-    vpx_free(g_b_scaler.l_h_uv);
-
-    g_b_scaler.l_w = (short *)vpx_memalign(32, out_width * 2);
-    g_b_scaler.l_h = (short *)vpx_memalign(32, out_height * 2);
-    g_b_scaler.l_h_uv = (short *)vpx_memalign(32, out_height * 2);
-
-    vpx_free(g_b_scaler.c_w);
+    c->l_w = (short *)vpx_memalign(32, out_width * 2);
+    c->l_h = (short *)vpx_memalign(32, (out_height + 1) * 2);
+    c->l_h_uv = (short *)vpx_memalign(32, (out_height + 1) * 2);
 
-    vpx_free(g_b_scaler.c_h);
+    c->c_w = (short *)vpx_memalign(32, c->nw * 4 * 2);
+    c->c_h = (short *)vpx_memalign(32, c->nh * 4 * 2);
+    c->c_h_uv = (short *)vpx_memalign(32, c->nh_uv * 4 * 2);
 
-    vpx_free(g_b_scaler.c_h_uv);
-
-    g_b_scaler.c_w = (short *)vpx_memalign(32, g_b_scaler.nw * 4 * 2);
-    g_b_scaler.c_h = (short *)vpx_memalign(32, g_b_scaler.nh * 4 * 2);
-    g_b_scaler.c_h_uv = (short *)vpx_memalign(32, g_b_scaler.nh_uv * 4 * 2);
-
-    g_b_scaler.hbuf = g_hbuf;
-    g_b_scaler.hbuf_uv = g_hbuf_uv;
+    if (!c->l_w || !c->l_h || !c->l_h_uv || !c->c_w || !c->c_h || !c->c_h_uv)
+    {
+        free_coeffs(c);
+        return 0;
+    }
 
     // Set up polyphase filter taps.  This needs to be done before
     //  the scaling because of the floating point math required.  The
     //  coefficients are multiplied by 2^12 so that fixed point math
     //  can be used in the main scaling loop.
 #ifdef FIXED_POINT
-    fixed_mult = (1.0 / (float)g_b_scaler.nw) * 4294967296;
+    fixed_mult = (1.0 / (float)c->nw) * 4294967296;
 
     product_val = 0;
 
-    for (i = 0; i < g_b_scaler.nw; i++)
+    for (i = 0; i < c->nw; i++)
     {
-        if (product_val > g_b_scaler.nw)
-            product_val -= g_b_scaler.nw;
+        if (product_val > c->nw)
+            product_val -= c->nw;
 
         phase_offset_int = (fixed_mult * product_val) >> 16;
 
-        g_b_scaler.c_w[i*4]   = c3_fixed(phase_offset_int);
-        g_b_scaler.c_w[i*4+1] = c2_fixed(phase_offset_int);
-        g_b_scaler.c_w[i*4+2] = c1_fixed(phase_offset_int);
-        g_b_scaler.c_w[i*4+3] = c0_fixed(phase_offset_int);
+        c->c_w[i*4]   = c3_fixed(phase_offset_int);
+        c->c_w[i*4+1] = c2_fixed(phase_offset_int);
+        c->c_w[i*4+2] = c1_fixed(phase_offset_int);
+        c->c_w[i*4+3] = c0_fixed(phase_offset_int);
 
         product_val += d_w;
     }
 
 
-    fixed_mult = (1.0 / (float)g_b_scaler.nh) * 4294967296;
+    fixed_mult = (1.0 / (float)c->nh) * 4294967296;
 
     product_val = 0;
 
-    for (i = 0; i < g_b_scaler.nh; i++)
+    for (i = 0; i < c->nh; i++)
     {
-        if (product_val > g_b_scaler.nh)
-            product_val -= g_b_scaler.nh;
+        if (product_val > c->nh)
+            product_val -= c->nh;
 
         phase_offset_int = (fixed_mult * product_val) >> 16;
 
-        g_b_scaler.c_h[i*4]   = c0_fixed(phase_offset_int);
-        g_b_scaler.c_h[i*4+1] = c1_fixed(phase_offset_int);
-        g_b_scaler.c_h[i*4+2] = c2_fixed(phase_offset_int);
-        g_b_scaler.c_h[i*4+3] = c3_fixed(phase_offset_int);
+        c->c_h[i*4]   = c0_fixed(phase_offset_int);
+        c->c_h[i*4+1] = c1_fixed(phase_offset_int);
+        c->c_h[i*4+2] = c2_fixed(phase_offset_int);
+        c->c_h[i*4+3] = c3_fixed(phase_offset_int);
 
         product_val += d_h;
     }
 
-    fixed_mult = (1.0 / (float)g_b_scaler.nh_uv) * 4294967296;
+    fixed_mult = (1.0 / (float)c->nh_uv) * 4294967296;
 
     product_val = 0;
 
-    for (i = 0; i < g_b_scaler.nh_uv; i++)
+    for (i = 0; i < c->nh_uv; i++)
     {
-        if (product_val > g_b_scaler.nh_uv)
-            product_val -= g_b_scaler.nh_uv;
+        if (product_val > c->nh_uv)
+            product_val -= c->nh_uv;
 
         phase_offset_int = (fixed_mult * product_val) >> 16;
 
-        g_b_scaler.c_h_uv[i*4]   = c0_fixed(phase_offset_int);
-        g_b_scaler.c_h_uv[i*4+1] = c1_fixed(phase_offset_int);
-        g_b_scaler.c_h_uv[i*4+2] = c2_fixed(phase_offset_int);
-        g_b_scaler.c_h_uv[i*4+3] = c3_fixed(phase_offset_int);
+        c->c_h_uv[i*4]   = c0_fixed(phase_offset_int);
+        c->c_h_uv[i*4+1] = c1_fixed(phase_offset_int);
+        c->c_h_uv[i*4+2] = c2_fixed(phase_offset_int);
+        c->c_h_uv[i*4+3] = c3_fixed(phase_offset_int);
 
         product_val += d_h_uv;
     }
 
 #else
 
-    for (i = 0; i < g_nw; i++)
+    for (i = 0; i < c->nw; i++)
     {
-        phase_offset = (float)((i * d_w) % g_nw) / (float)g_nw;
-        g_c_w[i*4]   = (C3(phase_offset) * 4096.0);
-        g_c_w[i*4+1] = (C2(phase_offset) * 4096.0);
-        g_c_w[i*4+2] = (C1(phase_offset) * 4096.0);
-        g_c_w[i*4+3] = (C0(phase_offset) * 4096.0);
+        phase_offset = (float)((i * d_w) % c->nw) / (float)c->nw;
+        c->c_w[i*4]   = (C3(phase_offset) * 4096.0);
+        c->c_w[i*4+1] = (C2(phase_offset) * 4096.0);
+        c->c_w[i*4+2] = (C1(phase_offset) * 4096.0);
+        c->c_w[i*4+3] = (C0(phase_offset) * 4096.0);
     }
 
-    for (i = 0; i < g_nh; i++)
+    for (i = 0; i < c->nh; i++)
     {
-        phase_offset = (float)((i * d_h) % g_nh) / (float)g_nh;
-        g_c_h[i*4]   = (C0(phase_offset) * 4096.0);
-        g_c_h[i*4+1] = (C1(phase_offset) * 4096.0);
-        g_c_h[i*4+2] = (C2(phase_offset) * 4096.0);
-        g_c_h[i*4+3] = (C3(phase_offset) * 4096.0);
+        phase_offset = (float)((i * d_h) % c->nh) / (float)c->nh;
+        c->c_h[i*4]   = (C0(phase_offset) * 4096.0);
+        c->c_h[i*4+1] = (C1(phase_offset) * 4096.0);
+        c->c_h[i*4+2] = (C2(phase_offset) * 4096.0);
+        c->c_h[i*4+3] = (C3(phase_offset) * 4096.0);
     }
 
-    for (i = 0; i < g_nh_uv; i++)
+    for (i = 0; i < c->nh_uv; i++)
     {
-        phase_offset = (float)((i * d_h_uv) % g_nh_uv) / (float)g_nh_uv;
-        g_c_h_uv[i*4]   = (C0(phase_offset) * 4096.0);
-        g_c_h_uv[i*4+1] = (C1(phase_offset) * 4096.0);
-        g_c_h_uv[i*4+2] = (C2(phase_offset) * 4096.0);
-        g_c_h_uv[i*4+3] = (C3(phase_offset) * 4096.0);
+        phase_offset = (float)((i * d_h_uv) % c->nh_uv) / (float)c->nh_uv;
+        c->c_h_uv[i*4]   = (C0(phase_offset) * 4096.0);
+        c->c_h_uv[i*4+1] = (C1(phase_offset) * 4096.0);
+        c->c_h_uv[i*4+2] = (C2(phase_offset) * 4096.0);
+        c->c_h_uv[i*4+3] = (C3(phase_offset) * 4096.0);
     }
 
 #endif
@@ -465,41 +447,214 @@ int bicubic_coefficient_setup(int in_width, int in_height, int out_width, int ou
     //  is a call.
     for (i = 0; i < out_width; i++)
     {
-        g_b_scaler.l_w[i] = (i * d_w) / g_b_scaler.nw;
+        c->l_w[i] = (i * d_w) / c->nw;
 
-        if ((g_b_scaler.l_w[i] + 2) <= in_width)
-            g_b_scaler.max_usable_out_width = i;
+        if ((c->l_w[i] + 2) <= in_width)
+            c->max_usable_out_width = i;
 
     }
 
     for (i = 0; i < out_height + 1; i++)
     {
-        g_b_scaler.l_h[i] = (i * d_h) / g_b_scaler.nh;
-        g_b_scaler.l_h_uv[i] = (i * d_h_uv) / g_b_scaler.nh_uv;
+        c->l_h[i] = (i * d_h) / c->nh;
+        c->l_h_uv[i] = (i * d_h_uv) / c->nh_uv;
     }
 
-    return 0;
+    return c;
+}
+
+// Drops a scaler's reference to its tables.  Tables that are not in the
+//  cache go as soon as nobody uses them; cached ones stay until evicted.
+static void release_coeffs(const BICUBIC_COEFFS *coeffs)
+{
+    BICUBIC_COEFFS *c = (BICUBIC_COEFFS *)coeffs;
+
+    if (!c)
+        return;
+
+    cache_lock();
+    c->ref_count--;
+
+    if (!c->ref_count && !c->cached)
+        free_coeffs(c);
+
+    cache_unlock();
 }
 
-int bicubic_scale(int in_width, int in_height, int in_stride,
+// Returns the tables for the given sizes with a reference taken, from the
+//  cache if possible.  A new table replaces the least recently used unused
+//  one; if every cached table is in use it is not cached at all.
+static const BICUBIC_COEFFS *find_coeffs(int in_width, int in_height,
+                                         int out_width, int out_height)
+{
+    BICUBIC_COEFFS *c, *built;
+    int i, victim;
+
+    cache_lock();
+
+    for (i = 0; i < CACHE_SIZE; i++)
+    {
+        c = g_cache[i];
+
+        if (c && c->in_width == in_width && c->in_height == in_height
+            && c->out_width == out_width && c->out_height == out_height)
+        {
+            c->ref_count++;
+            c->last_used = ++g_cache_clock;
+            cache_unlock();
+            return c;
+        }
+    }
+
+    cache_unlock();
+
+    // Build outside the lock; another thread may have raced us to it.
+    built = build_coeffs(in_width, in_height, out_width, out_height);
+
+    if (!built)
+        return 0;
+
+    cache_lock();
+
+    for (i = 0; i < CACHE_SIZE; i++)
+    {
+        c = g_cache[i];
+
+        if (c && c->in_width == in_width && c->in_height == in_height
+            && c->out_width == out_width && c->out_height == out_height)
+        {
+            c->ref_count++;
+            c->last_used = ++g_cache_clock;
+            cache_unlock();
+            free_coeffs(built);
+            return c;
+        }
+    }
+
+    victim = -1;
+
+    for (i = 0; i < CACHE_SIZE; i++)
+    {
+        c = g_cache[i];
+
+        if (!c)
+        {
+            victim = i;
+            break;
+        }
+
+        if (!c->ref_count
+            && (victim < 0 || c->last_used < g_cache[victim]->last_used))
+            victim = i;
+    }
+
+    built->ref_count = 1;
+    built->last_used = ++g_cache_clock;
+
+    if (victim >= 0)
+    {
+        if (g_cache[victim])
+            free_coeffs(g_cache[victim]);
+
+        g_cache[victim] = built;
+        built->cached = 1;
+    }
+
+    cache_unlock();
+    return built;
+}
+
+void bicubic_coefficient_init(BICUBIC_SCALER_STRUCT *s)
+{
+    vpx_memset(s, 0, sizeof(BICUBIC_SCALER_STRUCT));
+}
+
+void bicubic_coefficient_destroy(BICUBIC_SCALER_STRUCT *s)
+{
+    release_coeffs(s->coeffs);
+    vpx_free(s->hbuf);
+    vpx_memset(s, 0, sizeof(BICUBIC_SCALER_STRUCT));
+}
+
+void bicubic_coefficient_cache_flush()
+{
+    int i;
+
+    cache_lock();
+
+    for (i = 0; i < CACHE_SIZE; i++)
+    {
+        BICUBIC_COEFFS *c = g_cache[i];
+
+        if (c && !c->ref_count)
+        {
+            free_coeffs(c);
+            g_cache[i] = 0;
+        }
+    }
+
+    cache_unlock();
+}
+
+// Points the scaler at the tables for the given sizes, setting them up
+//  if no scaler in the process has them already.
+int bicubic_coefficient_setup(BICUBIC_SCALER_STRUCT *s, int in_width, int in_height, int out_width, int out_height)
+{
+    const BICUBIC_COEFFS *c = s->coeffs;
+
+    // check to see if the coefficents have already been set up correctly
+    if (c && (in_width == c->in_width) && (in_height == c->in_height)
+        && (out_width == c->out_width) && (out_height == c->out_height))
+        return 0;
+
+    release_coeffs(c);
+    s->coeffs = 0;
+
+    // Don't want to allow crazy scaling, just try and prevent a catastrophic
+    //  failure here.  With no tables the scaler will not scale.
+    if (in_width <= 0 || in_height <= 0 || out_width <= 0 || out_height <= 0)
+        return -1;
+
+    // buffer for the vertically filtered row
+    if (s->hbuf_size < in_width)
+    {
+        vpx_free(s->hbuf);
+        s->hbuf = (unsigned char *)vpx_memalign(32, in_width);
+        s->hbuf_size = s->hbuf ? in_width : 0;
+
+        if (!s->hbuf)
+            return -1;
+    }
+
+    s->coeffs = find_coeffs(in_width, in_height, out_width, out_height);
+
+    return s->coeffs ? 0 : -1;
+}
+
+int bicubic_scale(BICUBIC_SCALER_STRUCT *s,
+                  int in_width, int in_height, int in_stride,
                   int out_width, int out_height, int out_stride,
                   unsigned char *input_image, unsigned char *output_image)
 {
-    short *RESTRICT l_w, * RESTRICT l_h;
-    short *RESTRICT c_w, * RESTRICT c_h;
+    const BICUBIC_COEFFS *c = s->coeffs;
+    const short *RESTRICT l_w, * RESTRICT l_h;
+    const short *RESTRICT c_w, * RESTRICT c_h;
     unsigned char *RESTRICT ip, * RESTRICT op;
     unsigned char *RESTRICT hbuf;
     int h, w, lw, lh;
     int temp_sum;
     int phase_offset_w, phase_offset_h;
 
-    c_w = g_b_scaler.c_w;
-    c_h = g_b_scaler.c_h;
+    if (!c)
+        return -1;
+
+    c_w = c->c_w;
+    c_h = c->c_h;
 
     op = output_image;
 
-    l_w = g_b_scaler.l_w;
-    l_h = g_b_scaler.l_h;
+    l_w = c->l_w;
+    l_h = c->l_h;
 
     phase_offset_h = 0;
 
@@ -517,7 +672,7 @@ int bicubic_scale(int in_width, int in_height, int in_stride,
         //  filter that last lines.
         if (phase_offset_h && (lh < in_height - 2))
         {
-            hbuf = g_b_scaler.hbuf;
+            hbuf = s->hbuf;
 
             for (w = 0; w < in_width; w++)
             {
@@ -533,7 +688,7 @@ int bicubic_scale(int in_width, int in_height, int in_stride,
             hbuf = ip;
 
         // increase the phase offset for the next time around.
-        if (++phase_offset_h >= g_b_scaler.nh)
+        if (++phase_offset_h >= c->nh)
             phase_offset_h = 0;
 
         // now filter and expand it horizontally into the final
@@ -551,7 +706,7 @@ int bicubic_scale(int in_width, int in_height, int in_stride,
             temp_sum += c_w[phase_offset_w*4+3] * hbuf[lw + 2];
             temp_sum = temp_sum >> 12;
 
-            if (++phase_offset_w >= g_b_scaler.nw)
+            if (++phase_offset_w >= c->nw)
                 phase_offset_w = 0;
 
             // boundry conditions
@@ -570,13 +725,14 @@ int bicubic_scale(int in_width, int in_height, int in_stride,
     return 0;
 }
 
-void bicubic_scale_frame_reset()
+void bicubic_scale_frame_reset(BICUBIC_SCALER_STRUCT *s)
 {
-    g_b_scaler.out_width = 0;
-    g_b_scaler.out_height = 0;
+    release_coeffs(s->coeffs);
+    s->coeffs = 0;
 }
 
-void bicubic_scale_frame(YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst,
+void bicubic_scale_frame(BICUBIC_SCALER_STRUCT *s,
+                         YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst,
                          int new_width, int new_height)
 {
 
@@ -588,15 +744,15 @@ void bicubic_scale_frame(YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst,
     dst->y_stride = dst->y_width;
     dst->uv_stride = dst->uv_width;
 
-    bicubic_scale(src->y_width, src->y_height, src->y_stride,
+    bicubic_scale(s, src->y_width, src->y_height, src->y_stride,
                   new_width, new_height, dst->y_stride,
                   src->y_buffer, dst->y_buffer);
 
-    bicubic_scale(src->uv_width, src->uv_height, src->uv_stride,
+    bicubic_scale(s, src->uv_width, src->uv_height, src->uv_stride,
                   new_width / 2, new_height / 2, dst->uv_stride,
                   src->u_buffer, dst->u_buffer);
 
-    bicubic_scale(src->uv_width, src->uv_height, src->uv_stride,
+    bicubic_scale(s, src->uv_width, src->uv_height, src->uv_stride,
                   new_width / 2, new_height / 2, dst->uv_stride,
                   src->v_buffer, dst->v_buffer);
 }
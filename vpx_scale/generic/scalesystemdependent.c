@@ -17,7 +17,12 @@ void (*vp8_yv12_extend_frame_borders_ptr)(YV12_BUFFER_CONFIG *ybf);
 void (*vp8_yv12_copy_frame_ptr)(YV12_BUFFER_CONFIG *src_ybc, YV12_BUFFER_CONFIG *dst_ybc);
 void (*vp8_yv12_copy_y_ptr)(YV12_BUFFER_CONFIG *src_ybc, YV12_BUFFER_CONFIG *dst_ybc);
 
+/* Set up front: frames can be extended before a codec is configured. */
+void (*vp8_yv12_extend_cols_ptr)(unsigned char *src, int stride, int width,
+                                 int rows, int border) = vp8_yv12_extend_cols_c;
+
 extern void vp8_arch_arm_vpx_scale_init();
+extern void vp8_arch_x86_vpx_scale_init();
 
 /****************************************************************************
  *
@@ -67,8 +72,13 @@ void vp8_scale_machine_specific_config()
     vp8_yv12_extend_frame_borders_ptr     = vp8_yv12_extend_frame_borders;
     vp8_yv12_copy_y_ptr                   = vp8_yv12_copy_y_c;
     vp8_yv12_copy_frame_ptr               = vp8_yv12_copy_frame;
+    vp8_yv12_extend_cols_ptr              = vp8_yv12_extend_cols_c;
 
 #if ARCH_ARM
     vp8_arch_arm_vpx_scale_init();
 #endif
+
+#if ARCH_X86 || ARCH_X86_64
+    vp8_arch_x86_vpx_scale_init();
+#endif
 }
@@ -24,7 +24,8 @@ vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf)
 {
     if (ybf)
     {
-        vpx_free(ybf->buffer_alloc);
+        if (!ybf->buffer_external)
+            vpx_free(ybf->buffer_alloc);
 
 #if CONFIG_OPENCL
         if (cl_initialized == CL_SUCCESS){
@@ -48,48 +49,94 @@ vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf)
     return 0;
 }
 
+/****************************************************************************
+ *
+ ****************************************************************************/
+static int
+yv12_setup_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height, int border)
+{
+    int y_stride = ((width + 2 * border) + 31) & ~31;
+    int yplane_size = (height + 2 * border) * y_stride;
+    int uv_width = width >> 1;
+    int uv_height = height >> 1;
+    /** There is currently a bunch of code which assumes
+      *  uv_stride == y_stride/2, so enforce this here. */
+    int uv_stride = y_stride >> 1;
+    int uvplane_size = (uv_height + border) * uv_stride;
+
+    /** Only support allocating buffers that have a height and width that
+      *  are multiples of 16, and a border that's a multiple of 32.
+      * The border restriction is required to get 16-byte alignment of the
+      *  start of the chroma rows without intoducing an arbitrary gap
+      *  between planes, which would break the semantics of things like
+      *  vpx_img_set_rect(). */
+    if ((width & 0xf) | (height & 0xf) | (border & 0x1f))
+        return -3;
+
+    ybf->y_width  = width;
+    ybf->y_height = height;
+    ybf->y_stride = y_stride;
+
+    ybf->uv_width = uv_width;
+    ybf->uv_height = uv_height;
+    ybf->uv_stride = uv_stride;
+
+    ybf->border = border;
+    ybf->frame_size = yplane_size + 2 * uvplane_size;
+
+    ybf->corrupted = 0; /* assume not currupted by errors */
+    return 0;
+}
+
+static void
+yv12_setup_planes(YV12_BUFFER_CONFIG *ybf)
+{
+    int border = ybf->border;
+    int yplane_size = (ybf->y_height + 2 * border) * ybf->y_stride;
+    int uvplane_size = (ybf->uv_height + border) * ybf->uv_stride;
+
+    if (ybf->buffer_alloc)
+    {
+        ybf->y_buffer = ybf->buffer_alloc + (border * ybf->y_stride) + border;
+        ybf->u_buffer = ybf->buffer_alloc + yplane_size + (border / 2  * ybf->uv_stride) + border / 2;
+        ybf->v_buffer = ybf->buffer_alloc + yplane_size + uvplane_size + (border / 2  * ybf->uv_stride) + border / 2;
+    }
+    else
+    {
+        ybf->y_buffer = NULL;
+        ybf->u_buffer = NULL;
+        ybf->v_buffer = NULL;
+    }
+}
+
 /****************************************************************************
  *
  ****************************************************************************/
 int
 vp8_yv12_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height, int border)
+{
+    return vp8_yv12_alloc_frame_buffer_placed(ybf, width, height, border, 0);
+}
+
+/****************************************************************************
+ *
+ ****************************************************************************/
+int
+vp8_yv12_alloc_frame_buffer_placed(YV12_BUFFER_CONFIG *ybf, int width, int height, int border, int mem_id)
 {
 /*NOTE:*/
 
     if (ybf)
     {
-        int y_stride = ((width + 2 * border) + 31) & ~31;
-        int yplane_size = (height + 2 * border) * y_stride;
-        int uv_width = width >> 1;
-        int uv_height = height >> 1;
-        /** There is currently a bunch of code which assumes
-          *  uv_stride == y_stride/2, so enforce this here. */
-        int uv_stride = y_stride >> 1;
-        int uvplane_size = (uv_height + border) * uv_stride;
+        int ret;
 
         vp8_yv12_de_alloc_frame_buffer(ybf);
 
-        /** Only support allocating buffers that have a height and width that
-          *  are multiples of 16, and a border that's a multiple of 32.
-          * The border restriction is required to get 16-byte alignment of the
-          *  start of the chroma rows without intoducing an arbitrary gap
-          *  between planes, which would break the semantics of things like
-          *  vpx_img_set_rect(). */
-        if ((width & 0xf) | (height & 0xf) | (border & 0x1f))
-            return -3;
-
-        ybf->y_width  = width;
-        ybf->y_height = height;
-        ybf->y_stride = y_stride;
-
-        ybf->uv_width = uv_width;
-        ybf->uv_height = uv_height;
-        ybf->uv_stride = uv_stride;
+        ret = yv12_setup_frame_buffer(ybf, width, height, border);
+        if (ret < 0)
+            return ret;
 
-        ybf->border = border;
-        ybf->frame_size = yplane_size + 2 * uvplane_size;
-
-        ybf->buffer_alloc = (unsigned char *) vpx_memalign(32, ybf->frame_size);
+        ybf->buffer_alloc = (unsigned char *) vpx_mem_alloc(mem_id, ybf->frame_size, 32);
 
         if (ybf->buffer_alloc == NULL)
             return -1;
@@ -104,11 +151,37 @@ vp8_yv12_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height, int
         }
 #endif
 
-        ybf->y_buffer = ybf->buffer_alloc + (border * y_stride) + border;
-        ybf->u_buffer = ybf->buffer_alloc + yplane_size + (border / 2  * uv_stride) + border / 2;
-        ybf->v_buffer = ybf->buffer_alloc + yplane_size + uvplane_size + (border / 2  * uv_stride) + border / 2;
+        yv12_setup_planes(ybf);
+    }
+    else
+    {
+        return -2;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+ *
+ ****************************************************************************/
+int
+vp8_yv12_external_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height, int border, unsigned char *buf)
+{
+    if (ybf)
+    {
+        int ret;
+
+        if (!ybf->buffer_external)
+            vp8_yv12_de_alloc_frame_buffer(ybf);
+
+        ret = yv12_setup_frame_buffer(ybf, width, height, border);
+        if (ret < 0)
+            return ret;
 
-        ybf->corrupted = 0; /* assume not currupted by errors */
+        /* The memory, if any yet, stays owned by the caller. */
+        ybf->buffer_alloc = buf;
+        ybf->buffer_external = 1;
+        yv12_setup_planes(ybf);
     }
     else
     {
@@ -9,8 +9,10 @@
  */
 
 
+#include <string.h>
 #include "vpx_scale/yv12config.h"
 #include "vpx_mem/vpx_mem.h"
+#include "vpx/vpx_integer.h"
 #include "vpx_scale/vpxscale.h"
 
 /****************************************************************************
@@ -20,186 +22,104 @@
 /****************************************************************************
  *
  ****************************************************************************/
+/* Replicates the first and last pixel of each of rows rows into its left
+ * and right borders, 8 bytes at a time from a replicated word rather than
+ * with a memset per row.
+ */
 void
-vp8_yv12_extend_frame_borders(YV12_BUFFER_CONFIG *ybf)
+vp8_yv12_extend_cols_c(unsigned char *src, int stride, int width, int rows,
+                       int border)
 {
-    int i;
-    unsigned char *src_ptr1, *src_ptr2;
-    unsigned char *dest_ptr1, *dest_ptr2;
-
-    unsigned int Border;
-    int plane_stride;
-    int plane_height;
-    int plane_width;
-
-    /***********/
-    /* Y Plane */
-    /***********/
-    Border = ybf->border;
-    plane_stride = ybf->y_stride;
-    plane_height = ybf->y_height;
-    plane_width = ybf->y_width;
-
-    /* copy the left and right most columns out */
-    src_ptr1 = ybf->y_buffer;
-    src_ptr2 = src_ptr1 + plane_width - 1;
-    dest_ptr1 = src_ptr1 - Border;
-    dest_ptr2 = src_ptr2 + 1;
-
-    for (i = 0; i < plane_height; i++)
-    {
-        vpx_memset(dest_ptr1, src_ptr1[0], Border);
-        vpx_memset(dest_ptr2, src_ptr2[0], Border);
-        src_ptr1  += plane_stride;
-        src_ptr2  += plane_stride;
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
-    }
+    int i, j;
 
-    /* Now copy the top and bottom source lines into each line of the respective borders */
-    src_ptr1 = ybf->y_buffer - Border;
-    src_ptr2 = src_ptr1 + (plane_height * plane_stride) - plane_stride;
-    dest_ptr1 = src_ptr1 - (Border * plane_stride);
-    dest_ptr2 = src_ptr2 + plane_stride;
-
-    for (i = 0; i < (int)Border; i++)
+    for (i = 0; i < rows; i++)
     {
-        vpx_memcpy(dest_ptr1, src_ptr1, plane_stride);
-        vpx_memcpy(dest_ptr2, src_ptr2, plane_stride);
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
+        const uint64_t l = src[0] * 0x0101010101010101ULL;
+        const uint64_t r = src[width - 1] * 0x0101010101010101ULL;
+        unsigned char *dl = src - border;
+        unsigned char *dr = src + width;
+
+        for (j = 0; j + 8 <= border; j += 8)
+        {
+            memcpy(dl + j, &l, 8);
+            memcpy(dr + j, &r, 8);
+        }
+
+        for (; j < border; j++)
+        {
+            dl[j] = src[0];
+            dr[j] = src[width - 1];
+        }
+
+        src += stride;
     }
+}
 
+/* Extends the side borders of rows [y, y + h) of a plane, and the top and
+ * bottom borders when the range includes the first or last row. The top
+ * and bottom rows are whole-stride copies.
+ */
+static void
+extend_plane_rows(unsigned char *src, int stride, int width, int height,
+                  int border, int y, int h)
+{
+    unsigned char *top = src - border;
+    unsigned char *bottom = top + (height - 1) * stride;
+    int i;
 
-    /***********/
-    /* U Plane */
-    /***********/
-    plane_stride = ybf->uv_stride;
-    plane_height = ybf->uv_height;
-    plane_width = ybf->uv_width;
-    Border /= 2;
-
-    /* copy the left and right most columns out */
-    src_ptr1 = ybf->u_buffer;
-    src_ptr2 = src_ptr1 + plane_width - 1;
-    dest_ptr1 = src_ptr1 - Border;
-    dest_ptr2 = src_ptr2 + 1;
-
-    for (i = 0; i < plane_height; i++)
-    {
-        vpx_memset(dest_ptr1, src_ptr1[0], Border);
-        vpx_memset(dest_ptr2, src_ptr2[0], Border);
-        src_ptr1  += plane_stride;
-        src_ptr2  += plane_stride;
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
-    }
+    if (y + h > height)
+        h = height - y;
 
-    /* Now copy the top and bottom source lines into each line of the respective borders */
-    src_ptr1 = ybf->u_buffer - Border;
-    src_ptr2 = src_ptr1 + (plane_height * plane_stride) - plane_stride;
-    dest_ptr1 = src_ptr1 - (Border * plane_stride);
-    dest_ptr2 = src_ptr2 + plane_stride;
+    if (h > 0)
+        vp8_yv12_extend_cols_ptr(src + y * stride, stride, width, h, border);
 
-    for (i = 0; i < (int)(Border); i++)
-    {
-        vpx_memcpy(dest_ptr1, src_ptr1, plane_stride);
-        vpx_memcpy(dest_ptr2, src_ptr2, plane_stride);
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
-    }
+    if (y == 0)
+        for (i = 1; i <= border; i++)
+            vpx_memcpy(top - i * stride, top, stride);
 
-    /***********/
-    /* V Plane */
-    /***********/
+    if (y + h == height)
+        for (i = 1; i <= border; i++)
+            vpx_memcpy(bottom + i * stride, bottom, stride);
+}
 
-    /* copy the left and right most columns out */
-    src_ptr1 = ybf->v_buffer;
-    src_ptr2 = src_ptr1 + plane_width - 1;
-    dest_ptr1 = src_ptr1 - Border;
-    dest_ptr2 = src_ptr2 + 1;
+static void
+extend_plane(unsigned char *src, int stride, int width, int height,
+             int border)
+{
+    extend_plane_rows(src, stride, width, height, border, 0, height);
+}
 
-    for (i = 0; i < plane_height; i++)
-    {
-        vpx_memset(dest_ptr1, src_ptr1[0], Border);
-        vpx_memset(dest_ptr2, src_ptr2[0], Border);
-        src_ptr1  += plane_stride;
-        src_ptr2  += plane_stride;
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
-    }
+void
+vp8_yv12_extend_frame_borders(YV12_BUFFER_CONFIG *ybf)
+{
+    extend_plane(ybf->y_buffer, ybf->y_stride,
+                 ybf->y_width, ybf->y_height, ybf->border);
+    extend_plane(ybf->u_buffer, ybf->uv_stride,
+                 ybf->uv_width, ybf->uv_height, ybf->border / 2);
+    extend_plane(ybf->v_buffer, ybf->uv_stride,
+                 ybf->uv_width, ybf->uv_height, ybf->border / 2);
+}
 
-    /* Now copy the top and bottom source lines into each line of the respective borders */
-    src_ptr1 = ybf->v_buffer - Border;
-    src_ptr2 = src_ptr1 + (plane_height * plane_stride) - plane_stride;
-    dest_ptr1 = src_ptr1 - (Border * plane_stride);
-    dest_ptr2 = src_ptr2 + plane_stride;
 
-    for (i = 0; i < (int)(Border); i++)
-    {
-        vpx_memcpy(dest_ptr1, src_ptr1, plane_stride);
-        vpx_memcpy(dest_ptr2, src_ptr2, plane_stride);
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
-    }
+void
+vp8_yv12_extend_frame_rows(YV12_BUFFER_CONFIG *ybf, int y, int h)
+{
+    extend_plane_rows(ybf->y_buffer, ybf->y_stride,
+                      ybf->y_width, ybf->y_height, ybf->border, y, h);
+    extend_plane_rows(ybf->u_buffer, ybf->uv_stride,
+                      ybf->uv_width, ybf->uv_height, ybf->border / 2,
+                      y / 2, h / 2);
+    extend_plane_rows(ybf->v_buffer, ybf->uv_stride,
+                      ybf->uv_width, ybf->uv_height, ybf->border / 2,
+                      y / 2, h / 2);
 }
 
 
 static void
 extend_frame_borders_yonly(YV12_BUFFER_CONFIG *ybf)
 {
-    int i;
-    unsigned char *src_ptr1, *src_ptr2;
-    unsigned char *dest_ptr1, *dest_ptr2;
-
-    unsigned int Border;
-    int plane_stride;
-    int plane_height;
-    int plane_width;
-
-    /***********/
-    /* Y Plane */
-    /***********/
-    Border = ybf->border;
-    plane_stride = ybf->y_stride;
-    plane_height = ybf->y_height;
-    plane_width = ybf->y_width;
-
-    /* copy the left and right most columns out */
-    src_ptr1 = ybf->y_buffer;
-    src_ptr2 = src_ptr1 + plane_width - 1;
-    dest_ptr1 = src_ptr1 - Border;
-    dest_ptr2 = src_ptr2 + 1;
-
-    for (i = 0; i < plane_height; i++)
-    {
-        vpx_memset(dest_ptr1, src_ptr1[0], Border);
-        vpx_memset(dest_ptr2, src_ptr2[0], Border);
-        src_ptr1  += plane_stride;
-        src_ptr2  += plane_stride;
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
-    }
-
-    /* Now copy the top and bottom source lines into each line of the respective borders */
-    src_ptr1 = ybf->y_buffer - Border;
-    src_ptr2 = src_ptr1 + (plane_height * plane_stride) - plane_stride;
-    dest_ptr1 = src_ptr1 - (Border * plane_stride);
-    dest_ptr2 = src_ptr2 + plane_stride;
-
-    for (i = 0; i < (int)Border; i++)
-    {
-        vpx_memcpy(dest_ptr1, src_ptr1, plane_stride);
-        vpx_memcpy(dest_ptr2, src_ptr2, plane_stride);
-        dest_ptr1 += plane_stride;
-        dest_ptr2 += plane_stride;
-    }
-
-    plane_stride /= 2;
-    plane_height /= 2;
-    plane_width /= 2;
-    Border /= 2;
-
+    extend_plane(ybf->y_buffer, ybf->y_stride,
+                 ybf->y_width, ybf->y_height, ybf->border);
 }
 
 
@@ -16,6 +16,17 @@
 
     void vp8_yv12_extend_frame_borders(YV12_BUFFER_CONFIG *ybf);
 
+    /* Extends the side borders of luma rows [y, y + h) and of the matching
+     * chroma rows, and the top or bottom border if the range includes the
+     * first or last row, so a frame can be extended a band at a time. y and
+     * h must be even.
+     */
+    void vp8_yv12_extend_frame_rows(YV12_BUFFER_CONFIG *ybf, int y, int h);
+
+    /* Fills the left and right borders of rows rows from their edge pixels. */
+    void vp8_yv12_extend_cols_c(unsigned char *src, int stride, int width,
+                                int rows, int border);
+
     /* Copy Y,U,V buffer data from src to dst, filling border of dst as well. */
     void vp8_yv12_copy_frame(YV12_BUFFER_CONFIG *src_ybc, YV12_BUFFER_CONFIG *dst_ybc);
 
@@ -14,6 +14,9 @@
 
 #include "vpx_scale/yv12config.h"
 
+// Coefficient tables for one set of in/out sizes.  They are shared
+//  through a small process-wide cache by every scaler with those sizes,
+//  and are read only once set up.
 typedef struct
 {
     int in_width;
@@ -38,19 +41,36 @@ typedef struct
     short *c_h;
     short *c_h_uv;
 
-    // buffer for horizontal filtering.
+    // cache bookkeeping, under the cache lock
+    int ref_count;
+    int cached;
+    unsigned int last_used;
+} BICUBIC_COEFFS;
+
+// One scaler.  Scalers share nothing but their tables, so any number of
+//  them can scale at the same time.
+typedef struct
+{
+    const BICUBIC_COEFFS *coeffs;
+
+    // buffer for vertical filtering.
     unsigned char *hbuf;
-    unsigned char *hbuf_uv;
+    int hbuf_size;
 } BICUBIC_SCALER_STRUCT;
 
-int bicubic_coefficient_setup(int in_width, int in_height, int out_width, int out_height);
-int bicubic_scale(int in_width, int in_height, int in_stride,
+void bicubic_coefficient_init(BICUBIC_SCALER_STRUCT *s);
+void bicubic_coefficient_destroy(BICUBIC_SCALER_STRUCT *s);
+int bicubic_coefficient_setup(BICUBIC_SCALER_STRUCT *s, int in_width, int in_height, int out_width, int out_height);
+int bicubic_scale(BICUBIC_SCALER_STRUCT *s,
+                  int in_width, int in_height, int in_stride,
                   int out_width, int out_height, int out_stride,
                   unsigned char *input_image, unsigned char *output_image);
-void bicubic_scale_frame_reset();
-void bicubic_scale_frame(YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst,
+void bicubic_scale_frame_reset(BICUBIC_SCALER_STRUCT *s);
+void bicubic_scale_frame(BICUBIC_SCALER_STRUCT *s,
+                         YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst,
                          int new_width, int new_height);
-void bicubic_coefficient_init();
-void bicubic_coefficient_destroy();
+
+// Frees the cached tables no scaler is using.
+void bicubic_coefficient_cache_flush();
 
 #endif /* __VPX_SCALE_ARBITRARY_H__ */
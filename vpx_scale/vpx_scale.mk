@@ -14,6 +14,11 @@ SCALE_SRCS-$(CONFIG_SPATIAL_RESAMPLING) += generic/gen_scalers.c
 SCALE_SRCS-$(ARCH_ARM)    += arm/yv12extend_arm.h
 SCALE_SRCS-$(ARCH_ARM)    += arm/scalesystemdependent.c
 
+#x86
+SCALE_SRCS-$(ARCH_X86)$(ARCH_X86_64) += x86/yv12extend_x86.h
+SCALE_SRCS-$(ARCH_X86)$(ARCH_X86_64) += x86/scalesystemdependent.c
+SCALE_SRCS-$(HAVE_SSE2)  += x86/yv12extend_sse2.asm
+
 #neon
 SCALE_SRCS-$(HAVE_NEON)  += arm/neon/vp8_vpxyv12_copyframe_func_neon$(ASM)
 SCALE_SRCS-$(HAVE_NEON)  += arm/neon/vp8_vpxyv12_copy_y_neon$(ASM)
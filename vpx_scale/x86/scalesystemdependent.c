@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include "vpx_config.h"
+#include "vpx_ports/x86.h"
+#include "vpx_scale/vpxscale.h"
+#include "vpx_scale/yv12extend.h"
+
+#if HAVE_SSE2
+static void extend_cols_sse2(unsigned char *src, int stride, int width,
+                             int rows, int border)
+{
+    /* The kernel stores 16 bytes at a time. */
+    if (border & 15 || !border)
+        vp8_yv12_extend_cols_c(src, stride, width, rows, border);
+    else
+        vp8_yv12_extend_cols_sse2(src, stride, width, rows, border);
+}
+#endif
+
+void vp8_arch_x86_vpx_scale_init()
+{
+#if HAVE_SSE2
+#if CONFIG_RUNTIME_CPU_DETECT
+    int flags = x86_simd_caps();
+    if (flags & HAS_SSE2)
+#endif
+    {
+        vp8_yv12_extend_cols_ptr = extend_cols_sse2;
+    }
+#endif
+}
@@ -0,0 +1,75 @@
+;
+;  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+;
+;  Use of this source code is governed by a BSD-style license
+;  that can be found in the LICENSE file in the root of the source
+;  tree. An additional intellectual property rights grant can be found
+;  in the file PATENTS.  All contributing project authors may
+;  be found in the AUTHORS file in the root of the source tree.
+;
+
+
+%include "vpx_ports/x86_abi_support.asm"
+
+;void vp8_yv12_extend_cols_sse2
+;(
+;    unsigned char *src,
+;    int stride,
+;    int width,
+;    int rows,                           at least 1
+;    int border                          a non-zero multiple of 16
+;)
+global sym(vp8_yv12_extend_cols_sse2)
+sym(vp8_yv12_extend_cols_sse2):
+    push        rbp
+    mov         rbp, rsp
+    SHADOW_ARGS_TO_STACK 5
+    push        rsi
+    push        rdi
+    push        rbx
+    ; end prolog
+
+        mov         rsi,            arg(0)          ; src
+        movsxd      rax,            dword ptr arg(1) ; stride
+        movsxd      rdx,            dword ptr arg(2) ; width
+        movsxd      rbx,            dword ptr arg(4) ; border
+
+.extend_cols_row:
+        ; the edge pixels, replicated to 16 bytes
+        movzx       edi,            byte ptr [rsi]
+        imul        edi,            edi, 0x01010101
+        movd        xmm0,           edi
+        pshufd      xmm0,           xmm0, 0
+        movzx       edi,            byte ptr [rsi + rdx - 1]
+        imul        edi,            edi, 0x01010101
+        movd        xmm1,           edi
+        pshufd      xmm1,           xmm1, 0
+
+        ; the borders start wherever the width puts them, so the stores
+        ; are unaligned
+        lea         rdi,            [rsi + rdx]
+        mov         rcx,            rbx
+.extend_cols_right:
+        sub         rcx,            16
+        movdqu      [rdi + rcx],    xmm1
+        jnz         .extend_cols_right
+
+        mov         rdi,            rsi
+        sub         rdi,            rbx
+        mov         rcx,            rbx
+.extend_cols_left:
+        sub         rcx,            16
+        movdqu      [rdi + rcx],    xmm0
+        jnz         .extend_cols_left
+
+        add         rsi,            rax
+        dec         dword ptr arg(3)
+        jnz         .extend_cols_row
+
+    ; begin epilog
+    pop         rbx
+    pop         rdi
+    pop         rsi
+    UNSHADOW_ARGS
+    pop         rbp
+    ret
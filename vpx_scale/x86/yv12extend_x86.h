@@ -0,0 +1,23 @@
+/*
+ *  Copyright (c) 2010 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#ifndef YV12_EXTEND_X86_H
+#define YV12_EXTEND_X86_H
+
+#include "vpx_config.h"
+
+#if HAVE_SSE2
+    /* border must be a non-zero multiple of 16 and rows at least 1. */
+    void vp8_yv12_extend_cols_sse2(unsigned char *src, int stride, int width,
+                                   int rows, int border);
+#endif
+
+#endif /* YV12_EXTEND_X86_H */
@@ -60,6 +60,7 @@ extern "C"
         unsigned char *v_buffer;
 
         unsigned char *buffer_alloc;
+        int buffer_external;    /* buffer_alloc is not owned by this config */
 #if CONFIG_OPENCL
         cl_mem buffer_mem;
 #endif
@@ -73,7 +74,13 @@ extern "C"
     } YV12_BUFFER_CONFIG;
 
     int vp8_yv12_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height, int border);
+    /* As vp8_yv12_alloc_frame_buffer(), with the memory placed as the
+     * VPX_MEM_* flags in mem_id ask, see vpx_mem_alloc(). */
+    int vp8_yv12_alloc_frame_buffer_placed(YV12_BUFFER_CONFIG *ybf, int width, int height, int border, int mem_id);
     int vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf);
+    /* Lays a frame out over caller owned memory. buf may be NULL to only
+     * set up the geometry, frame_size then gives the memory needed. */
+    int vp8_yv12_external_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height, int border, unsigned char *buf);
 
 #ifdef __cplusplus
 }
@@ -20,6 +20,10 @@
 #include "vpx_scale/arm/yv12extend_arm.h"
 #endif
 
+#if ARCH_X86 || ARCH_X86_64
+#include "vpx_scale/x86/yv12extend_x86.h"
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -27,6 +31,10 @@ extern "C"
 
     extern void (*vp8_yv12_extend_frame_borders_ptr)(YV12_BUFFER_CONFIG *ybf);
 
+    /* Side border fill used by both the whole frame and the row extension. */
+    extern void (*vp8_yv12_extend_cols_ptr)(unsigned char *src, int stride,
+                                            int width, int rows, int border);
+
     /* Copy Y,U,V buffer data from src to dst, filling border of dst as well. */
     extern void (*vp8_yv12_copy_frame_ptr)(YV12_BUFFER_CONFIG *src_ybc, YV12_BUFFER_CONFIG *dst_ybc);
 
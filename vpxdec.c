@@ -89,6 +89,14 @@ static const arg_def_t verbosearg = ARG_DEF("v", "verbose", 0,
                                   "Show version string");
 static const arg_def_t error_concealment = ARG_DEF(NULL, "error-concealment", 0,
                                        "Enable decoder error-concealment");
+static const arg_def_t framebuffersarg = ARG_DEF(NULL, "frame-buffers", 0,
+                                       "Decode into application frame buffers");
+static const arg_def_t unborderedarg = ARG_DEF(NULL, "unbordered-refs", 0,
+                                       "Don't extend the reference frame borders");
+static const arg_def_t hugepagesarg = ARG_DEF(NULL, "hugepages", 0,
+                                       "Back the decoded frames with huge pages");
+static const arg_def_t numalocalarg = ARG_DEF(NULL, "numa-local", 0,
+                                       "Keep the decoded frames on the local NUMA node");
 
 
 #if CONFIG_MD5
@@ -103,7 +111,8 @@ static const arg_def_t *all_args[] =
 #if CONFIG_MD5
     &md5arg,
 #endif
-    &error_concealment,
+    &error_concealment, &framebuffersarg, &unborderedarg, &hugepagesarg,
+    &numalocalarg,
     NULL
 };
 
@@ -126,12 +135,14 @@ static const arg_def_t pp_disp_mvs = ARG_DEF(NULL, "pp-dbg-mvs", 1,
                                        "Draw only selected motion vectors");
 static const arg_def_t mfqe = ARG_DEF(NULL, "mfqe", 0,
                                        "Enable multiframe quality enhancement");
+static const arg_def_t mb_adaptive = ARG_DEF(NULL, "pp-mb-adaptive", 0,
+                                       "Adapt VP8 deblocking to the macro block modes");
 
 static const arg_def_t *vp8_pp_args[] =
 {
     &addnoise_level, &deblock, &demacroblock_level, &pp_debug_info,
     &pp_disp_ref_frame, &pp_disp_mb_modes, &pp_disp_b_modes, &pp_disp_mvs, &mfqe,
-    NULL
+    &mb_adaptive, NULL
 };
 #endif
 
@@ -696,6 +707,72 @@ void generate_filename(const char *pattern, char *out, size_t q_len,
 }
 
 
+#if CONFIG_VP8_DECODER
+/* Refcounted frame buffers handed to the decoder. A buffer is reused once
+ * both the decoder and the output stage have dropped their references.
+ */
+#define MAX_FRAME_BUFFERS 16
+
+struct frame_buffer
+{
+    uint8_t *alloc;
+    size_t   size;
+    int      ref;
+};
+
+struct frame_buffer_pool
+{
+    struct frame_buffer bufs[MAX_FRAME_BUFFERS];
+};
+
+static int get_frame_buffer(void *priv, size_t min_size, vp8_frame_buffer_t *fb)
+{
+    struct frame_buffer_pool *pool = priv;
+    struct frame_buffer *b = NULL;
+    int i;
+
+    for (i = 0; i < MAX_FRAME_BUFFERS; i++)
+        if (!pool->bufs[i].ref && (!b || pool->bufs[i].size >= min_size))
+            b = &pool->bufs[i];
+
+    if (!b)
+        return -1;
+
+    if (b->size < min_size)
+    {
+        free(b->alloc);
+        b->alloc = malloc(min_size + 31);
+        b->size = b->alloc ? min_size : 0;
+
+        if (!b->alloc)
+            return -1;
+    }
+
+    b->ref = 1;
+    fb->data = (uint8_t *)(((uintptr_t)b->alloc + 31) & ~(uintptr_t)31);
+    fb->size = b->size;
+    fb->priv = b;
+    return 0;
+}
+
+static int release_frame_buffer(void *priv, vp8_frame_buffer_t *fb)
+{
+    struct frame_buffer *b = fb->priv;
+
+    b->ref--;
+    return 0;
+}
+
+static void free_frame_buffers(struct frame_buffer_pool *pool)
+{
+    int i;
+
+    for (i = 0; i < MAX_FRAME_BUFFERS; i++)
+        free(pool->bufs[i].alloc);
+}
+#endif
+
+
 int main(int argc, const char **argv_)
 {
     vpx_codec_ctx_t          decoder;
@@ -728,10 +805,15 @@ int main(int argc, const char **argv_)
     int                     vp8_dbg_color_mb_modes = 0;
     int                     vp8_dbg_color_b_modes = 0;
     int                     vp8_dbg_display_mv = 0;
+    struct frame_buffer_pool fb_pool = {{{0}}};
+    struct frame_buffer    *held_fb = NULL;
 #endif
     struct input_ctx        input = {0};
     int                     frames_corrupted = 0;
     int                     dec_flags = 0;
+    int                     ext_fb = 0;
+    int                     unbordered_refs = 0;
+    int                     frame_placement = 0;
 
     /* Parse command line */
     exec_name = argv_[0];
@@ -786,6 +868,14 @@ int main(int argc, const char **argv_)
             cfg.threads = arg_parse_uint(&arg);
         else if (arg_match(&arg, &verbosearg, argi))
             quiet = 0;
+        else if (arg_match(&arg, &framebuffersarg, argi))
+            ext_fb = 1;
+        else if (arg_match(&arg, &unborderedarg, argi))
+            unbordered_refs = 1;
+        else if (arg_match(&arg, &hugepagesarg, argi))
+            frame_placement |= VP8D_FRAME_HUGEPAGES;
+        else if (arg_match(&arg, &numalocalarg, argi))
+            frame_placement |= VP8D_FRAME_NUMA_LOCAL;
 
 #if CONFIG_VP8_DECODER
         else if (arg_match(&arg, &addnoise_level, argi))
@@ -810,6 +900,11 @@ int main(int argc, const char **argv_)
             postproc = 1;
             vp8_pp_cfg.post_proc_flag |= VP8_MFQE;
         }
+        else if (arg_match(&arg, &mb_adaptive, argi))
+        {
+            postproc = 1;
+            vp8_pp_cfg.post_proc_flag |= VP8_MB_ADAPTIVE;
+        }
         else if (arg_match(&arg, &pp_debug_info, argi))
         {
             unsigned int level = arg_parse_uint(&arg);
@@ -1028,6 +1123,40 @@ int main(int argc, const char **argv_)
         fprintf(stderr, "Failed to configure motion vector visualizer: %s\n", vpx_codec_error(&decoder));
         return EXIT_FAILURE;
     }
+
+    if (ext_fb)
+    {
+        vp8_frame_buffer_functions_t fb_functions;
+
+        fb_functions.get_fb = get_frame_buffer;
+        fb_functions.release_fb = release_frame_buffer;
+        fb_functions.cb_priv = &fb_pool;
+
+        if (vpx_codec_control(&decoder, VP8D_SET_FRAME_BUFFER_FUNCTIONS,
+                              &fb_functions))
+        {
+            fprintf(stderr, "Failed to set frame buffer functions: %s\n",
+                    vpx_codec_error(&decoder));
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (unbordered_refs
+        && vpx_codec_control(&decoder, VP8D_SET_UNBORDERED_REFS, 1))
+    {
+        fprintf(stderr, "Failed to disable border extension: %s\n",
+                vpx_codec_error(&decoder));
+        return EXIT_FAILURE;
+    }
+
+    if (frame_placement
+        && vpx_codec_control(&decoder, VP8D_SET_FRAME_PLACEMENT,
+                             frame_placement))
+    {
+        fprintf(stderr, "Failed to set the frame placement: %s\n",
+                vpx_codec_error(&decoder));
+        return EXIT_FAILURE;
+    }
 #endif
 
     /* Decode file */
@@ -1067,6 +1196,27 @@ int main(int argc, const char **argv_)
         if ((img = vpx_codec_get_frame(&decoder, &iter)))
             ++frame_out;
 
+#if CONFIG_VP8_DECODER
+        /* Hold the output frame until the next one is out, as a render
+         * stage would, rather than copying it out of the decoder.
+         */
+        if (ext_fb && img)
+        {
+            vp8_frame_buffer_t fb;
+
+            if (held_fb)
+                held_fb->ref--;
+            held_fb = NULL;
+
+            if (!vpx_codec_control(&decoder, VP8D_GET_FRAME_BUFFER, &fb)
+                && fb.data)
+            {
+                held_fb = fb.priv;
+                held_fb->ref++;
+            }
+        }
+#endif
+
         if (progress)
             show_progress(frame_in, frame_out, dx_time);
 
@@ -1129,6 +1279,20 @@ int main(int argc, const char **argv_)
         fprintf(stderr, "\n");
     }
 
+    if (summary)
+    {
+        vp8_mem_stats_t mem;
+
+        if (!vpx_codec_control(&decoder, VP8D_GET_MEM_STATS, &mem))
+            fprintf(stderr, "Memory: %u KB, peak %u KB (frames %u, threads %u,"
+                    " OpenCL %u, other %u)\n", (unsigned int)(mem.total >> 10),
+                    (unsigned int)(mem.peak >> 10),
+                    (unsigned int)(mem.frame_buffers >> 10),
+                    (unsigned int)(mem.thread_buffers >> 10),
+                    (unsigned int)(mem.opencl >> 10),
+                    (unsigned int)(mem.other >> 10));
+    }
+
     if (frames_corrupted)
         fprintf(stderr, "WARNING: %d frames corrupted.\n",frames_corrupted);
 
@@ -1143,6 +1307,10 @@ fail:
     if (single_file && !noblit)
         out_close(out, outfile, do_md5);
 
+#if CONFIG_VP8_DECODER
+    free_frame_buffers(&fb_pool);
+#endif
+
     if(input.nestegg_ctx)
         nestegg_destroy(input.nestegg_ctx);
     if(input.kind != WEBM_FILE)
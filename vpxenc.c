@@ -1097,12 +1097,14 @@ static const arg_def_t cq_level = ARG_DEF(NULL, "cq-level", 1,
                                    "Constrained Quality Level");
 static const arg_def_t max_intra_rate_pct = ARG_DEF(NULL, "max-intra-rate", 1,
         "Max I-frame bitrate (pct)");
+static const arg_def_t rt_deadline_pct = ARG_DEF(NULL, "rt-deadline-pct", 1,
+        "Realtime frames to encode within the cpu-used budget (pct)");
 
 static const arg_def_t *vp8_args[] =
 {
     &cpu_used, &auto_altref, &noise_sens, &sharpness, &static_thresh,
     &token_parts, &arnr_maxframes, &arnr_strength, &arnr_type,
-    &tune_ssim, &cq_level, &max_intra_rate_pct, NULL
+    &tune_ssim, &cq_level, &max_intra_rate_pct, &rt_deadline_pct, NULL
 };
 static const int vp8_arg_ctrl_map[] =
 {
@@ -1110,7 +1112,8 @@ static const int vp8_arg_ctrl_map[] =
     VP8E_SET_NOISE_SENSITIVITY, VP8E_SET_SHARPNESS, VP8E_SET_STATIC_THRESHOLD,
     VP8E_SET_TOKEN_PARTITIONS,
     VP8E_SET_ARNR_MAXFRAMES, VP8E_SET_ARNR_STRENGTH , VP8E_SET_ARNR_TYPE,
-    VP8E_SET_TUNING, VP8E_SET_CQ_LEVEL, VP8E_SET_MAX_INTRA_BITRATE_PCT, 0
+    VP8E_SET_TUNING, VP8E_SET_CQ_LEVEL, VP8E_SET_MAX_INTRA_BITRATE_PCT,
+    VP8E_SET_RT_DEADLINE_PERCENTILE, 0
 };
 #endif
 